@@ -0,0 +1,102 @@
+#ifndef ASTTRAVERSAL_H
+#define ASTTRAVERSAL_H
+
+#include "Parser.h"
+#include <functional>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @class AstTraversal
+ * @brief Единый обход дочерних узлов AST для анализаторов и проходов оптимизации.
+ *
+ * Узлы разных типов хранят потомков в разных полях; класс собирает их в одном месте,
+ * чтобы добавление нового узла требовало изменения только этих функций.
+ */
+class AstTraversal {
+public:
+    using Block = std::vector<std::shared_ptr<ASTNode>>;
+
+    /**
+     * @brief Возвращает все дочерние узлы в порядке их вычисления интерпретатором
+     */
+    static std::vector<ASTNode *> children(ASTNode *node);
+
+    /**
+     * @brief Вызывает visit для каждого дочернего выражения, которое можно заменить другим узлом
+     *
+     * Инструкции вложенных блоков не посещаются (см. blocks()), как и выражение внутри TempNode.
+     */
+    static void forEachExpression(ASTNode *node, const std::function<void(std::shared_ptr<ASTNode> &)> &visit);
+
+    /**
+     * @brief Восстанавливает согласованность инструкции после замены её выражения через сохранённую ссылку
+     *
+     * Правая часть `AugAssignNode` хранится и в самом узле, и в его BinOpNode; forEachExpression
+     * синхронизирует их автоматически, а при отложенной замене нужно вызвать эту функцию.
+     */
+    static void refresh(ASTNode *statement);
+
+    /**
+     * @brief Возвращает вложенные последовательности инструкций (ветви `if`, тело `while`, блок)
+     */
+    static std::vector<Block *> blocks(ASTNode *node);
+
+    /**
+     * @brief Проверяет, что выражение состоит только из литералов, переменных, бинарных операций
+     *        и временных значений оптимизатора
+     */
+    static bool isPure(const ASTNode *node);
+
+    /**
+     * @brief Проверяет, может ли узел вызвать пользовательский код
+     *
+     * Встроенные функции и методы не читают и не изменяют переменные окружения; `import`
+     * выполняет код модуля и может сделать и то и другое.
+     */
+    static bool callsUserCode(ASTNode *node);
+
+    /**
+     * @brief Возвращает имена переменных, которым присваиваются значения внутри узла
+     */
+    static std::vector<QString> assignedVariables(ASTNode *node);
+
+    /**
+     * @brief Проверяет, читается ли переменная name при вычислении узла
+     */
+    static bool reads(ASTNode *node, const QString &name);
+
+    /**
+     * @brief Создаёт копию дерева, которую проходы оптимизации могут изменять, не затрагивая оригинал
+     *
+     * Копируются узлы, которые создаёт парсер; аннотации типов и состояние JIT не копируются.
+     * FunctionNode оптимизатором не изменяется и разделяется между копиями, поэтому тело функции,
+     * разобранное при вызове одной копии, не разбирается заново.
+     *
+     * @param isolated Копия не разделяет с оригиналом ни одного изменяемого объекта (функции,
+     * строки и байты литералов) и может выполняться в другом потоке одновременно с ним.
+     * Функции общего дерева (см. `share`) разделяются и в этом случае
+     * @return Копия дерева (nullptr для nullptr)
+     * @throws std::runtime_error Если дерево содержит узлы оптимизатора (TempNode)
+     */
+    static std::shared_ptr<ASTNode> clone(const std::shared_ptr<ASTNode> &node, bool isolated = false);
+
+    /**
+     * @brief Готовит дерево к выполнению несколькими потоками одновременно (см. `SubInterpreter::compile`)
+     *
+     * Разбирает тела функций, выравнивает строки литералов и вычисляет их хеш, после чего функции
+     * и циклы дерева отмечаются общими (`shared`): их тела не изменяются при выполнении, а состояние JIT
+     * циклов хранится в таблице экземпляра (`LoopStates`). Функция с синтаксической ошибкой в теле
+     * остаётся необщей, и ошибка, как обычно, возникает при её вызове.
+     */
+    static void share(ASTNode *node);
+
+    /**
+     * @brief Возвращает инструкции тела async-функции body (на любой глубине вложенности), на которых
+     * сопрограмма может приостановиться (см. `Coroutine`)
+     * @throws std::runtime_error Если `await` стоит там, где сопрограмма не может приостановиться
+     */
+    static std::unordered_set<const ASTNode *> awaitingStatements(const Block &body);
+};
+
+#endif // ASTTRAVERSAL_H
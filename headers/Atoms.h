@@ -0,0 +1,40 @@
+#ifndef ATOMS_H
+#define ATOMS_H
+
+#include <QString>
+#include <cstddef>
+
+/**
+ * @class Atoms
+ * @brief Общая для процесса таблица интернированных имён (идентификаторов и ключевых слов).
+ *
+ * Имена интернируются один раз при разборе: лексер возвращает имена из таблицы (загрузчик кэша модулей
+ * `ModuleCache` интернирует прочитанные имена), поэтому узлы дерева (`VarNode`, `AssignNode`,
+ * `FunctionNode`) и ключи окружений с одним и тем же именем во всех экземплярах интерпретатора
+ * разделяют одну строку, а выполнение программы таблицу не использует.
+ *
+ * Символы атома хранятся в памяти, которая не освобождается до завершения процесса, а сам атом —
+ * строка `QString::fromRawData` над ней. У такой строки нет счётчика ссылок, поэтому копирование
+ * имени в любом потоке не выполняет атомарных операций над общими данными.
+ *
+ * @details
+ * Таблица не использует блокировок: каждая корзина — односвязный список неизменяемых атомов,
+ * новый атом добавляется в начало списка сравнением с обменом. Поиск только читает список,
+ * поэтому параллельная загрузка скриптов (см. `ParallelLexer`, `SubInterpreter`) не упорядочивается
+ * на интернировании, а при гонке двух вставок одного имени проигравший поток находит атом победителя.
+ * Число корзин фиксировано и рассчитано на десятки тысяч различных имён.
+ */
+class Atoms {
+public:
+    /**
+     * @brief Возвращает строку над единственным экземпляром символов, равных text
+     */
+    static QString intern(QStringView text);
+
+    /**
+     * @brief Число различных интернированных имён
+     */
+    static size_t count();
+};
+
+#endif // ATOMS_H
@@ -0,0 +1,92 @@
+#ifndef BINARYDISPATCH_H
+#define BINARYDISPATCH_H
+
+#include "Value.h"
+#include <array>
+#include <cstdint>
+#include <variant>
+
+/**
+ * @enum BinaryOp
+ * @brief Представляет операции, которые могут быть выполнены в бинарном узле AST.
+ *
+ * @details
+ * Операции разбиваются на несколько категорий:
+ * - **Арифметические операции**: Add, Subtract, Multiply, Divide, Modulo, IntDivide, Power.
+ * - **Операции сравнения**: Equal, NotEqual, Greater, GreaterEqual, Less, LessEqual.
+ * Значение перечисления используется как индекс в таблице `BinaryDispatch`.
+ */
+enum class BinaryOp : std::uint8_t {
+    Add, Subtract, Multiply, Power, Divide, Modulo, IntDivide,
+    Equal, NotEqual, Greater, GreaterEqual, Less, LessEqual
+};
+
+/**
+ * @class BinaryDispatch
+ * @brief Таблица обработчиков бинарных операций, индексированная типами операндов и операцией.
+ *
+ * Тип операнда определяется индексом альтернативы в `Value::data`, поэтому выбор обработчика —
+ * одно обращение к плотному массиву `[тип левого][тип правого][операция]` вместо цепочки проверок
+ * `std::holds_alternative`. Пустая ячейка означает, что операция для этой пары типов не поддерживается.
+ *
+ * Обработчики встроенных типов (чисел, строк, списков, байтовых последовательностей) регистрируются
+ * при запуске программы. Новый тип добавляет свои операции через `add`, указывая типы
+ * альтернатив `Value::data`:
+ * @code
+ * BinaryDispatch::add<Value::ListPtr, Value::ListPtr>(BinaryOp::Add, &concatLists);
+ * @endcode
+ */
+class BinaryDispatch {
+public:
+    using Handler = Value (*)(const Value &l, const Value &r);
+
+    static constexpr size_t typeCount = std::variant_size_v<decltype(Value::data)>;
+    static constexpr size_t opCount = static_cast<size_t>(BinaryOp::LessEqual) + 1;
+
+    /**
+     * @brief Индекс альтернативы T в `Value::data`
+     */
+    template <typename T, size_t I = 0>
+    static constexpr size_t tagOf() {
+        static_assert(I < typeCount, "Type is not an alternative of Value::data");
+        if constexpr (std::is_same_v<T, std::variant_alternative_t<I, decltype(Value::data)>>) return I;
+        else return tagOf<T, I + 1>();
+    }
+
+    /**
+     * @brief Регистрирует обработчик операции op для операндов с индексами типов left и right
+     *
+     * Повторная регистрация заменяет прежний обработчик.
+     */
+    static void add(size_t left, size_t right, BinaryOp op, Handler handler);
+
+    template <typename L, typename R>
+    static void add(const BinaryOp op, const Handler handler) {
+        add(tagOf<L>(), tagOf<R>(), op, handler);
+    }
+
+    /**
+     * @brief Выполняет операцию op над вычисленными операндами
+     * @throws std::runtime_error Если операция не поддерживается для данных типов операндов
+     *                            или обработчик обнаружил ошибку (например, деление на ноль).
+     */
+    static Value apply(const BinaryOp op, const Value &l, const Value &r) {
+        const Handler handler = handlers[l.data.index()][r.data.index()][static_cast<size_t>(op)];
+        if (!handler) unsupported(op, l, r);
+        return handler(l, r);
+    }
+
+    /**
+     * @brief Возвращает текстовое обозначение операции (`+`, `//`, `<=`, ...)
+     */
+    static const char *symbol(BinaryOp op);
+
+private:
+    using Table = std::array<std::array<std::array<Handler, opCount>, typeCount>, typeCount>;
+
+    static inline Table handlers{};
+
+    [[noreturn]] static void unsupported(BinaryOp op, const Value &l, const Value &r);
+};
+
+#endif // BINARYDISPATCH_H
@@ -0,0 +1,83 @@
+#ifndef BUFFER_H
+#define BUFFER_H
+
+#include <QString>
+#include <memory>
+#include <vector>
+
+class Value;
+
+/**
+ * @struct Buffer
+ * @brief Описывает непрерывную область памяти, предоставляемую значением интерпретатора (протокол буфера).
+ *
+ * Буфер не владеет данными: память удерживается объектом-владельцем `owner`, поэтому буфер
+ * и все его срезы остаются валидными, пока существует хотя бы один из них. Буферы изменяемых
+ * владельцев (`bytearray`) дополнительно удерживают `exportGuard`, запрещающий владельцу менять
+ * размер, пока буфер существует. Элементы буфера —
+ * целые числа без знака шириной itemSize байтов (1 для байтов и строк Latin-1, 2 или 4 для
+ * строк UCS-2/UCS-4), расположенные с шагом stride элементов.
+ */
+struct Buffer {
+    std::shared_ptr<const void> owner; //объект, удерживающий память
+    std::shared_ptr<const void> exportGuard; //счётчик экспортов изменяемого владельца
+    const uchar *data = nullptr; //адрес первого элемента
+    qsizetype length = 0; //количество элементов
+    qsizetype stride = 1; //шаг между соседними элементами (в элементах)
+    int itemSize = 1; //ширина элемента в байтах
+    bool readOnly = true;
+
+    /**
+     * @brief Возвращает элемент буфера по индексу (0 <= index < length)
+     */
+    [[nodiscard]] quint32 item(qsizetype index) const;
+
+    /**
+     * @brief Возвращает указатель на элемент буфера по индексу
+     */
+    [[nodiscard]] const uchar *pointer(const qsizetype index) const { return data + index * stride * itemSize; }
+
+    /**
+     * @brief Возвращает указатель на элемент буфера для записи
+     * @throws std::runtime_error Если буфер доступен только для чтения
+     */
+    [[nodiscard]] uchar *writablePointer(qsizetype index) const;
+
+    /**
+     * @brief Проверяет, расположены ли элементы буфера в памяти подряд
+     */
+    [[nodiscard]] bool isContiguous() const { return stride == 1; }
+
+    /**
+     * @brief Возвращает часть буфера, заданную началом, шагом и количеством элементов, без копирования
+     */
+    [[nodiscard]] Buffer slice(qsizetype start, qsizetype step, qsizetype count) const;
+
+    /**
+     * @brief Получает буфер значения, поддерживающего протокол буфера
+     * @throws std::runtime_error Если значение не предоставляет буфер
+     */
+    static Buffer of(const Value &value);
+};
+
+/**
+ * @class MemoryView
+ * @brief Представляет значение `memoryview`: окно в буфер другого значения без копирования данных.
+ *
+ * Индексирование возвращает элемент буфера как целое число, а срез создаёт новый MemoryView,
+ * ссылающийся на ту же память, независимо от длины среза.
+ */
+class MemoryView {
+public:
+    explicit MemoryView(Buffer buffer) : buffer(std::move(buffer)) {}
+
+    /**
+     * @brief Вызывает метод memoryview (`tolist`)
+     * @throws std::runtime_error Если метод не существует
+     */
+    [[nodiscard]] Value callMethod(const QString &name, const std::vector<Value> &args) const;
+
+    Buffer buffer;
+};
+
+#endif // BUFFER_H
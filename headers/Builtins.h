@@ -0,0 +1,46 @@
+#ifndef BUILTINS_H
+#define BUILTINS_H
+
+#include "Value.h"
+#include <unordered_map>
+#include <vector>
+
+class Environment;
+
+/**
+ * @class Builtins
+ * @brief Реализует встроенные функции интерпретатора (`len`, `memoryview`, `bytes`, `bytearray`, `print`,
+ * `open`, `freeze`, `parallel_map`, `process_map`) и функции цикла событий для сопрограмм (`run`, `sleep`, `gather` и др., см. `EventLoop`).
+ *
+ * Функции хранятся в таблице, индексированной по имени, и вызываются узлом CallNode
+ * с уже вычисленными аргументами. Функции, которые вызывают функции пользователя (`parallel_map`, `process_map`, `run`),
+ * хранятся в отдельной таблице и получают окружение вызывающего кода.
+ */
+class Builtins {
+public:
+    using Function = Value (*)(const std::vector<Value> &args);
+    using ContextFunction = Value (*)(const std::vector<Value> &args, Environment &env);
+
+    /**
+     * @brief Проверяет, существует ли встроенная функция с указанным именем
+     */
+    static bool contains(const QString &name);
+
+    /**
+     * @brief Проверяет, может ли встроенная функция name вызывать функции пользователя
+     * (такой вызов читает переменные, как вызов функции пользователя)
+     */
+    static bool callsUserCode(const QString &name);
+
+    /**
+     * @brief Вызывает встроенную функцию name с аргументами args
+     * @throws std::runtime_error Если функция не существует или аргументы некорректны
+     */
+    static Value call(const QString &name, const std::vector<Value> &args, Environment &env);
+
+private:
+    static const std::unordered_map<QString, Function> &functions();
+    static const std::unordered_map<QString, ContextFunction> &contextFunctions();
+};
+
+#endif // BUILTINS_H
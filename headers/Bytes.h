@@ -0,0 +1,85 @@
+#ifndef BYTES_H
+#define BYTES_H
+
+#include "CompactString.h"
+#include <QString>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Value;
+
+/**
+ * @class Bytes
+ * @brief Представляет значения `bytes` (неизменяемые) и `bytearray` (изменяемые): последовательность байтов
+ * в непрерывном буфере.
+ *
+ * Байты хранятся как есть, без преобразования в UTF-16, и предоставляются через протокол буфера
+ * (см. `Buffer::of`), поэтому memoryview, файловый ввод-вывод и сериализация читают и записывают их
+ * без копирования. Дописывание в `bytearray` выполняется на месте с амортизированным ростом буфера.
+ *
+ * @details
+ * Пока на буфер ссылается хотя бы один memoryview, размер `bytearray` изменять нельзя: иначе
+ * перераспределение памяти сделало бы такие ссылки недействительными. Число экспортов отслеживается
+ * счётчиком ссылок `exports`, копия которого хранится в каждом выданном буфере.
+ */
+class Bytes {
+public:
+    using Method = Value (*)(Bytes &self, const std::vector<Value> &args);
+
+    Bytes(std::string data, const bool isMutable) : data(std::move(data)), isMutable(isMutable) {}
+
+    /**
+     * @brief Возвращает тип значения (`bytes` или `bytearray`)
+     */
+    [[nodiscard]] const char *typeName() const { return isMutable ? "bytearray" : "bytes"; }
+
+    /**
+     * @brief Возвращает количество байтов
+     */
+    [[nodiscard]] qsizetype length() const { return static_cast<qsizetype>(data.size()); }
+
+    /**
+     * @brief Дописывает size байтов из source в конец последовательности на месте
+     * @throws std::runtime_error Если на буфер ссылаются memoryview
+     */
+    void append(const char *source, qsizetype size);
+
+    /**
+     * @brief Возвращает представление значения в виде литерала (`b'...'` или `bytearray(b'...')`)
+     */
+    [[nodiscard]] QString repr() const;
+
+    /**
+     * @brief Проверяет, ссылаются ли на буфер memoryview или другие экспортированные буферы
+     */
+    [[nodiscard]] bool isExported() const { return exports.use_count() > 1; }
+
+    /**
+     * @brief Кодирует строку str в байты в кодировке encoding (`utf-8`, `latin-1`, `ascii`)
+     * @throws std::runtime_error Если кодировка не поддерживается или символ в ней непредставим
+     */
+    static std::string encode(const CompactString &str, const QString &encoding);
+
+    /**
+     * @brief Декодирует size байтов из data в строку в кодировке encoding (`utf-8`, `latin-1`, `ascii`)
+     * @throws std::runtime_error Если кодировка не поддерживается или байты в ней некорректны
+     */
+    static CompactString decode(const char *data, qsizetype size, const QString &encoding);
+
+    /**
+     * @brief Вызывает метод name для последовательности self с аргументами args
+     * @throws std::runtime_error Если метод не существует или аргументы некорректны
+     */
+    static Value call(Bytes &self, const QString &name, const std::vector<Value> &args);
+
+    std::string data;
+    bool isMutable;
+    std::shared_ptr<const int> exports = std::make_shared<const int>(0); //счётчик экспортированных буферов
+
+private:
+    static const std::unordered_map<QString, Method> &methods();
+};
+
+#endif // BYTES_H
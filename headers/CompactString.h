@@ -0,0 +1,117 @@
+#ifndef COMPACTSTRING_H
+#define COMPACTSTRING_H
+
+#include <QString>
+#include <string>
+#include <variant>
+
+/**
+ * @class CompactString
+ * @brief Представляет строковые данные интерпретатора в компактном виде (в духе PEP 393).
+ *
+ * Строка хранится как последовательность кодовых точек Unicode, причём ширина элемента
+ * выбирается по наибольшей кодовой точке строки: 1 байт (Latin-1), 2 байта (UCS-2) или 4 байта (UCS-4).
+ * Для типичных ASCII-данных это вдвое меньше, чем UTF-16 в `QString`, а обращение по индексу
+ * выполняется за O(1) даже для символов за пределами BMP.
+ *
+ * @details
+ * Длина, хеш и признак «только ASCII» кешируются. Строка всегда хранится в минимально
+ * достаточной ширине, поэтому равные строки имеют одинаковое представление. Преобразование
+ * в `QString` выполняется только на границе с консолью (`toQString`).
+ */
+class CompactString {
+public:
+    /**
+     * @enum Kind
+     * @brief Ширина одного элемента строки в байтах
+     */
+    enum class Kind : quint8 { Latin1 = 1, UCS2 = 2, UCS4 = 4 };
+
+    CompactString() = default;
+    explicit CompactString(const QString &str);
+
+    /**
+     * @brief Создаёт строку из последовательности байтов в кодировке Latin-1
+     */
+    static CompactString fromLatin1(const char *data, qsizetype size);
+
+    /**
+     * @brief Создаёт строку из последовательности кодовых точек, выбирая минимальную ширину элемента
+     */
+    static CompactString fromCodePoints(const std::u32string &points);
+
+    /**
+     * @brief Преобразует строку в QString (используется при выводе на консоль)
+     */
+    [[nodiscard]] QString toQString() const;
+
+    [[nodiscard]] qsizetype length() const;
+    [[nodiscard]] bool isEmpty() const { return length() == 0; }
+    [[nodiscard]] Kind kind() const { return static_cast<Kind>(1 << storage.index()); }
+    [[nodiscard]] bool isAscii() const { return ascii; }
+
+    /**
+     * @brief Возвращает кодовую точку по индексу за O(1)
+     */
+    [[nodiscard]] char32_t at(qsizetype index) const;
+
+    /**
+     * @brief Возвращает хеш строки (вычисляется один раз)
+     */
+    [[nodiscard]] size_t hash() const;
+
+    /**
+     * @brief Сравнивает строки по кодовым точкам
+     * @return Отрицательное число, ноль или положительное число
+     */
+    [[nodiscard]] int compare(const CompactString &other) const;
+
+    bool operator==(const CompactString &other) const;
+    bool operator!=(const CompactString &other) const { return !(*this == other); }
+
+    /**
+     * @brief Дописывает строку в конец текущей, при необходимости расширяя ширину элемента
+     */
+    void append(const CompactString &other);
+
+    /**
+     * @brief Дописывает в конец фрагмент строки other длиной count, начиная с позиции pos
+     */
+    void append(const CompactString &other, qsizetype pos, qsizetype count);
+
+    /**
+     * @brief Приводит строку к минимальной ширине элемента и пересчитывает признак ASCII
+     */
+    void normalize();
+
+    /**
+     * @brief Резервирует место под size элементов ширины kind
+     */
+    void reserve(qsizetype size, Kind kind);
+
+    [[nodiscard]] CompactString repeated(qsizetype times) const;
+    [[nodiscard]] CompactString mid(qsizetype pos, qsizetype count) const;
+
+    /**
+     * @brief Применяет функцию к хранилищу строки (std::string, std::u16string или std::u32string)
+     */
+    template<typename Visitor>
+    decltype(auto) visit(Visitor &&visitor) const { return std::visit(std::forward<Visitor>(visitor), storage); }
+
+private:
+    void widen(Kind to);
+
+    std::variant<std::string, std::u16string, std::u32string> storage;
+    mutable size_t cachedHash = 0;
+    mutable bool hashed = false;
+    bool ascii = true;
+};
+
+namespace std {
+    template<>
+    struct hash<CompactString> {
+        size_t operator()(const CompactString &str) const noexcept { return str.hash(); }
+    };
+}
+
+#endif // COMPACTSTRING_H
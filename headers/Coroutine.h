@@ -0,0 +1,146 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include "Environment.h"
+#include "Value.h"
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ASTNode;
+class FunctionNode;
+class WhileNode;
+
+/**
+ * @class Awaitable
+ * @brief Значение, которое можно ожидать инструкцией `await`: сопрограмма (`Coroutine`)
+ * или результат, который станет известен позже (`Future`).
+ */
+class Awaitable {
+public:
+    virtual ~Awaitable() = default;
+
+    /**
+     * @brief Имя типа для сообщений об ошибках и представления значения (`coroutine`, `Future`, `Task`)
+     */
+    [[nodiscard]] virtual const char *typeName() const = 0;
+
+    /**
+     * @brief Дописывает в out представление значения (`<coroutine f>`, `<Future pending>`)
+     */
+    virtual void repr(std::string &out) const = 0;
+};
+
+/**
+ * @class Future
+ * @brief Результат асинхронной операции: ожидается, пока цикл событий (`EventLoop`) не завершит операцию
+ * значением или ошибкой.
+ */
+class Future : public Awaitable {
+public:
+    using Callback = std::function<void()>;
+
+    [[nodiscard]] bool done() const { return state != State::Pending; }
+
+    /**
+     * @brief Завершает операцию значением value; повторное завершение игнорируется
+     */
+    void setResult(Value value);
+
+    /**
+     * @brief Завершает операцию ошибкой message; повторное завершение игнорируется
+     */
+    void setError(std::string message);
+
+    /**
+     * @brief Возвращает значение завершённой операции
+     * @throws std::runtime_error Если операция завершилась ошибкой
+     */
+    [[nodiscard]] const Value &result() const;
+
+    /**
+     * @brief Вызывает callback после завершения операции (сразу, если она уже завершена)
+     */
+    void onDone(Callback callback);
+
+    [[nodiscard]] const char *typeName() const override { return "Future"; }
+    void repr(std::string &out) const override;
+
+private:
+    enum class State { Pending, Finished, Failed };
+
+    void finish(State finalState);
+
+    State state = State::Pending;
+    Value value;
+    std::string error;
+    std::vector<Callback> callbacks;
+};
+
+/**
+ * @class Coroutine
+ * @brief Кадр вызова функции `async def`: выполняет её тело по частям между инструкциями `await`.
+ *
+ * Вызов async-функции не выполняет тело, а создаёт кадр в куче с локальным окружением и позицией
+ * выполнения. Кадр бесстековый: позиция — это список курсоров по вложенным блокам (`if`, `while`),
+ * а не кадры стека C++, поэтому между приостановками сопрограмма не занимает стек, и тысячи
+ * ожидающих сопрограмм стоят по одному объекту в куче.
+ *
+ * @details
+ * `resume` выполняет инструкции обычным `eval`, пока не встретит инструкцию с `await`
+ * (см. `AstTraversal::awaitingStatements`): тогда вычисляется операнд, а кадр возвращает ожидаемое
+ * значение и приостанавливается. Ведущий кадры `Task` дожидается результата и передаёт его
+ * в следующий `resume`, который подставляет результат в инструкцию (присваивание или `return`)
+ * и продолжает выполнение. Блок `if` или `while`, содержащий `await`, выполняется курсором:
+ * условие вычисляется кадром, а тело — по одной инструкции.
+ */
+class Coroutine : public Awaitable {
+public:
+    /**
+     * @brief Результат шага: сопрограмма ожидает awaiting или (если awaiting пуст) завершилась значением value
+     */
+    struct Step {
+        Value::AwaitablePtr awaiting;
+        Value value;
+    };
+
+    /**
+     * @param globals Окружение модуля; родитель локального окружения кадра
+     */
+    Coroutine(std::shared_ptr<const FunctionNode> function, const std::vector<Value> &args, Environment &globals);
+
+    /**
+     * @brief Продолжает выполнение; sent — результат ожидания, на котором кадр остановился
+     * @throws std::runtime_error При ошибке выполнения тела; сопрограмма после этого завершена
+     */
+    Step resume(const Value &sent);
+
+    /**
+     * @brief Отмечает, что сопрограмму ожидает задача; повторное ожидание — ошибка, как в Python
+     * @throws std::runtime_error Если сопрограмма уже ожидается или завершена
+     */
+    void claim();
+
+    [[nodiscard]] const char *typeName() const override { return "coroutine"; }
+    void repr(std::string &out) const override;
+
+private:
+    struct Cursor {
+        const std::vector<std::shared_ptr<ASTNode>> *block;
+        size_t next = 0;
+        const WhileNode *loop = nullptr; //блок — тело цикла: после него условие проверяется снова
+    };
+
+    Step finish();
+    void enter(const ASTNode *statement);
+
+    std::shared_ptr<const FunctionNode> function;
+    Environment locals;
+    std::vector<Cursor> cursors;
+    const ASTNode *pending = nullptr; //инструкция, ожидающая результата await
+    bool claimed = false;
+    bool finished = false;
+};
+
+#endif // COROUTINE_H
@@ -3,6 +3,7 @@
 
 #include "Value.h"
 #include <unordered_map>
+#include <unordered_set>
 
 /**
  * @class Environment
@@ -11,13 +12,38 @@
  * Класс Environment служит хранилищем для переменных в заданной области видимости.
  * Он позволяет хранить и получать именованные значения, что делает его полезным для управления
  * переменными и связанными с ними данными в рамках определенного контекста.
+ *
+ * @details
+ * Окружение вызова функции создаётся с родительским (глобальным) окружением: чтение переменной,
+ * не найденной локально, продолжается в родителе, а запись всегда создаёт локальную переменную.
  */
 class Environment {
 public:
+    Environment() = default;
+    explicit Environment(Environment *parent) : parent(parent) {}
+
     void set(const QString& name, const Value& value);
     Value& get(const QString& name);
+    Value* find(const QString& name);
+    Value& getLocal(const QString& name);
+    Value* findLocal(const QString& name);
+
+    /**
+     * @brief Возвращает окружение верхнего уровня (модуля)
+     */
+    Environment &globals() { return parent ? parent->globals() : *this; }
+
+    /**
+     * @brief Возвращает переменные, определённые в этом окружении (без родительских)
+     */
+    [[nodiscard]] const std::unordered_map<QString, Value> &locals() const { return variables; }
+
+    bool returning = false; //выполнена инструкция return, инструкции блока пропускаются
+    Value returnValue;
+    std::unordered_set<QString> imported; //пути модулей, уже выполненных в этом окружении (см. ModuleCache::import)
 private:
     std::unordered_map<QString, Value> variables;
+    Environment *parent = nullptr;
 };
 
-#endif // ENVIRONMENT_H
\ No newline at end of file
+#endif // ENVIRONMENT_H
@@ -0,0 +1,141 @@
+#ifndef EVENTLOOP_H
+#define EVENTLOOP_H
+
+#include "Coroutine.h"
+#include "Value.h"
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Environment;
+
+/**
+ * @class EventLoop
+ * @brief Цикл событий для сопрограмм (`async def`) на epoll: таймеры и неблокирующие файловые
+ * дескрипторы (каналы, процессы, локальные сокеты) в одном потоке.
+ *
+ * `run(coro)` создаёт цикл в текущем потоке и выполняет сопрограмму как задачу (`Task`). Задача ведёт
+ * стек кадров сопрограмм: ожидание сопрограммы добавляет её кадр, а ожидание `Future` приостанавливает
+ * задачу до завершения операции. Операции ввода-вывода сначала выполняются сразу, а если дескриптор
+ * не готов — регистрируются в epoll и повторяются, когда он станет готов. Поэтому тысячи ожидающих
+ * каналов и сокетов обслуживаются одним потоком ОС без блокирующих вызовов.
+ *
+ * @details
+ * Встроенные функции (имена — как в asyncio и os, без модулей):
+ * - `run(coro)` — выполняет сопрограмму до завершения и возвращает её результат;
+ * - `create_task(coro)` — запускает сопрограмму параллельно с текущей задачей и возвращает `Task`;
+ * - `gather(list)` — ожидание всех сопрограмм и задач списка, результат — список их результатов;
+ * - `sleep(seconds)` — ожидание таймера;
+ * - `pipe()` — неблокирующий канал `[r, w]`; `fd_read(fd, n)`, `fd_write(fd, data)` — ожидаемые чтение
+ *   (до n байт, `b''` в конце потока) и полная запись; `fd_close(fd)` — закрытие дескриптора;
+ * - `open_process(cmd)` — запуск команды оболочки, вывод которой читается из канала: `[pid, fd]`;
+ *   `wait_process(pid)` — ожидание завершения процесса, результат — код возврата;
+ * - `unix_listen(path)`, `unix_accept(fd)`, `unix_connect(path)` — локальные сокеты.
+ *
+ * Ошибка в сопрограмме завершает её задачу, а ошибка задачи, переданной в `run`, — вызов `run`.
+ * Если задача `run` ожидает, но ни таймеров, ни дескрипторов, ни готовых задач нет, `run` завершается
+ * ошибкой, а не зависает. Цикл есть только в Linux; на других платформах функции завершаются ошибкой.
+ *
+ * В задаче `GreenScheduler` цикл не блокирует поток ОС: если готовых обратных вызовов нет, задача
+ * приостанавливается до готовности epoll цикла или срока ближайшего таймера (`GreenScheduler::wait`),
+ * а поток блокируется планировщиком, только когда ждут все его задачи.
+ */
+class EventLoop {
+public:
+    using Callback = std::function<void()>;
+
+    /**
+     * @brief Попытка выполнить операцию над готовым дескриптором
+     * @return true, если операция завершена (успешно или с ошибкой); false — дескриптор ещё не готов
+     */
+    using Attempt = std::function<bool()>;
+
+    static Value run(const std::vector<Value> &args, Environment &env);
+    static Value createTask(const std::vector<Value> &args);
+    static Value gather(const std::vector<Value> &args);
+    static Value sleep(const std::vector<Value> &args);
+    static Value pipe(const std::vector<Value> &args);
+    static Value read(const std::vector<Value> &args);
+    static Value write(const std::vector<Value> &args);
+    static Value close(const std::vector<Value> &args);
+    static Value openProcess(const std::vector<Value> &args);
+    static Value waitProcess(const std::vector<Value> &args);
+    static Value unixListen(const std::vector<Value> &args);
+    static Value unixAccept(const std::vector<Value> &args);
+    static Value unixConnect(const std::vector<Value> &args);
+
+    /**
+     * @brief Заменяет цикл событий текущего потока на loop и возвращает прежний
+     *
+     * Используется `GreenScheduler`: у каждой задачи свой цикл, который подменяется при переключении задач.
+     */
+    static EventLoop *exchangeCurrent(EventLoop *loop) { return std::exchange(current, loop); }
+
+private:
+    class Task;
+    using Clock = std::chrono::steady_clock;
+
+    struct Timer {
+        Clock::time_point deadline;
+        std::uint64_t sequence; //таймеры с одинаковым сроком срабатывают в порядке добавления
+        Callback callback;
+
+        bool operator>(const Timer &other) const {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    /**
+     * Операции, ожидающие готовности дескриптора; выполняются по очереди.
+     */
+    struct Watch {
+        std::deque<Attempt> readers;
+        std::deque<Attempt> writers;
+        std::vector<std::shared_ptr<Future>> futures; //завершаются ошибкой при закрытии дескриптора
+        std::uint32_t events = 0; //маска, зарегистрированная в epoll
+    };
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    /**
+     * @brief Цикл, выполняющийся в текущем потоке
+     * @throws std::runtime_error Если цикл не запущен
+     */
+    static EventLoop &running(const char *function);
+
+    void callSoon(Callback callback);
+    void callLater(Clock::duration delay, Callback callback);
+
+    /**
+     * @brief Выполняет attempt сразу или, если дескриптор не готов, когда epoll сообщит о готовности
+     * @param future Операция, которая завершается ошибкой, если дескриптор закроют раньше
+     */
+    void submit(int fd, bool writing, Attempt attempt, const std::shared_ptr<Future> &future);
+    void forget(int fd);
+    void update(int fd, Watch &watch);
+    void dispatch(int fd, std::uint32_t events);
+    void poll(bool block);
+
+    std::shared_ptr<Task> spawn(const std::shared_ptr<Coroutine> &coroutine);
+    std::shared_ptr<Future> awaitableOf(const Value &value, const char *function);
+
+    static inline thread_local EventLoop *current = nullptr;
+
+    int epoll = -1;
+    std::deque<Callback> ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+    std::uint64_t timerSequence = 0;
+    std::unordered_map<int, Watch> watches;
+};
+
+#endif // EVENTLOOP_H
@@ -0,0 +1,144 @@
+#ifndef FILE_H
+#define FILE_H
+
+#include "Buffer.h"
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class Value;
+
+/**
+ * @class File
+ * @brief Представляет файловый объект, возвращаемый встроенной функцией `open(path[, mode])`.
+ *
+ * Режимы `r`, `w`, `a` с необязательным `b` (двоичный режим) или `t`. В текстовом режиме чтение возвращает
+ * строки (UTF-8), запись принимает строки; в двоичном — `bytes` и байтовые объекты. Методы: `read([n])`,
+ * `readline()`, `readlines()`, `lineview()`, `readinto(buffer)` (только двоичный режим), `write(data)`,
+ * `flush()`, `close()`.
+ *
+ * @details
+ * Большие обычные файлы (от `mapThreshold` байт) читаются через отображение в память: чтение строки
+ * не выполняет системных вызовов, а `lineview()` возвращает memoryview на строку прямо в отображении,
+ * без копирования. Отображение удерживается буферами выданных memoryview и остаётся валидным после
+ * `close()`. В POSIX отображение создаётся `mmap` независимо от `QFile`, поэтому `close()` закрывает
+ * дескриптор файла сразу, даже если memoryview ещё живы; в Windows отображение принадлежит `QFile`,
+ * и файл остаётся открытым, пока жив последний memoryview. Прочитанные страницы отображения освобождаются по мере продвижения, поэтому обход файла
+ * любого размера занимает постоянный объём памяти. Остальные файлы (небольшие, каналы, устройства)
+ * читаются блоками по `bufferSize` байт. Запись накапливается в буфере того же размера; буфер
+ * записывается при заполнении, `flush()`, `close()` и уничтожении объекта.
+ *
+ * Перевод строки не преобразуется: `\r\n` остаётся в прочитанной строке.
+ */
+class File {
+public:
+    using Method = Value (*)(File &self, const std::vector<Value> &args);
+
+    static constexpr qint64 mapThreshold = 1 << 20; //размер файла, начиная с которого он отображается в память
+    static constexpr size_t bufferSize = 1 << 16; //размер блока чтения и буфера записи
+
+    /**
+     * @brief Реализация `open` для таблицы встроенных функций
+     * @throws std::runtime_error Если режим некорректен или файл не удалось открыть
+     */
+    static Value open(const std::vector<Value> &args);
+
+    File(std::shared_ptr<QFile> file, QString mode, bool binary, bool writable);
+    ~File();
+
+    File(const File &) = delete;
+    File &operator=(const File &) = delete;
+
+    /**
+     * @brief Возвращает тип значения (`TextIOWrapper`, `BufferedReader` или `BufferedWriter`)
+     */
+    [[nodiscard]] const char *typeName() const;
+
+    /**
+     * @brief Возвращает представление значения (`<_io.TextIOWrapper name='log.txt' mode='r'>`)
+     */
+    [[nodiscard]] QString repr() const;
+
+    /**
+     * @brief Читает до size символов (в двоичном режиме — байт) или, если size < 0, всё до конца файла
+     */
+    Value read(qint64 size);
+
+    /**
+     * @brief Читает строку вместе с `\n`; в конце файла возвращает пустую строку
+     */
+    Value readLine();
+
+    /**
+     * @brief Возвращает следующую строку как memoryview (пустой в конце файла); для отображённого файла — без копирования
+     */
+    Value lineView();
+
+    /**
+     * @brief Читает в target не больше его длины байт
+     * @return Число прочитанных байт (0 в конце файла)
+     * @throws std::runtime_error Если буфер доступен только для чтения или не непрерывен
+     */
+    qint64 readInto(const Buffer &target);
+
+    /**
+     * @brief Записывает строку (текстовый режим) или байтовый объект (двоичный режим)
+     * @return Число записанных символов или байт
+     */
+    qint64 write(const Value &data);
+
+    void flush();
+    void close();
+
+    [[nodiscard]] bool isBinary() const { return binary; }
+
+    /**
+     * @brief Вызывает метод name файла self с аргументами args
+     * @throws std::runtime_error Если метод не существует, аргументы некорректны, файл закрыт или произошла ошибка ввода-вывода
+     */
+    static Value call(File &self, const QString &name, const std::vector<Value> &args);
+
+private:
+    static const std::unordered_map<QString, Method> &methods();
+
+    void requireOpen(const char *method, bool writing) const;
+
+    /**
+     * Непрочитанные данные с текущей позиции: не меньше want байт, если файл не закончился раньше.
+     */
+    std::string_view available(size_t want);
+
+    /**
+     * Длина следующей строки в байтах вместе с `\n` (0 в конце файла).
+     */
+    size_t lineLength();
+
+    void consume(size_t size);
+    [[nodiscard]] Value decoded(std::string_view bytes) const;
+
+    std::shared_ptr<QFile> file; //nullptr после close()
+    QString name;
+    QString mode;
+    bool binary;
+    bool writable;
+
+    //чтение через отображение
+    std::shared_ptr<const uchar> mapping; //удерживается и буферами memoryview
+    const uchar *mapped = nullptr; //mapping.get(); nullptr после close()
+    qint64 mappedSize = 0;
+    qint64 position = 0;
+    qint64 released = 0; //начало ещё не освобождённой части отображения
+
+    //чтение блоками
+    std::string buffer;
+    size_t start = 0; //начало непрочитанных данных в buffer
+    bool eof = false;
+
+    std::string pending; //данные, ожидающие записи
+};
+
+#endif // FILE_H
@@ -0,0 +1,48 @@
+#ifndef FROZEN_H
+#define FROZEN_H
+
+#include "Value.h"
+#include <cstddef>
+
+/**
+ * @class Frozen
+ * @brief Глубоко неизменяемые («замороженные») значения, которые разделяются между потоками без копирования.
+ *
+ * `freeze(value)` копирует граф из чисел, строк, байтов, списков и словарей в общую область памяти
+ * процесса. Объекты области бессмертны (как immortal objects в CPython): они не освобождаются,
+ * а указатели на них не имеют счётчика ссылок (`use_count() == 0`), поэтому копирование
+ * замороженного значения в любом потоке не выполняет атомарных операций и не вызывает борьбы
+ * за строки кэша. Большую таблицу достаточно заморозить один раз, после чего все рабочие потоки
+ * (`parallel_map`, `SubInterpreter`) читают её без копий.
+ *
+ * @details
+ * Неизменяемость обеспечивается тем, что ни одна операция не изменяет объект на месте без
+ * проверки `use_count() == 1`: строки заморожены уже выровненными и с вычисленным хешем,
+ * bytearray становится bytes, а для списков и словарей операций изменения нет. Разделяемые
+ * подграфы и циклы исходного графа сохраняются. Функции, memoryview, сопрограммы и файлы заморозить нельзя.
+ *
+ * Область не освобождается до завершения процесса: каждая заморозка незамороженного значения, в том числе
+ * встроенной функцией `freeze` в цикле, увеличивает её на размер графа. Замораживать стоит долгоживущие
+ * данные и один раз; повторная заморозка уже замороженного значения памяти не занимает.
+ */
+class Frozen {
+public:
+    /**
+     * @brief Возвращает замороженную копию value (или само value, если оно уже заморожено или является числом)
+     * @throws std::runtime_error Если граф содержит функцию, memoryview, сопрограмму или файл
+     */
+    static Value freeze(const Value &value);
+
+    /**
+     * @brief Проверяет, что value не требует копирования при передаче в другой поток
+     * (число, логическое значение или замороженный объект)
+     */
+    static bool isFrozen(const Value &value);
+
+    /**
+     * @brief Объём памяти, занятой заголовками замороженных объектов, в байтах
+     */
+    static size_t heapBytes();
+};
+
+#endif // FROZEN_H
@@ -0,0 +1,158 @@
+#ifndef GREENSCHEDULER_H
+#define GREENSCHEDULER_H
+
+#include "SubInterpreter.h"
+#include <QString>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/**
+ * @class GreenScheduler
+ * @brief Выполняет много скриптов в одном потоке ОС как зелёные потоки (задачи) с вытеснением по числу шагов.
+ *
+ * Каждая задача — изолированный экземпляр интерпретатора (см. `SubInterpreter::run`) с собственным
+ * стеком, на котором лежат кадры её вложенных вызовов `eval`. Интерпретатор отсчитывает шаги задачи
+ * (итерации циклов `while` и вызовы функций, см. `step`) дешёвым счётчиком потока; когда квант
+ * исчерпан, задача уступает поток следующей в очереди. Поэтому бесконечный цикл в одном скрипте
+ * не задерживает остальные, а время ответа остаётся равномерным даже для тысяч задач на одном ядре.
+ *
+ * @details
+ * Задача, превысившая лимит шагов (`Options::maxSteps`) или время выполнения (`Options::maxTime`,
+ * суммарная длительность её квантов), завершается ошибкой: исключение раскручивает её стек
+ * в точке переключения. Вывод, глубина вызовов, таблица состояний циклов (`LoopStates`) и обработчик `ModuleCache::prepare` у каждой задачи
+ * свои и подменяются при переключении, как и цикл событий сопрограмм (`EventLoop`). Задача, цикл событий которой
+ * ждёт таймера или ввода-вывода (`wait`), не входит в очередь, пока ожидание не завершится; если готовых задач нет,
+ * планировщик блокирует поток ОС до первого события ожидающих задач. Глубина рекурсии в задаче ограничена также размером её стека:
+ * вызов функции, которому осталось меньше `stackReserve` байт стека, завершается ошибкой рекурсии,
+ * а не переполнением. JIT-компилятор в задачах не используется: в машинном коде
+ * нет точек переключения. Стек задачи выделяется при первом запуске и освобождается при завершении.
+ *
+ * @code
+ * GreenScheduler scheduler;
+ * std::vector<std::future<SubInterpreter::Result>> results;
+ * for (const auto &program : programs) results.push_back(scheduler.spawn(program));
+ * scheduler.run();
+ * @endcode
+ */
+class GreenScheduler {
+public:
+    /**
+     * @struct Options
+     * @brief Настройки планировщика, задаваемые флагами командной строки
+     */
+    struct Options {
+        int quantum = 10000; //--green-quantum: число шагов задачи до переключения
+        std::uint64_t maxSteps = 0; //--task-steps: лимит шагов задачи, 0 — без лимита
+        std::chrono::milliseconds maxTime{0}; //--task-time: лимит времени выполнения задачи в мс, 0 — без лимита
+        std::size_t stackSize = 8 << 20; //--task-stack: размер стека задачи в байтах (не меньше minStackSize)
+    };
+
+    static constexpr std::size_t minStackSize = 256 << 10;
+
+    /**
+     * Запас стека задачи, который не используется вызовами функций: вызов, при котором стека
+     * остаётся меньше, завершается ошибкой рекурсии (см. `FunctionNode::stackLimit`).
+     */
+    static constexpr std::size_t stackReserve = 128 << 10;
+
+    /**
+     * @brief Возвращает настройки, с которыми создаются планировщики
+     */
+    static Options &options();
+
+    /**
+     * @brief Разбирает флаги `--green-quantum=N`, `--task-steps=N`, `--task-time=MS`, `--task-stack=KiB`
+     * @return true, если флаг относится к планировщику
+     * @throws std::runtime_error Если значение флага некорректно
+     */
+    static bool parseFlag(const QString &flag);
+
+    explicit GreenScheduler(Options settings = options());
+    ~GreenScheduler();
+
+    GreenScheduler(const GreenScheduler &) = delete;
+    GreenScheduler &operator=(const GreenScheduler &) = delete;
+
+    /**
+     * @brief Добавляет задачу, выполняющую program; задача запускается в `run`
+     * @param inputs Начальные глобальные переменные (см. `SubInterpreter::run`)
+     * @return Результат, готовый после завершения задачи
+     */
+    std::future<SubInterpreter::Result> spawn(SubInterpreter::Program program, SubInterpreter::Bindings inputs = {});
+
+    /**
+     * @brief Выполняет задачи в текущем потоке по кругу, пока все они не завершатся
+     * @throws std::runtime_error При вызове из задачи или если не удалось выделить стек
+     */
+    void run();
+
+    /**
+     * @brief Точка переключения: отсчитывает шаг текущей задачи и уступает поток, когда квант исчерпан
+     *
+     * Вне задачи счётчик не достигает нуля, и вызов сводится к вычитанию.
+     *
+     * @throws std::runtime_error Если задача превысила лимит шагов или времени
+     */
+    static void step() {
+        if (--budget < 0) preempt();
+    }
+
+    /**
+     * @brief Проверяет, что текущий код выполняется задачей планировщика
+     */
+    static bool inTask() { return current != nullptr; }
+
+    /**
+     * @brief Проверяет, что текущая задача может уступить поток (в планировщике есть другие задачи)
+     */
+    static bool canYield();
+
+    /**
+     * @brief Уступает поток другим задачам до следующего кванта текущей задачи
+     *
+     * Вне задачи и при отсутствии других задач ничего не делает. В шаги задачи засчитываются только
+     * выполненные шаги кванта.
+     *
+     * @throws std::runtime_error Если задача превысила лимит времени
+     */
+    static void yield();
+
+    /**
+     * @brief Приостанавливает текущую задачу, пока дескриптор epoll fd не станет готов к чтению или не наступит deadline
+     *
+     * Пока задача ждёт, выполняются другие задачи; если готовых задач нет, планировщик ждёт в epoll_wait
+     * дескрипторов всех ожидающих задач до ближайшего срока. Вне задачи ничего не делает.
+     *
+     * @throws std::runtime_error Если задача превысила лимит времени
+     */
+    static void wait(int fd, std::chrono::steady_clock::time_point deadline);
+
+private:
+    struct Task;
+
+    static void preempt();
+    static void suspend(std::uint64_t consumed, bool carried); //учитывает квант и возвращает управление в run
+    static void enter(); //точка входа стека задачи
+
+    void resume(Task &task);
+    void release(Task &task);
+    void park(std::unique_ptr<Task> task);
+    void wake(bool block); //возвращает в очередь задачи, ожидание которых завершилось
+    [[nodiscard]] std::size_t stackSize() const;
+
+    static inline thread_local std::int64_t budget = std::numeric_limits<std::int64_t>::max();
+    static inline thread_local Task *current = nullptr;
+
+    Options settings;
+    std::deque<std::unique_ptr<Task>> ready;
+    std::vector<std::unique_ptr<Task>> waiting; //задачи, приостановленные в wait
+    int epoll = -1; //дескрипторы ожидающих задач; создаётся при первом ожидании
+    void *context = nullptr; //контекст потока, в который задачи возвращают управление
+};
+
+#endif // GREENSCHEDULER_H
@@ -0,0 +1,82 @@
+#ifndef INCREMENTALPARSER_H
+#define INCREMENTALPARSER_H
+
+#include "Lexer.h"
+#include <QString>
+#include <memory>
+#include <unordered_map>
+
+class ASTNode;
+
+/**
+ * @class StatementCache
+ * @brief Разобранные инструкции, найденные по их последовательности токенов.
+ *
+ * Используется парсером (см. `Parser::parseStatement`): перед разбором инструкции определяется
+ * её протяжённость в потоке токенов, и если та же последовательность токенов уже разбиралась,
+ * повторно используется готовое дерево. Инструкции кэшируются на любой глубине вложенности,
+ * поэтому изменение одной строки тела цикла требует разбора только этой инструкции и
+ * охватывающих её составных инструкций.
+ *
+ * @details
+ * Деревья в кэше не должны изменяться: перед выполнением они копируются (см. `AstTraversal::clone`).
+ * Номера строк в ключ не входят — сдвиг инструкции вставленной выше строкой не мешает повторному использованию.
+ */
+class StatementCache {
+public:
+    /**
+     * @brief Вычисляет ключ инструкции, начинающейся с токена start
+     * @param end Индекс токена, следующего за инструкцией (перевод строки после неё в инструкцию не входит)
+     */
+    static QString key(const QVector<Token> &tokens, int start, int &end);
+
+    [[nodiscard]] std::shared_ptr<ASTNode> find(const QString &key) const;
+    void store(const QString &key, std::shared_ptr<ASTNode> statement);
+
+private:
+    static constexpr size_t maxEntries = 4096;
+
+    std::unordered_map<QString, std::shared_ptr<ASTNode>> statements;
+};
+
+/**
+ * @class IncrementalParser
+ * @brief Лексический и синтаксический анализ текста, который многократно редактируется (блоки REPL).
+ *
+ * Текст лексируется построчно: токены каждой физической строки запоминаются по её содержимому,
+ * и при повторном разборе заново лексируются только изменённые строки. Токены отступов и переводов
+ * строк вычисляются из ширины отступа строк по тем же правилам, что и в `Lexer::tokenize`, поэтому
+ * поток токенов совпадает с результатом обычного лексера. Если строка не лексируется отдельно
+ * (например, строковый литерал продолжается на следующей строке), весь текст лексируется обычным лексером.
+ *
+ * Разбор выполняется с `StatementCache`: неизменённые инструкции берутся из кэша.
+ */
+class IncrementalParser {
+public:
+    /**
+     * @brief Разбирает текст как последовательность инструкций
+     * @return Узел BlockNode, который можно оптимизировать и выполнять (копия кэшированных деревьев)
+     * @throws std::runtime_error При лексической или синтаксической ошибке
+     */
+    std::shared_ptr<ASTNode> parse(const QString &source);
+
+    /**
+     * @brief Разбивает текст на токены, повторно используя токены неизменённых строк
+     */
+    QVector<Token> tokenize(const QString &source);
+
+private:
+    static constexpr size_t maxLines = 4096;
+
+    struct LineTokens {
+        QVector<Token> tokens; //токены содержимого строки, номера строк отсчитываются от 1
+        Lexer::Indent indent;
+    };
+
+    const LineTokens *lexLine(const QString &text);
+
+    std::unordered_map<QString, LineTokens> lines;
+    StatementCache statements;
+};
+
+#endif // INCREMENTALPARSER_H
@@ -2,6 +2,7 @@
 #define INTERPRETER_H
 #include <qlist.h>
 #include <QString>
+#include "PassManager.h"
 
 /**
  * @class Interpreter
@@ -14,7 +15,17 @@
  */
 class Interpreter {
 public:
-    void run(int argc, char* argv[]);
+    /**
+     * @brief Запускает интерпретатор
+     *
+     * Аргументы, начинающиеся с `-`, — флаги (`--jit`, `-O2`, ...). Первый аргумент без `-` — путь
+     * к скрипту: файл выполняется целиком вместо интерактивного сеанса. С флагом `-j` все
+     * оставшиеся аргументы — пути к скриптам, которые выполняются одновременно; с флагом `-g` —
+     * то же в одном потоке с переключением задач (см. `GreenScheduler`).
+     *
+     * @return Код завершения процесса
+     */
+    int run(int argc, char* argv[]);
 private:
     QVector<int> indentStack;
     bool inBlock = false;
@@ -24,6 +35,12 @@ private:
 
     bool isBlockStatement(const QString&);
     int getIndentLevel(const QString&);
+    PassManager passManager;
+
+    void optimize(std::shared_ptr<ASTNode> &ast, Environment &env);
+    int runScript(const QString &path);
+    int runScripts(const std::vector<QString> &paths, bool green);
+    void printStatistics() const;
 };
 
 #endif // INTERPRETER_H
\ No newline at end of file
@@ -0,0 +1,223 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include "Environment.h"
+#include <QString>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__linux__)
+#define MYPYTHON_JIT 1
+#endif
+
+class WhileNode;
+
+/**
+ * @struct JitOptions
+ * @brief Настройки JIT-компилятора, задаваемые флагами командной строки.
+ */
+struct JitOptions {
+    bool enabled = false; //--jit
+    int hotLoopThreshold = 1000; //--jit-threshold: число итераций цикла в интерпретаторе до компиляции
+    int maxBailouts = 8; //--jit-max-bailouts: число выходов в интерпретатор, после которого код отбрасывается
+    std::size_t codeCacheSize = 1 << 20; //--jit-cache-size: объём исполняемой памяти в байтах
+    bool printStats = false; //--jit-stats
+};
+
+/**
+ * @struct CodeBlock
+ * @brief Участок исполняемой памяти с машинным кодом одного скомпилированного цикла.
+ *
+ * Блок принадлежит `CodeCache`. При вытеснении память освобождается, а поле memory обнуляется,
+ * поэтому владельцы указателя на блок обязаны проверять isValid() перед вызовом кода.
+ */
+struct CodeBlock {
+    void *memory = nullptr;
+    std::size_t size = 0;
+    std::uint64_t lastUse = 0;
+
+    [[nodiscard]] bool isValid() const { return memory != nullptr; }
+};
+
+/**
+ * @class CodeCache
+ * @brief Управляет исполняемой памятью JIT-компилятора.
+ *
+ * Каждый блок кода размещается в отдельных страницах: код записывается в память с правами
+ * чтения и записи, после чего права меняются на чтение и исполнение (W^X). Суммарный объём
+ * ограничен ёмкостью кеша; при нехватке места вытесняются давно не использовавшиеся блоки (LRU).
+ */
+class CodeCache {
+public:
+    explicit CodeCache(std::size_t capacity) : capacity(capacity) {}
+    ~CodeCache();
+
+    CodeCache(const CodeCache &) = delete;
+    CodeCache &operator=(const CodeCache &) = delete;
+
+    /**
+     * @brief Размещает машинный код в исполняемой памяти, при необходимости вытесняя старые блоки
+     * @return Блок кода или nullptr, если код не помещается в кеш или память не выделена
+     */
+    std::shared_ptr<CodeBlock> install(const std::vector<std::uint8_t> &code);
+
+    /**
+     * @brief Отмечает использование блока (для политики вытеснения)
+     */
+    void touch(CodeBlock &block) { block.lastUse = ++clock; }
+
+    /**
+     * @brief Освобождает память блока
+     */
+    void release(CodeBlock &block);
+
+    void setCapacity(const std::size_t bytes) { capacity = bytes; }
+    [[nodiscard]] std::size_t usedBytes() const { return used; }
+
+    std::size_t evictions = 0;
+
+private:
+    void evictOne();
+
+    std::size_t capacity;
+    std::size_t used = 0;
+    std::uint64_t clock = 0;
+    std::list<std::shared_ptr<CodeBlock>> blocks;
+};
+
+/**
+ * @class CompiledLoop
+ * @brief Результат компиляции цикла `while`: машинный код и описание его кадра.
+ *
+ * Кадр — массив 64-битных ячеек: первые slotNames.size() ячеек содержат распакованные значения
+ * переменных цикла (int, double или bool), следующие столько же — их копию на начало текущей
+ * итерации, из которой значения восстанавливаются при выходе в интерпретатор.
+ */
+class CompiledLoop {
+public:
+    enum class SlotType : std::uint8_t { Int, Double, Bool };
+
+    std::shared_ptr<CodeBlock> code;
+    std::vector<QString> slotNames;
+    std::vector<SlotType> slotTypes;
+    std::vector<bool> slotWritten; //переменная изменяется в цикле и записывается обратно в окружение
+    int bailouts = 0;
+};
+
+/**
+ * @struct LoopState
+ * @brief Состояние цикла `while` для JIT-компилятора.
+ */
+struct LoopState {
+    int hotness = 0; //итерации, выполненные интерпретатором
+    bool rejected = false; //цикл не поддерживается JIT-компилятором
+    std::shared_ptr<CompiledLoop> compiled;
+};
+
+/**
+ * @class LoopStates
+ * @brief Состояние циклов общего дерева (см. `AstTraversal::share`), принадлежащее одному экземпляру интерпретатора.
+ *
+ * Узлы общего дерева выполняются несколькими потоками одновременно и не изменяются, поэтому состояние
+ * их циклов хранится в таблице, которую экземпляр (`SubInterpreter::run`, поток `parallel_map`)
+ * устанавливает в своём потоке на время выполнения. Без таблицы такой цикл выполняется без компиляции.
+ */
+class LoopStates {
+public:
+    /**
+     * @brief Устанавливает таблицу в текущем потоке до конца области видимости
+     */
+    class Scope {
+    public:
+        explicit Scope(LoopStates &states) : previous(exchangeCurrent(&states)) {}
+        ~Scope() { exchangeCurrent(previous); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        LoopStates *previous;
+    };
+
+    /**
+     * @brief Состояние цикла loop в таблице текущего потока или nullptr, если таблица не установлена
+     */
+    static LoopState *find(const WhileNode &loop) { return current ? &current->states[&loop] : nullptr; }
+
+    /**
+     * @brief Заменяет таблицу текущего потока и возвращает прежнюю
+     *
+     * Используется `GreenScheduler`: у каждой задачи своя таблица, которая подменяется при переключении задач.
+     */
+    static LoopStates *exchangeCurrent(LoopStates *states) { return std::exchange(current, states); }
+
+private:
+    static inline thread_local LoopStates *current = nullptr;
+
+    std::unordered_map<const WhileNode *, LoopState> states;
+};
+
+/**
+ * @class Jit
+ * @brief Базовый JIT-компилятор горячих циклов для x86-64 Linux.
+ *
+ * Цикл `while`, выполнивший в интерпретаторе JitOptions::hotLoopThreshold итераций, компилируется
+ * в машинный код, если его условие и тело состоят только из присваиваний, `if`, вложенных циклов
+ * и арифметики над переменными, типы которых (int, double или bool) не меняются внутри цикла.
+ * Значения переменных хранятся в кадре и в регистрах в распакованном виде.
+ *
+ * @details
+ * Перед входом в код проверяется, что переменные в окружении имеют те же типы, что и при
+ * компиляции (охранные условия). Операции, которые интерпретатор завершил бы ошибкой (деление
+ * на ноль), в машинном коде приводят к выходу в интерпретатор: состояние откатывается на начало
+ * итерации, и интерпретатор выполняет её сам. На других платформах компиляция не выполняется.
+ */
+class Jit {
+public:
+    enum class RunResult { Finished, Bailout, NotEntered, Evicted };
+
+    /**
+     * @brief Возвращает настройки JIT-компилятора
+     */
+    static JitOptions &options();
+
+    /**
+     * @brief Разбирает флаг командной строки `--jit*`
+     * @return true, если флаг относится к JIT-компилятору
+     * @throws std::runtime_error Если значение флага некорректно
+     */
+    static bool parseFlag(const QString &flag);
+
+    /**
+     * @brief Компилирует цикл loop для текущих типов переменных окружения env
+     * @return Скомпилированный цикл или nullptr, если цикл не поддерживается JIT-компилятором
+     */
+    static std::shared_ptr<CompiledLoop> compile(const WhileNode &loop, Environment &env);
+
+    /**
+     * @brief Выполняет скомпилированный цикл, начиная с очередной проверки условия
+     * @return Finished — цикл завершён; Bailout — текущую итерацию нужно выполнить в интерпретаторе;
+     *         NotEntered — типы переменных не совпадают с типами при компиляции;
+     *         Evicted — код вытеснен из кеша и цикл нужно скомпилировать заново
+     */
+    static RunResult run(CompiledLoop &loop, Environment &env);
+
+    /**
+     * @brief Возвращает статистику работы JIT-компилятора в текстовом виде
+     */
+    static QString stats();
+
+private:
+    static CodeCache &codeCache(); //у каждого потока свой: код цикла выполняется тем потоком, что его скомпилировал
+
+    static inline std::atomic<int> compiledLoops = 0;
+    static inline std::atomic<int> rejectedLoops = 0;
+    static inline std::atomic<std::uint64_t> bailouts = 0;
+};
+
+#endif // JIT_H
@@ -16,6 +16,7 @@ enum LexTokenType {
     TOKEN_ID, //для имен переменных
     TOKEN_NUMBER, //для числовых литералов (10, 3.14)
     TOKEN_STRING, //для строковых литералов
+    TOKEN_BYTES, //для байтовых литералов (b"...")
     TOKEN_BOOL, //True, False
     TOKEN_KEYWORD, //if, else, def
     TOKEN_OP, //+, -, =, ==, ()
@@ -54,6 +55,49 @@ class Lexer
 public:
     QVector<Token> tokenize(const QString& code); //Главный метод
 
+    /**
+     * @struct Indent
+     * @brief Отступ физической строки: число пробелов в её начале
+     */
+    struct Indent {
+        int width = 0;
+        bool blank = false; //пустая строка или строка из комментария: отступ не меняется
+    };
+
+    /**
+     * @brief Лексирует одну строку кода, начинающуюся с позиции begin, без токенов отступа
+     *
+     * Строковый литерал может продолжаться на следующих физических строках — тогда строка заканчивается
+     * на первом переводе строки после него.
+     *
+     * @param firstLine Номер строки, с которой начинается begin
+     * @param end Позиция перевода строки, завершившего строку, или длина кода
+     * @throws std::runtime_error При незакрытом литерале или некорректной байтовой строке
+     */
+    QVector<Token> tokenizeLine(const QString& code, int begin, int firstLine, int& end);
+
+    /**
+     * @brief Номер строки, на которой остановился последний вызов tokenizeLine
+     */
+    [[nodiscard]] int currentLine() const { return line; }
+
+    /**
+     * @brief Измеряет отступ строки, начинающейся с позиции begin
+     */
+    static Indent measureIndent(const QString& code, int begin);
+
+    /**
+     * @brief Добавляет перевод строки перед строкой lineNumber и токены INDENT/DEDENT для её отступа
+     *
+     * Несколько переводов строки подряд дают один токен; отступ пустой строки не учитывается.
+     */
+    static void appendLayout(QVector<Token>& tokens, QVector<int>& indentStack, Indent indent, int lineNumber);
+
+    /**
+     * @brief Закрывает открытые отступы и добавляет токен конца файла
+     */
+    static void appendEnd(QVector<Token>& tokens, QVector<int>& indentStack, int lastLine);
+
 private:
     int pos = 0; //текущая позиция в коде
     int line = 1; //текущая строка
@@ -63,6 +107,7 @@ private:
                                                 "TOKEN_ID",
                                                 "TOKEN_NUMBER",
                                                 "TOKEN_STRING",
+                                                "TOKEN_BYTES",
                                                 "TOKEN_BOOL",
                                                 "TOKEN_KEYWORD",
                                                 "TOKEN_OP",
@@ -75,6 +120,7 @@ private:
     Token nextToken(const QString& code); //Следующий токен
     Token readNumber(const QString& code); //Читает число
     Token readString(const QString& code); //Читает строку
+    Token readBytes(const QString& code); //Читает байтовый литерал (b"...")
     Token readIdentifierOrBool(const QString& code); //Читает имя или ключевое слово, или булево значение (True | False)
     Token readOperator(const QString& code); //Читает оператор(+; -; =)
     void skipWhitespace(const QString& code); //Пропускает пробелы, но не \n
@@ -0,0 +1,75 @@
+#ifndef MODULECACHE_H
+#define MODULECACHE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ASTNode;
+class Environment;
+
+/**
+ * @class ModuleCache
+ * @brief Загружает модули (скрипт и файлы, подключаемые через `import`) с кэшированием разобранного AST.
+ *
+ * Разобранное дерево модуля сериализуется в файл `__pycache__/<имя>.myc` рядом с исходным файлом.
+ * Кэш содержит плоскую запись дерева в прямом порядке обхода и пул констант (литералы и имена).
+ * Заголовок кэша хранит версию формата, идентификатор сборки интерпретатора и хеш содержимого
+ * исходного файла: при совпадении всех трёх кэш отображается в память и дерево восстанавливается без лексера и парсера, иначе исходный файл
+ * разбирается заново и кэш перезаписывается.
+ *
+ * @details
+ * В кэш записывается дерево до оптимизации: проходы `PassManager` зависят от окружения выполнения
+ * и выполняются при каждом запуске. Повреждённый или несовместимый кэш не считается ошибкой —
+ * модуль просто разбирается из исходного файла.
+ */
+class ModuleCache {
+public:
+    /**
+     * @brief Версия формата кэша; увеличивается при любом изменении набора узлов или их записи
+     */
+    static constexpr quint32 formatVersion = 4;
+
+    /**
+     * @brief Возвращает разобранное дерево модуля из файла path
+     * @throws std::runtime_error Если файл нельзя прочитать или он содержит синтаксическую ошибку
+     */
+    static std::shared_ptr<ASTNode> load(const QString &path);
+
+    /**
+     * @brief Выполняет модуль name (файл `name.py` в одном из каталогов поиска) в окружении env
+     *
+     * Модуль выполняется в глобальном окружении env один раз: повторный `import` того же файла
+     * ничего не делает. Модуль, завершившийся ошибкой, при следующем `import` выполняется заново.
+     * Каждый экземпляр интерпретатора (окружение) выполняет модуль заново.
+     *
+     * @throws std::runtime_error Если модуль не найден или завершился ошибкой
+     */
+    static void import(const QString &name, Environment &env);
+
+    /**
+     * @brief Разбирает флаг `-B` (не записывать файлы кэша)
+     * @return true, если флаг относится к кэшу модулей
+     */
+    static bool parseFlag(const QString &flag);
+
+    static inline std::vector<QString> searchPath; //каталоги поиска модулей для import
+    static inline thread_local std::function<void(std::shared_ptr<ASTNode> &, Environment &)> prepare; //оптимизация перед выполнением (у каждого потока своя)
+    static inline bool writeCache = true;
+
+private:
+    struct Encoder;
+    struct Decoder;
+
+    static QString cachePath(const QString &sourcePath);
+    static quint64 buildId();
+    static quint64 hash(const char *data, qsizetype size);
+    static std::shared_ptr<ASTNode> read(const QString &cacheFile, quint64 sourceHash);
+    static void write(const QString &cacheFile, quint64 sourceHash, const ASTNode &module);
+    static void encode(Encoder &out, const ASTNode *node);
+    static std::shared_ptr<ASTNode> decode(Decoder &in);
+};
+
+#endif // MODULECACHE_H
@@ -0,0 +1,43 @@
+#ifndef NUMBERFORMAT_H
+#define NUMBERFORMAT_H
+
+#include "Value.h"
+#include <QString>
+#include <string>
+
+/**
+ * @class NumberFormat
+ * @brief Преобразование чисел в текст и обратно без потери точности.
+ *
+ * Вещественные числа выводятся кратчайшей записью, которая при обратном чтении даёт то же число
+ * (как `repr(float)` в Python): цифры получает `std::to_chars` (алгоритм Ryu), а выбор между
+ * обычной и экспоненциальной записью повторяет правила Python. Разбор литералов выполняется
+ * через `std::from_chars` (алгоритм Эйзеля–Лемира) без промежуточных преобразований `QString`.
+ */
+class NumberFormat {
+public:
+    /**
+     * @brief Кратчайшая запись числа, читаемая обратно без потерь: `0.1`, `1.0`, `1e+16`, `1.5e-07`, `inf`, `nan`
+     */
+    static QString toString(double value);
+
+    /**
+     * @brief Дописывает запись `toString(value)` в конец out без создания промежуточной строки QString
+     */
+    static void append(std::string &out, double value);
+
+    /**
+     * @brief Разбирает числовой литерал лексера
+     *
+     * Поддерживаются десятичные целые и вещественные числа с экспонентой (`1.5e-3`),
+     * шестнадцатеричные, восьмеричные и двоичные целые (`0xFF`, `0o17`, `0b101`) и символ `_`
+     * между цифрами (`1_000_000`). Вещественное число, не представимое в double, становится
+     * бесконечностью или нулём.
+     *
+     * @return Значение типа int или double
+     * @throws std::runtime_error Если литерал некорректен или целое не помещается в int
+     */
+    static Value parseLiteral(const QString &literal);
+};
+
+#endif // NUMBERFORMAT_H
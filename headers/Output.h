@@ -0,0 +1,81 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "Value.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class Output
+ * @brief Буферизованный вывод интерпретатора в стандартный поток вывода.
+ *
+ * Результаты выражений REPL, сообщения об ошибках и вывод функции `print` накапливаются в одном
+ * буфере и записываются в stdout одним вызовом при явном сбросе: перед ожиданием ввода в
+ * интерактивном режиме, при завершении работы и при заполнении буфера. Если stdout — терминал,
+ * буфер дополнительно сбрасывается в конце каждой строки, как в Python.
+ *
+ * @details
+ * Значения форматируются сразу в буфер (см. `Repr`) без построения промежуточных строк QString.
+ * Прямой вывод в `std::cout` или `std::cerr` допускается только после `flush()`, иначе нарушится
+ * порядок вывода. Общий буфер stdout не синхронизирован: другие потоки выводят только через `Capture`.
+ */
+class Output {
+public:
+    /**
+     * @brief Размер буфера, при достижении которого он записывается в stdout
+     */
+    static constexpr size_t capacity = 1 << 16;
+
+    /**
+     * @brief Дописывает текст text
+     */
+    static void write(std::string_view text);
+
+    /**
+     * @brief Дописывает представление значения value в том виде, в каком его печатает REPL (`'abc'`, `[1, 2.5]`, `True`)
+     */
+    static void writeRepr(const Value &value);
+
+    /**
+     * @brief Дописывает значения values через пробел с переводом строки в конце, как `print` в Python:
+     * строки выводятся без кавычек, остальные значения — как в REPL
+     */
+    static void print(const std::vector<Value> &values);
+
+    /**
+     * @brief Записывает накопленный текст в stdout
+     */
+    static void flush();
+
+    /**
+     * @brief Перенаправляет вывод текущего потока в строку target (nullptr — в буфер stdout)
+     * @return Строка, в которую вывод перенаправлялся до вызова
+     */
+    static std::string *redirect(std::string *target);
+
+    /**
+     * @class Capture
+     * @brief Перенаправляет вывод текущего потока в строку target на время своего существования
+     *
+     * Используется экземплярами интерпретатора, выполняемыми в рабочих потоках (см. `SubInterpreter`):
+     * их вывод не смешивается и не требует синхронизации.
+     */
+    class Capture {
+    public:
+        explicit Capture(std::string &target);
+        ~Capture();
+
+        Capture(const Capture &) = delete;
+        Capture &operator=(const Capture &) = delete;
+
+    private:
+        std::string *previous;
+    };
+
+private:
+    static std::string &target(); //буфер stdout или строка Capture текущего потока
+    static void afterWrite(); //сбрасывает буфер, если он заполнен или (для терминала) завершена строка
+};
+
+#endif // OUTPUT_H
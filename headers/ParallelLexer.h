@@ -0,0 +1,64 @@
+#ifndef PARALLELLEXER_H
+#define PARALLELLEXER_H
+
+#include "Lexer.h"
+#include <string>
+#include <vector>
+
+/**
+ * @class ParallelLexer
+ * @brief Лексический анализ больших файлов на нескольких потоках.
+ *
+ * Текст делится на фрагменты по границам физических строк, и фрагменты лексируются параллельно
+ * в пуле потоков (`QThreadPool`) построчно (см. `Lexer::tokenizeLine`). Затем результаты
+ * собираются по порядку в одном потоке: токены отступов вычисляются по ширине отступа строк
+ * общим стеком отступов, как в `Lexer::tokenize`. Результат совпадает с потоком токенов
+ * последовательного лексера, включая номера строк и первую из ошибок.
+ *
+ * @details
+ * Строковый литерал может продолжаться за границей фрагмента; тогда начало следующего фрагмента
+ * лексировано неверно. При сборке известно, где на самом деле начинается следующая строка:
+ * если фрагмент содержит строку с этой позицией, его результаты используются с неё, иначе
+ * фрагмент лексируется заново последовательно. Комментарии не продолжаются за концом строки
+ * и согласования не требуют.
+ */
+class ParallelLexer {
+public:
+    /**
+     * @brief Разбивает код на токены; короткий код лексируется в текущем потоке
+     * @throws std::runtime_error При лексической ошибке (той же, что у `Lexer::tokenize`)
+     */
+    static QVector<Token> tokenize(const QString &code);
+
+    static inline int minParallelSize = 1 << 18; //символов; меньшие файлы лексируются последовательно
+
+private:
+    /**
+     * Строка, лексированная отдельно: позиции её начала и завершающего перевода строки, номера
+     * первой и последней физических строк, отступ и токены. Ошибка лексирования сохраняется и
+     * выбрасывается при сборке, только если строка действительно начинается с этой позиции.
+     */
+    struct Line {
+        int begin = 0;
+        int end = 0;
+        int firstLine = 0;
+        int lastLine = 0;
+        Lexer::Indent indent;
+        QVector<Token> tokens;
+        std::string error;
+    };
+
+    /**
+     * Фрагмент текста [begin, limit): строки, начинающиеся в нём.
+     */
+    struct Chunk {
+        int begin = 0;
+        int limit = 0;
+        int firstLine = 0;
+        std::vector<Line> lines;
+    };
+
+    static void lexChunk(const QString &code, Chunk &chunk, bool throwErrors);
+};
+
+#endif // PARALLELLEXER_H
@@ -0,0 +1,40 @@
+#ifndef PARALLELMAP_H
+#define PARALLELMAP_H
+
+#include "Value.h"
+#include <vector>
+
+class Environment;
+
+/**
+ * @class ParallelMap
+ * @brief Встроенная функция `parallel_map(func, items[, chunksize])`: применяет функцию пользователя
+ * к элементам списка в рабочих потоках и возвращает список результатов в исходном порядке.
+ *
+ * Список делится на части по chunksize элементов; каждая часть — задача `WorkStealingPool`,
+ * поэтому простаивающие потоки забирают части у занятых. Вызывающий поток тоже выполняет части,
+ * пока ждёт остальные, так что вложенные вызовы `parallel_map` не блокируют пул.
+ *
+ * @details
+ * Каждый поток выполняет функцию в собственном окружении: копии глобальных переменных вызывающего
+ * кода, в которой функции заменены изолированными копиями (см. `AstTraversal::clone`), а списки,
+ * словари и bytearray скопированы глубоко; элементы списка копируются так же. Поэтому изменения,
+ * сделанные функцией, остаются в копии её потока и не видны вызывающему коду и другим потокам.
+ * Числа, строки, bytes и замороженные значения (см. `Frozen`) разделяются без копирования:
+ * большую таблицу выгодно заморозить перед вызовом. Файлы, memoryview и сопрограммы в потоки
+ * не передаются: такие глобальные переменные в рабочих потоках не определены, а элемент списка
+ * такого типа приводит к ошибке. Результат, содержащий сопрограмму, тоже приводит к ошибке: кадр
+ * сопрограммы ссылается на окружение рабочего потока, которое не переживает вызов. Ленивые строки
+ * выравниваются заранее в вызывающем потоке. Вывод `print` из каждой части собирается отдельно и печатается
+ * в порядке частей. Ошибка в любой части отменяет ещё не начатые части и передаётся вызывающему коду.
+ */
+class ParallelMap {
+public:
+    /**
+     * @brief Реализация `parallel_map` для таблицы встроенных функций
+     * @throws std::runtime_error Если аргументы некорректны или функция завершилась ошибкой
+     */
+    static Value call(const std::vector<Value> &args, Environment &env);
+};
+
+#endif // PARALLELMAP_H
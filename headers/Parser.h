@@ -4,10 +4,46 @@
 #include "Lexer.h"
 #include "Value.h"
 #include "Environment.h"
+#include "StringMethods.h"
+#include "Builtins.h"
+#include "BinaryDispatch.h"
+#include "File.h"
+#include "Jit.h"
+#include "GreenScheduler.h"
+#include "ModuleCache.h"
+#include "IncrementalParser.h"
+#include "NumberFormat.h"
+#include <limits>
 #include <memory>
+#include <optional>
+#include <stdexcept>
+#include <unordered_set>
 #include <cmath>
 #include <utility>
 
+/**
+ * @enum StaticType
+ * @brief Тип значения выражения, доказанный статическим выводом типов (см. `TypeInference`).
+ *
+ * Unknown означает, что тип не доказан и выражение вычисляется обычным образом через `Value`.
+ */
+enum class StaticType : std::uint8_t { Unknown, Int, Double, Bool };
+
+/**
+ * @class StaticTypeMismatch
+ * @brief Сообщает, что доказанный тип выражения не выполняется при вычислении.
+ *
+ * Выбрасывается методами evalInt/evalDouble/evalBool, если результат int переполняется
+ * (интерпретатор в этом случае возвращает double) или переменная содержит значение другого типа,
+ * например после присваивания из модуля или встроенной функции. Исключение перехватывает ближайший
+ * eval() или evalCondition(), который вычисляет выражение заново через `Value`. Типизированные
+ * выражения не имеют побочных эффектов, поэтому повторное вычисление безопасно.
+ */
+class StaticTypeMismatch final : public std::runtime_error {
+public:
+    StaticTypeMismatch() : std::runtime_error("static type mismatch") {}
+};
+
 /**
  * @class ASTNode
  * @brief Представляет узел абстрактного синтаксического дерева (AST) в интерпретаторе языка программирования.
@@ -28,6 +64,86 @@ public:
     virtual Value eval(Environment &env) const = 0;
 
     [[nodiscard]] virtual QString toString() const = 0;
+
+    /**
+     * @brief Дописывает toString() узла в out, начиная строку с indent пробелов
+     *
+     * Инструкции с вложенными блоками переопределяют метод и записывают тело в тот же буфер
+     * с увеличенным отступом, поэтому запись глубоко вложенного дерева занимает линейное время.
+     */
+    virtual void write(QString &out, const int indent) const {
+        out += QString(indent, QChar(' '));
+        out += toString();
+    }
+
+    /**
+     * Тип результата узла, доказанный `TypeInference` для любого его вычисления.
+     * Узлы с известным типом вычисляются методами evalInt/evalDouble/evalBool: значение
+     * не упаковывается в `Value`. Если тип не выполняется, методы выбрасывают `StaticTypeMismatch`.
+     */
+    StaticType staticType = StaticType::Unknown;
+
+    virtual int evalInt(Environment &env) const { return unboxed<int>(eval(env)); }
+    virtual double evalDouble(Environment &env) const { return unboxed<double>(eval(env)); }
+    virtual bool evalBool(Environment &env) const { return unboxed<bool>(eval(env)); }
+
+    /**
+     * @brief Вычисляет числовое выражение типа Int или Double как double
+     */
+    [[nodiscard]] double evalNumber(Environment &env) const {
+        return staticType == StaticType::Double ? evalDouble(env) : evalInt(env);
+    }
+
+    /**
+     * @brief Вычисляет выражение как условие `if`/`while`
+     */
+    [[nodiscard]] bool evalCondition(Environment &env) const {
+        try {
+            switch (staticType) {
+                case StaticType::Int: return evalInt(env) != 0;
+                case StaticType::Double: return evalDouble(env) != 0.0;
+                case StaticType::Bool: return evalBool(env);
+                default: break;
+            }
+        } catch (const StaticTypeMismatch &) {
+            //доказанный тип не выполняется: условие вычисляется через Value
+        }
+        return eval(env).toBool();
+    }
+
+protected:
+    /**
+     * @brief Возвращает альтернативу T значения value
+     * @throws StaticTypeMismatch Если value содержит значение другого типа
+     */
+    template <typename T>
+    static T unboxed(const Value &value) {
+        if (const T *result = std::get_if<T>(&value.data)) return *result;
+        throw StaticTypeMismatch();
+    }
+
+    /**
+     * Дописывает инструкции body, каждую с новой строки с отступом indent.
+     */
+    static void writeBlock(QString &out, const std::vector<std::shared_ptr<ASTNode>> &body, const int indent) {
+        for (const auto &stmt : body) {
+            out += '\n';
+            stmt->write(out, indent);
+        }
+    }
+
+    /**
+     * Выполняет инструкции body до конца или до `return`; lastValue — значение последней выполненной.
+     * Предыдущее значение освобождается до выполнения инструкции: его копия удерживала бы строку
+     * переменной, и `+=` не дописывал бы её на месте (см. `AugAssignNode`).
+     */
+    static void evalBlock(const std::vector<std::shared_ptr<ASTNode>> &body, Environment &env, Value &lastValue) {
+        for (const auto &stmt : body) {
+            lastValue = Value();
+            lastValue = stmt->eval(env);
+            if (env.returning) break;
+        }
+    }
 };
 
 /**
@@ -52,7 +168,7 @@ public:
      * @brief Возвращает строковое представление значения узла.
      *
      * Метод преобразует значение узла в строку на основе типа данных, содержащегося в `Value`.
-     * Поддерживаемые типы данных включают `double`, `int`, `QString` и `bool`. Для типов данных,
+     * Поддерживаемые типы данных включают `double`, `int`, строки, байты и `bool`. Для типов данных,
      * которые не поддерживаются, возвращается строка "<Unknown type of value>".
      *
      * @return Строковое представление значения узла.
@@ -61,13 +177,16 @@ public:
         const auto& data = value.data;
         
         if (std::holds_alternative<double>(data)) {
-            return QString::number(std::get<double>(data));
+            return NumberFormat::toString(std::get<double>(data));
         }
         if (std::holds_alternative<int>(data)) {
             return QString::number(std::get<int>(data));
         }
-        if (std::holds_alternative<QString>(data)) {
-            return "\'" + std::get<QString>(data) + "\'";
+        if (std::holds_alternative<Value::StringPtr>(data)) {
+            return "\'" + std::get<Value::StringPtr>(data)->flatten().toQString() + "\'";
+        }
+        if (std::holds_alternative<Value::BytesPtr>(data)) {
+            return std::get<Value::BytesPtr>(data)->repr();
         }
         if (std::holds_alternative<bool>(data)) {
             return std::get<bool>(data) ? "True" : "False";
@@ -75,7 +194,11 @@ public:
         return "<Unknown type of value>";
     }
 
-    Value eval(Environment &env) const override { return {value}; }
+    Value eval(Environment &) const override { return {value}; }
+
+    int evalInt(Environment &) const override { return *std::get_if<int>(&value.data); }
+    double evalDouble(Environment &) const override { return *std::get_if<double>(&value.data); }
+    bool evalBool(Environment &) const override { return *std::get_if<bool>(&value.data); }
 };
 
 /**
@@ -92,13 +215,15 @@ public:
  * и применения указанного оператора. Если встречается неподдерживаемая операция или комбинация типов операндов,
  * генерируются соответствующие ошибки.
  *
- * Метод `eval` обеспечивает правильную обработку типов (например, числовых, строковых или смешанных) и делегирует конкретные
- * поведения вспомогательным методам, таким как `evalTwoNumbers`, `evalTwoStrings` и `evalNumAndString`.
+ * Метод `eval` обеспечивает правильную обработку типов (например, числовых, строковых или смешанных): обработчик
+ * выбирается по типам операндов в таблице `BinaryDispatch`.
  */
 class BinOpNode final : public ASTNode {
 public:
+    using Operation = BinaryOp;
+
     BinOpNode(std::shared_ptr<ASTNode> left, QString op, std::shared_ptr<ASTNode> right)
-        : left(std::move(left)), op(std::move(op)), right(std::move(right)) {
+        : left(std::move(left)), op(std::move(op)), right(std::move(right)), operation(parseOperation(this->op)) {
     }
 
     [[nodiscard]] QString toString() const override {
@@ -119,115 +244,109 @@ public:
      * @throws std::runtime_error Если операция не поддерживается для данных типов операндов.
      */
     Value eval(Environment &env) const override {
+        try {
+            switch (staticType) {
+                case StaticType::Int: return Value(evalInt(env));
+                case StaticType::Double: return Value(evalDouble(env));
+                case StaticType::Bool: return Value(evalBool(env));
+                default: break;
+            }
+        } catch (const StaticTypeMismatch &) {
+            //доказанный тип не выполняется: операция вычисляется через BinaryDispatch
+        }
         const Value l = left->eval(env);
         const Value r = right->eval(env);
+        return apply(l, r);
+    }
 
-        if (
-            (std::holds_alternative<double>(l.data) || std::holds_alternative<int>(l.data))
-            &&
-            (std::holds_alternative<double>(r.data) || std::holds_alternative<int>(r.data))
-        ) {
-            return evalTwoNumbers(l, r);
-        }
-        if (
-            (std::holds_alternative<QString>(l.data) || std::holds_alternative<int>(l.data))
-            &&
-            (std::holds_alternative<QString>(r.data) || std::holds_alternative<int>(r.data))
-        ) {
-            return std::holds_alternative<QString>(l.data) && std::holds_alternative<QString>(r.data)
-                       ? evalTwoStrings(l, r)
-                       : evalNumAndString(l, r);
+    /**
+     * @brief Вычисляет операцию с доказанным типом результата Int.
+     *
+     * Повторяет семантику числовых обработчиков `BinaryDispatch` без упаковки операндов. Тип Int доказывается
+     * только для арифметики над двумя целыми, поэтому оба операнда вычисляются как int.
+     *
+     * @throws std::runtime_error При делении на ноль.
+     * @throws StaticTypeMismatch Если результат не помещается в int.
+     */
+    int evalInt(Environment &env) const override {
+        const int l = left->evalInt(env);
+        const int r = right->evalInt(env);
+        int result = 0;
+        bool overflow = false;
+        switch (operation) {
+            case Operation::Add: overflow = __builtin_add_overflow(l, r, &result); break;
+            case Operation::Subtract: overflow = __builtin_sub_overflow(l, r, &result); break;
+            case Operation::Multiply: overflow = __builtin_mul_overflow(l, r, &result); break;
+            case Operation::Modulo: checkDivisionByZero(r); return r == -1 ? 0 : l % r; //INT_MIN % -1 вызывает SIGFPE
+            default:
+                checkDivisionByZero(r);
+                overflow = l == std::numeric_limits<int>::min() && r == -1;
+                if (!overflow) result = l / r;
+                break;
         }
+        if (overflow) throw StaticTypeMismatch();
+        return result;
+    }
 
-        throw std::runtime_error("Unsupported operation: " + op.toStdString() + " in eval\n");
+    /**
+     * @brief Вычисляет операцию с доказанным типом результата Double
+     * @throws std::runtime_error При делении на ноль.
+     */
+    double evalDouble(Environment &env) const override {
+        const double lv = left->evalNumber(env);
+        const double rv = right->evalNumber(env);
+        switch (operation) {
+            case Operation::Add: return lv + rv;
+            case Operation::Subtract: return lv - rv;
+            case Operation::Multiply: return lv * rv;
+            case Operation::Power: return pow(lv, rv);
+            case Operation::Modulo: checkDivisionByZero(rv); return std::fmod(lv, rv);
+            case Operation::IntDivide: checkDivisionByZero(rv); return std::trunc(lv / rv);
+            default: checkDivisionByZero(rv); return lv / rv;
+        }
     }
 
     /**
-     * @enum Operation
-     * @brief Представляет операции, которые могут быть выполнены в бинарном узле AST.
-     *
-     * Перечисление `Operation` определяет набор поддерживаемых бинарных операций,
-     * таких как арифметические операции, операции сравнения и операции модификации.
-     * Оно используется для представления и обработки этих операций в синтаксическом анализе
-     * и вычислении узлов AST.
-     *
-     * @details
-     * Операции разбиваются на несколько категорий:
-     * - **Арифметические операции**: Add, Subtract, Multiply, Divide, Modulo, IntDivide, Power.
-     * - **Операции сравнения**: Equal, NotEqual, Greater, GreaterEqual, Less, LessEqual.
-     * Эти операции могут быть применены к числовым значениям, а также могут включать
-     * дополнительную проверку на деление на ноль или другие ошибки выполнения.
-     */
-    enum class Operation {
-        Add, Subtract, Multiply, Power, Divide, Modulo, IntDivide,
-        Equal, NotEqual, Greater, GreaterEqual, Less, LessEqual
-    };
+     * @brief Вычисляет сравнение двух чисел с доказанными типами
+     */
+    bool evalBool(Environment &env) const override {
+        const double lv = left->evalNumber(env);
+        const double rv = right->evalNumber(env);
+        switch (operation) {
+            case Operation::Equal: return lv == rv;
+            case Operation::NotEqual: return lv != rv;
+            case Operation::Greater: return lv > rv;
+            case Operation::GreaterEqual: return lv >= rv;
+            case Operation::Less: return lv < rv;
+            default: return lv <= rv;
+        }
+    }
 
     /**
-     * @brief Вычисляет бинарную операцию между двумя числовыми значениями.
+     * @brief Применяет оператор узла к уже вычисленным операндам.
      *
-     * Этот метод вычисляет результат бинарной операции на основе предоставленных левого и правого операндов.
-     * Он поддерживает арифметические операции, такие как сложение, вычитание, умножение, деление,
-     * а также операции сравнения, такие как равенство, неравенство и реляционные сравнения.
-     * Выполняются дополнительные проверки для операций, которые могут привести к ошибкам времени выполнения,
-     * таких как деление или взятие остатка от деления на ноль.
+     * Обработчик выбирается по типам операндов и операции в таблице `BinaryDispatch`.
+     * Используется как самим узлом, так и составными присваиваниями (`+=`, `-=`), которые
+     * вычисляют операнды самостоятельно.
      *
-     * @param l Левый операнд бинарной операции.
-     * @param r Правый операнд бинарной операции.
-     * @return Результат вычисленной операции, инкапсулированный как `Value`. Точная природа результата
-     *         (числовой, логический и т.д.) зависит от выполненной операции.
-     * @throws std::runtime_error Если операция не поддерживается или недопустима, или если происходит ошибка времени выполнения,
-     *                           такая как деление на ноль.
-     */
-    [[nodiscard]] Value evalTwoNumbers(const Value &l, const Value &r) const {
-        const double lv = getNumericValue(l);
-        const double rv = getNumericValue(r);
-
-        switch (const Operation currentOp = parseOperation(op)) {
-            case Operation::Add: return Value(lv + rv);
-            case Operation::Subtract: return Value(lv - rv);
-            case Operation::Multiply: return Value(lv * rv);
-            case Operation::Power: return Value(pow(lv, rv));
-
-            case Operation::Divide:
-            case Operation::Modulo:
-            case Operation::IntDivide:
-                checkDivisionByZero(rv);
-                if (currentOp == Operation::Divide) return Value(lv / rv);
-                if (currentOp == Operation::Modulo) return Value(static_cast<int>(lv) % static_cast<int>(rv));
-                return Value(static_cast<int>(lv / rv));
-
-            case Operation::Equal: return Value(lv == rv);
-            case Operation::NotEqual: return Value(lv != rv);
-            case Operation::Greater: return Value(lv > rv);
-            case Operation::GreaterEqual: return Value(lv >= rv);
-            case Operation::Less: return Value(lv < rv);
-            case Operation::LessEqual: return Value(lv <= rv);
-            default: throw std::runtime_error("Unsupported operation: " + op.toStdString() + " in evalTwoNumbers");
-        }
-    }
-
-    /**
-     * @brief Извлекает числовое значение из объекта `Value`.
-     *
-     * Этот метод проверяет внутренние данные объекта `Value`. Если они содержат значение типа `double`,
-     * оно возвращается непосредственно. Если данные имеют тип `int`, метод преобразует их в `double`
-     * и возвращает результаты. Это удобно для унификации работы с числовыми значениями, особенно
-     * при выполнении операций, требующих поддержки плавающей точки.
-     *
-     * @param v Объект класса `Value`, содержащий данные, из которых нужно извлечь числовое значение.
-     * @return Значение типа `double`, извлеченное из объекта `Value`. Если данные имеют тип `int`,
-     *         оно будет преобразовано в `double`.
-     * @throws std::bad_variant_access Если данные объекта `Value` не содержат значения допустимого типа
-     *                                 (`int` или `double`).
+     * @param l Левый операнд.
+     * @param r Правый операнд.
+     * @return Результат бинарной операции.
+     * @throws std::runtime_error Если операция не поддерживается для данных типов операндов.
      */
-private:
-    [[nodiscard]] static double getNumericValue(const Value &v) {
-        return std::holds_alternative<double>(v.data)
-        ? std::get<double>(v.data)
-        : std::get<int>(v.data);
+    [[nodiscard]] Value apply(const Value &l, const Value &r) const {
+        return BinaryDispatch::apply(operation, l, r);
     }
 
+private:
+    friend class JitCompiler;
+    friend class TypeInference;
+    friend class AstTraversal;
+    friend class UnreachableBranchPass;
+    friend class DeadStorePass;
+    friend class CommonSubexpressionPass;
+    friend class ModuleCache;
+
     /**
      * @brief Проверяет, делится ли число на ноль.
      *
@@ -273,66 +392,12 @@ private:
         return it->second;
     }
 
-    /**
-     * @brief Вычисляет бинарную операцию над двумя строковыми значениями.
-     *
-     * Выполняет указанную операцию, такую как конкатенация или сравнение, между двумя строковыми значениями.
-     * Если операция не поддерживается, выбрасывается исключение.
-     *
-     * @param l Левый операнд, представленный как `Value`, содержащий `QString`.
-     * @param r Правый операнд, представленный как `Value`, содержащий `QString`.
-     * @return `Value`, представляющий результат операции. Тип результата может варьироваться в зависимости от операции (например, конкатенация возвращает строку, сравнение возвращает логическое значение).
-     * @throws std::runtime_error Если встречается неподдерживаемая операция.
-     */
-    [[nodiscard]] Value evalTwoStrings(const Value &l, const Value &r) const {
-        const QString lv = std::get<QString>(l.data);
-        const QString rv = std::get<QString>(r.data);
-
-        switch (parseOperation(op)) {
-            case Operation::Add: return Value(lv + rv);
-
-            case Operation::Equal: return Value(lv == rv);
-            case Operation::NotEqual: return Value(lv != rv);
-            case Operation::LessEqual: return Value(lv.compare(rv) <= 0);
-            case Operation::Less: return Value(lv.compare(rv) < 0);
-            case Operation::GreaterEqual: return Value(lv.compare(rv) >= 0);
-            case Operation::Greater: return Value(lv.compare(rv) > 0);
-            default: throw std::runtime_error("Unsupported operation: " + op.toStdString() + "in evalTwoStrings");
-        }
-    }
-
-    /**
-     * @brief Вычисляет операцию между числовым и строковым значением.
-     *
-     * Этот метод выполняет операции между числовым значением (целым числом) и строковым значением
-     * в соответствии с типом операции (`op`). В настоящее время поддерживается только оператор умножения (`*`),
-     * который повторяет строку заданное количество раз.
-     *
-     * @param l Левый операнд, который может содержать целое число или строку.
-     * @param r Правый операнд, который может содержать целое число или строку.
-     * @return Объект Value, который содержит результат операции.
-     *         Если `l` - целое число, а `r` - строка, результатом будет `r`, повторенная `l` раз.
-     *         Если `l` - строка, а `r` - целое число, результатом будет `l`, повторенная `r` раз.
-     * @throw std::runtime_error Если тип операции (`op`) не поддерживается.
-     */
-    [[nodiscard]] Value evalNumAndString(const Value &l, const Value &r) const {
-        if (std::holds_alternative<int>(l.data)) {
-            const int lv = std::get<int>(l.data);
-            const QString rv = std::get<QString>(r.data);
-
-            if (op == "*") return Value(rv.repeated(lv));
-            throw std::runtime_error("Unsupported operation: " + op.toStdString());
-        }
-        const QString lv = std::get<QString>(l.data);
-        const int rv = std::get<int>(r.data);
-        if (op == "*") return Value(lv.repeated(rv));
-
-        throw std::runtime_error("Unsupported operation: " + op.toStdString());
-    }
-
     std::shared_ptr<ASTNode> left;
     QString op; // "+", "-", "=", "/", "%", "*", "**", "//", "=="
     std::shared_ptr<ASTNode> right;
+
+private:
+    Operation operation; //разобранный op
 };
 
 /**
@@ -355,6 +420,270 @@ public:
     QString name;
     [[nodiscard]] QString toString() const override { return name; }
     Value eval(Environment &env) const override { return env.get(name); }
+
+    int evalInt(Environment &env) const override { return unboxed<int>(env.get(name)); }
+    double evalDouble(Environment &env) const override { return unboxed<double>(env.get(name)); }
+    bool evalBool(Environment &env) const override { return unboxed<bool>(env.get(name)); }
+};
+
+/**
+ * @class MethodCallNode
+ * @brief Представляет вызов метода объекта (`obj.name(args)`) в абстрактном синтаксическом дереве.
+ *
+ * Узел вычисляет объект и аргументы слева направо, после чего передаёт вызов реализации
+ * встроенных методов соответствующего типа. Сейчас методы поддерживаются у строк (см. `StringMethods`),
+ * `bytes`/`bytearray` (см. `Bytes`), memoryview и файлов (см. `File`).
+ */
+class MethodCallNode final : public ASTNode {
+public:
+    MethodCallNode(std::shared_ptr<ASTNode> object, QString name, std::vector<std::shared_ptr<ASTNode>> args) :
+    object(std::move(object)), name(std::move(name)), args(std::move(args)) {}
+
+    std::shared_ptr<ASTNode> object;
+    QString name;
+    std::vector<std::shared_ptr<ASTNode>> args;
+
+    Value eval(Environment &env) const override {
+        const Value self = object->eval(env);
+        std::vector<Value> argValues;
+        argValues.reserve(args.size());
+        for (const auto& arg : args) {
+            argValues.push_back(arg->eval(env));
+        }
+
+        if (std::holds_alternative<Value::StringPtr>(self.data)) {
+            return StringMethods::call(std::get<Value::StringPtr>(self.data)->flatten(), name, argValues);
+        }
+        if (std::holds_alternative<Value::BytesPtr>(self.data)) {
+            return Bytes::call(*std::get<Value::BytesPtr>(self.data), name, argValues);
+        }
+        if (std::holds_alternative<Value::MemoryViewPtr>(self.data)) {
+            return std::get<Value::MemoryViewPtr>(self.data)->callMethod(name, argValues);
+        }
+        if (std::holds_alternative<Value::FilePtr>(self.data)) {
+            return File::call(*std::get<Value::FilePtr>(self.data), name, argValues);
+        }
+        throw std::runtime_error("Object has no attribute '" + name.toStdString() + "'");
+    }
+
+    [[nodiscard]] QString toString() const override {
+        QString result = object->toString() + "." + name + "(";
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (i > 0) result += ", ";
+            result += args[i]->toString();
+        }
+        return result + ")";
+    }
+};
+
+/**
+ * @class CallNode
+ * @brief Представляет вызов функции (`name(args)`) в абстрактном синтаксическом дереве.
+ *
+ * Узел вычисляет аргументы слева направо и передаёт их в реализацию встроенной функции (см. `Builtins`)
+ * или в функцию, определённую инструкцией `def` (см. `FunctionNode`). Встроенные функции
+ * не переопределяются: имя встроенной функции всегда вызывает её.
+ */
+class CallNode final : public ASTNode {
+public:
+    CallNode(QString name, std::vector<std::shared_ptr<ASTNode>> args) :
+    name(std::move(name)), args(std::move(args)) {}
+
+    QString name;
+    std::vector<std::shared_ptr<ASTNode>> args;
+
+    Value eval(Environment &env) const override {
+        std::vector<Value> argValues;
+        argValues.reserve(args.size());
+        for (const auto& arg : args) {
+            argValues.push_back(arg->eval(env));
+        }
+        if (Builtins::contains(name)) return Builtins::call(name, argValues, env);
+        return callUserFunction(argValues, env);
+    }
+
+    [[nodiscard]] QString toString() const override {
+        QString result = name + "(";
+        for (size_t i = 0; i < args.size(); ++i) {
+            if (i > 0) result += ", ";
+            result += args[i]->toString();
+        }
+        return result + ")";
+    }
+
+private:
+    Value callUserFunction(const std::vector<Value> &argValues, Environment &env) const;
+};
+
+/**
+ * @class ListNode
+ * @brief Представляет литерал списка (`[a, b, c]`) в абстрактном синтаксическом дереве.
+ */
+class ListNode final : public ASTNode {
+public:
+    explicit ListNode(std::vector<std::shared_ptr<ASTNode>> elements) : elements(std::move(elements)) {}
+
+    std::vector<std::shared_ptr<ASTNode>> elements;
+
+    Value eval(Environment &env) const override {
+        Value::List items;
+        items.reserve(elements.size());
+        for (const auto& element : elements) {
+            items.push_back(element->eval(env));
+        }
+        return Value(std::move(items));
+    }
+
+    [[nodiscard]] QString toString() const override {
+        QString result = "[";
+        for (size_t i = 0; i < elements.size(); ++i) {
+            if (i > 0) result += ", ";
+            result += elements[i]->toString();
+        }
+        return result + "]";
+    }
+};
+
+/**
+ * @class SubscriptNode
+ * @brief Представляет индексирование (`a[i]`) и срез (`a[i:j:k]`) в абстрактном синтаксическом дереве.
+ *
+ * Поддерживаются строки, `bytes`/`bytearray`, списки и memoryview. Отрицательные индексы отсчитываются от конца,
+ * границы среза приводятся к длине последовательности по правилам Python.
+ *
+ * @details
+ * Срезы строк с шагом 1 создаются через `Rope::slice`: длинные срезы разделяют буфер исходной
+ * строки, а не копируют его. Срезы memoryview всегда ссылаются на исходный буфер. Срезы списков
+ * создают новый список (элементы при этом не копируются глубоко), так как списки изменяемы.
+ * Индекс байтовой последовательности возвращает целое число, срез — копию того же типа;
+ * срез без копирования даёт memoryview.
+ */
+class SubscriptNode final : public ASTNode {
+public:
+    SubscriptNode(std::shared_ptr<ASTNode> object, std::shared_ptr<ASTNode> index) :
+    object(std::move(object)), start(std::move(index)) {}
+
+    SubscriptNode(std::shared_ptr<ASTNode> object, std::shared_ptr<ASTNode> start,
+                  std::shared_ptr<ASTNode> stop, std::shared_ptr<ASTNode> step) :
+    object(std::move(object)), start(std::move(start)), stop(std::move(stop)), step(std::move(step)), isSlice(true) {}
+
+    std::shared_ptr<ASTNode> object;
+    std::shared_ptr<ASTNode> start; //индекс или начало среза (может отсутствовать у среза)
+    std::shared_ptr<ASTNode> stop;
+    std::shared_ptr<ASTNode> step;
+    bool isSlice = false;
+
+    Value eval(Environment &env) const override {
+        const Value target = object->eval(env);
+        const auto &data = target.data;
+
+        qsizetype length;
+        if (std::holds_alternative<Value::StringPtr>(data)) length = std::get<Value::StringPtr>(data)->length();
+        else if (std::holds_alternative<Value::BytesPtr>(data)) length = std::get<Value::BytesPtr>(data)->length();
+        else if (std::holds_alternative<Value::ListPtr>(data)) length = static_cast<qsizetype>(std::get<Value::ListPtr>(data)->size());
+        else if (std::holds_alternative<Value::MemoryViewPtr>(data)) length = std::get<Value::MemoryViewPtr>(data)->buffer.length;
+        else throw std::runtime_error("Object is not subscriptable");
+
+        if (!isSlice) {
+            const qsizetype i = normalizeIndex(evalInt(start, env).value(), length);
+            if (std::holds_alternative<Value::StringPtr>(data)) {
+                return Value(CompactString::fromCodePoints(std::u32string(1, std::get<Value::StringPtr>(data)->at(i))));
+            }
+            if (std::holds_alternative<Value::BytesPtr>(data)) {
+                return Value(static_cast<int>(static_cast<uchar>(std::get<Value::BytesPtr>(data)->data[i])));
+            }
+            if (std::holds_alternative<Value::ListPtr>(data)) {
+                return (*std::get<Value::ListPtr>(data))[i];
+            }
+            return Value(static_cast<int>(std::get<Value::MemoryViewPtr>(data)->buffer.item(i)));
+        }
+
+        qsizetype first, stepValue, count;
+        resolveSlice(length, evalInt(start, env), evalInt(stop, env), evalInt(step, env), first, stepValue, count);
+
+        if (std::holds_alternative<Value::StringPtr>(data)) {
+            const Value::StringPtr &str = std::get<Value::StringPtr>(data);
+            if (stepValue == 1) return Value(Rope::slice(str, first, count));
+            std::u32string points;
+            points.reserve(count);
+            for (qsizetype k = 0; k < count; ++k) points.push_back(str->at(first + k * stepValue));
+            return Value(CompactString::fromCodePoints(points));
+        }
+        if (std::holds_alternative<Value::BytesPtr>(data)) {
+            const Bytes &bytes = *std::get<Value::BytesPtr>(data);
+            if (stepValue == 1) return Value(std::make_shared<Bytes>(bytes.data.substr(first, count), bytes.isMutable));
+            std::string result(static_cast<size_t>(count), '\0');
+            for (qsizetype k = 0; k < count; ++k) result[k] = bytes.data[first + k * stepValue];
+            return Value(std::make_shared<Bytes>(std::move(result), bytes.isMutable));
+        }
+        if (std::holds_alternative<Value::ListPtr>(data)) {
+            const Value::List &list = *std::get<Value::ListPtr>(data);
+            Value::List items;
+            items.reserve(count);
+            for (qsizetype k = 0; k < count; ++k) items.push_back(list[first + k * stepValue]);
+            return Value(std::move(items));
+        }
+        const Buffer &buffer = std::get<Value::MemoryViewPtr>(data)->buffer;
+        return Value(std::make_shared<MemoryView>(buffer.slice(first, stepValue, count)));
+    }
+
+    [[nodiscard]] QString toString() const override {
+        if (!isSlice) return object->toString() + "[" + start->toString() + "]";
+        QString result = object->toString() + "[" + (start ? start->toString() : "") + ":" + (stop ? stop->toString() : "");
+        if (step) result += ":" + step->toString();
+        return result + "]";
+    }
+
+private:
+    /**
+     * @brief Вычисляет необязательную целочисленную часть индекса или среза
+     * @return Значение выражения или std::nullopt, если выражение отсутствует
+     * @throws std::runtime_error Если выражение имеет не целочисленный тип
+     */
+    static std::optional<qsizetype> evalInt(const std::shared_ptr<ASTNode> &node, Environment &env) {
+        if (!node) return std::nullopt;
+        const Value v = node->eval(env);
+        if (!std::holds_alternative<int>(v.data)) throw std::runtime_error("Indices must be integers");
+        return std::get<int>(v.data);
+    }
+
+    /**
+     * @brief Приводит индекс элемента к диапазону [0, length), учитывая отрицательные индексы
+     * @throws std::runtime_error Если индекс выходит за границы последовательности
+     */
+    static qsizetype normalizeIndex(qsizetype index, const qsizetype length) {
+        if (index < 0) index += length;
+        if (index < 0 || index >= length) throw std::runtime_error("Index out of range");
+        return index;
+    }
+
+    /**
+     * @brief Вычисляет начало, шаг и количество элементов среза по правилам Python
+     * @throws std::runtime_error Если шаг среза равен нулю
+     */
+    static void resolveSlice(const qsizetype length, const std::optional<qsizetype> startIndex,
+                             const std::optional<qsizetype> stopIndex, const std::optional<qsizetype> stepIndex,
+                             qsizetype &first, qsizetype &stepValue, qsizetype &count) {
+        stepValue = stepIndex.value_or(1);
+        if (stepValue == 0) throw std::runtime_error("Slice step cannot be zero");
+
+        auto clamp = [&](const std::optional<qsizetype> bound, const qsizetype defaultValue) {
+            if (!bound) return defaultValue;
+            qsizetype v = *bound;
+            if (v < 0) {
+                v += length;
+                if (v < 0) v = stepValue < 0 ? -1 : 0;
+            } else if (v >= length) {
+                v = stepValue < 0 ? length - 1 : length;
+            }
+            return v;
+        };
+        first = clamp(startIndex, stepValue < 0 ? length - 1 : 0);
+        const qsizetype last = clamp(stopIndex, stepValue < 0 ? -1 : length);
+
+        if (stepValue > 0) count = first < last ? (last - first - 1) / stepValue + 1 : 0;
+        else count = last < first ? (first - last - 1) / -stepValue + 1 : 0;
+    }
 };
 
 class AssignNode final : public ASTNode {
@@ -377,6 +706,136 @@ public:
     }
 };
 
+/**
+ * @class AugAssignNode
+ * @brief Представляет составное присваивание (`+=`, `-=`) в абстрактном синтаксическом дереве.
+ *
+ * Узел вычисляет правую часть, применяет к текущему значению переменной соответствующую
+ * бинарную операцию и сохраняет результат обратно в окружение.
+ *
+ * @details
+ * Для строк оператор `+=` выполняется на месте: если строка, хранящаяся в переменной, больше
+ * нигде не используется, правая часть дописывается в её буфер без создания новой строки.
+ * Это делает построение больших строк в цикле линейным по времени. `bytearray` изменяем, поэтому
+ * `+=` всегда дописывает в его буфер на месте (как в Python, изменение видно через все ссылки);
+ * `bytes` дописывается на месте только при отсутствии других ссылок. В остальных случаях
+ * используется обычная семантика `x = x op expr`. Если числовой тип результата доказан
+ * `TypeInference`, операция вычисляется без упаковки промежуточных значений.
+ */
+class AugAssignNode final : public ASTNode {
+public:
+    AugAssignNode(QString varName, const QString &op, std::shared_ptr<ASTNode> valueExpr) :
+    varName(std::move(varName)), op(op.left(1)), valueExpr(std::move(valueExpr)),
+    binOp(std::make_shared<VarNode>(this->varName), this->op, this->valueExpr) {}
+
+    QString varName;
+    QString op; // "+" или "-"
+    std::shared_ptr<ASTNode> valueExpr;
+
+    Value eval(Environment &env) const override {
+        if (binOp.staticType != StaticType::Unknown) {
+            Value result = binOp.eval(env);
+            env.set(varName, result);
+            return result;
+        }
+
+        const Value rhs = valueExpr->eval(env);
+        Value &target = env.getLocal(varName);
+
+        if (op == "+" &&
+            std::holds_alternative<Value::StringPtr>(target.data) &&
+            std::holds_alternative<Value::StringPtr>(rhs.data)) {
+            Value::StringPtr &str = std::get<Value::StringPtr>(target.data);
+            if (str.use_count() == 1) {
+                str->append(*std::get<Value::StringPtr>(rhs.data));
+                return target;
+            }
+        }
+
+        if (op == "+" &&
+            std::holds_alternative<Value::BytesPtr>(target.data) &&
+            !std::holds_alternative<Value::StringPtr>(rhs.data)) {
+            Value::BytesPtr &bytes = std::get<Value::BytesPtr>(target.data);
+            if (bytes->isMutable || bytes.use_count() == 1) {
+                if (std::holds_alternative<Value::BytesPtr>(rhs.data)) {
+                    const Bytes &piece = *std::get<Value::BytesPtr>(rhs.data);
+                    bytes->append(piece.data.data(), piece.length());
+                    return target;
+                }
+                const Buffer buffer = Buffer::of(rhs);
+                if (buffer.itemSize == 1 && buffer.isContiguous()) {
+                    bytes->append(reinterpret_cast<const char *>(buffer.data), buffer.length);
+                    return target;
+                }
+            }
+        }
+
+        Value result = binOp.apply(target, rhs);
+        env.set(varName, result);
+        return result;
+    }
+
+    [[nodiscard]] QString toString() const override {
+        return varName + " " + op + "= " + valueExpr->toString();
+    }
+
+private:
+    friend class JitCompiler;
+    friend class TypeInference;
+    friend class AstTraversal;
+
+    BinOpNode binOp;
+};
+
+/**
+ * @class TempNode
+ * @brief Временное значение, созданное оптимизатором для повторного использования результата выражения.
+ *
+ * Узел оборачивает чистое числовое выражение (см. `CommonSubexpressionPass`, `LoopInvariantPass`)
+ * и работает в одном из режимов:
+ * - Store — вычисляет выражение и сохраняет результат (первое вхождение общего подвыражения);
+ * - Load — возвращает результат, сохранённый узлом Store (последующие вхождения);
+ * - Cached — вычисляет выражение при первом обращении и далее возвращает сохранённое значение,
+ *   пока цикл не сбросит его при очередном входе (инвариант цикла).
+ *
+ * Исходное выражение хранится во всех режимах: оно используется в toString() и JIT-компилятором,
+ * который вычисляет его заново в машинном коде.
+ */
+class TempNode final : public ASTNode {
+public:
+    struct Slot {
+        Value value;
+        bool valid = false;
+    };
+
+    enum class Mode { Store, Load, Cached };
+
+    TempNode(const Mode mode, std::shared_ptr<ASTNode> expr, std::shared_ptr<Slot> slot) :
+    mode(mode), expr(std::move(expr)), slot(std::move(slot)) {
+        staticType = this->expr->staticType;
+    }
+
+    Mode mode;
+    std::shared_ptr<ASTNode> expr;
+    std::shared_ptr<Slot> slot;
+
+    Value eval(Environment &env) const override { return fetch(env); }
+
+    int evalInt(Environment &env) const override { return unboxed<int>(fetch(env)); }
+    double evalDouble(Environment &env) const override { return unboxed<double>(fetch(env)); }
+    bool evalBool(Environment &env) const override { return unboxed<bool>(fetch(env)); }
+
+    [[nodiscard]] QString toString() const override { return expr->toString(); }
+
+private:
+    const Value &fetch(Environment &env) const {
+        if (mode == Mode::Load || (mode == Mode::Cached && slot->valid)) return slot->value;
+        slot->value = expr->eval(env);
+        slot->valid = true;
+        return slot->value;
+    }
+};
+
 class IfNode final : public ASTNode {
 public:
     IfNode(std::shared_ptr<ASTNode> condition,
@@ -386,65 +845,344 @@ public:
     : condition(std::move(std::move(condition))), body(std::move(body)), elifs(std::move(elifs)), elseBody(std::move(elseBody)) {}
 
     Value eval(Environment &env) const override {
-        if (condition->eval(env).toBool()) {
-            Value lastValue;
-            for (const auto& stmt : body) {
-                lastValue = stmt->eval(env);
-            }
+        Value lastValue;
+        if (condition->evalCondition(env)) {
+            evalBlock(body, env, lastValue);
             return lastValue;
         }
 
         for (const auto& elif: elifs) {
-            if (elif.first->eval(env).toBool()) {
-                Value lastValue;
-                for (const auto& stmt : elif.second) {
-                    lastValue = stmt->eval(env);
-                }
+            if (elif.first->evalCondition(env)) {
+                evalBlock(elif.second, env, lastValue);
                 return lastValue;
             }
         }
 
-        if (!elseBody.empty()) {
-            Value lastValue;
-            for (const auto& stmt : elseBody) {
-                lastValue = stmt->eval(env);
-            }
-            return lastValue;
-        }
-
-        return Value();
+        evalBlock(elseBody, env, lastValue);
+        return lastValue;
     }
 
     [[nodiscard]] QString toString() const override {
-        QString result = "if " + condition->toString() + ":\n";
-        for (const auto& stmt : body) {
-            result += "    " + stmt->toString() + "\n";
-        }
+        QString result;
+        write(result, 0);
+        return result;
+    }
+
+    void write(QString &out, const int indent) const override {
+        const QString padding(indent, QChar(' '));
+        out += padding + "if " + condition->toString() + ":";
+        writeBlock(out, body, indent + 4);
 
         for (const auto& elif : elifs) {
-            result += "elif " + elif.first->toString() + ":\n";
-            for (const auto& stmt : elif.second) {
-                result += "    " + stmt->toString() + "\n";
-            }
+            out += "\n" + padding + "elif " + elif.first->toString() + ":";
+            writeBlock(out, elif.second, indent + 4);
         }
 
         if (!elseBody.empty()) {
-            result += "else:\n";
-            for (const auto& stmt : elseBody) {
-                result += "    " + stmt->toString() + "\n";
-            }
+            out += "\n" + padding + "else:";
+            writeBlock(out, elseBody, indent + 4);
         }
-
-        return result;
     }
 
 private:
+    friend class JitCompiler;
+    friend class TypeInference;
+    friend class AstTraversal;
+    friend class UnreachableBranchPass;
+    friend class ModuleCache;
+    friend class Coroutine;
+
     std::shared_ptr<ASTNode> condition;
     std::vector<std::shared_ptr<ASTNode>> body;
     std::vector<std::pair<std::shared_ptr<ASTNode>, std::vector<std::shared_ptr<ASTNode>>>> elifs;
     std::vector<std::shared_ptr<ASTNode>> elseBody;
 };
 
+/**
+ * @class WhileNode
+ * @brief Представляет цикл `while` в абстрактном синтаксическом дереве.
+ *
+ * Тело цикла выполняется, пока условие истинно. Если включён JIT-компилятор (см. `Jit`),
+ * узел считает итерации, выполненные интерпретатором, и после JitOptions::hotLoopThreshold итераций
+ * компилирует цикл в машинный код. Дальнейшие итерации выполняются скомпилированным кодом;
+ * итерация, на которой код вышел в интерпретатор, выполняется интерпретатором, после чего
+ * управление снова передаётся машинному коду. Каждая итерация в интерпретаторе — шаг задачи
+ * (см. `GreenScheduler::step`). Цикл общего дерева (`shared`) хранит это состояние не в узле,
+ * а в таблице экземпляра интерпретатора (`LoopStates`).
+ */
+class WhileNode final : public ASTNode {
+public:
+    WhileNode(std::shared_ptr<ASTNode> condition, std::vector<std::shared_ptr<ASTNode>> body)
+    : condition(std::move(condition)), body(std::move(body)) {}
+
+    std::shared_ptr<ASTNode> condition;
+    std::vector<std::shared_ptr<ASTNode>> body;
+    std::vector<std::shared_ptr<TempNode::Slot>> invariants; //значения инвариантов цикла (см. LoopInvariantPass)
+    bool shared = false; //узел общего дерева (см. AstTraversal::share)
+
+    Value eval(Environment &env) const override {
+        for (const auto &invariant : invariants) invariant->valid = false;
+
+        LoopState scratch{0, true, nullptr};
+        LoopState &jit = state(scratch);
+        Value lastValue;
+        while (true) {
+            if (jit.compiled) {
+                switch (Jit::run(*jit.compiled, env)) {
+                    case Jit::RunResult::Finished:
+                        return lastValue;
+                    case Jit::RunResult::Bailout:
+                    case Jit::RunResult::NotEntered:
+                        if (jit.compiled->bailouts >= Jit::options().maxBailouts) {
+                            jit.compiled.reset();
+                            jit.rejected = true;
+                        }
+                        break;
+                    case Jit::RunResult::Evicted:
+                        jit.compiled.reset();
+                        jit.hotness = 0;
+                        break;
+                }
+            }
+
+            if (!condition->evalCondition(env)) break;
+            evalBlock(body, env, lastValue);
+            if (env.returning) return lastValue;
+
+            if (Jit::options().enabled && !jit.compiled && !jit.rejected && ++jit.hotness >= Jit::options().hotLoopThreshold) {
+                //в машинном коде нет точек переключения, поэтому задачи GreenScheduler выполняют цикл в интерпретаторе
+                jit.compiled = GreenScheduler::inTask() ? nullptr : Jit::compile(*this, env);
+                jit.rejected = !jit.compiled;
+            }
+            GreenScheduler::step();
+        }
+        return lastValue;
+    }
+
+    [[nodiscard]] QString toString() const override {
+        QString result;
+        write(result, 0);
+        return result;
+    }
+
+    void write(QString &out, const int indent) const override {
+        out += QString(indent, QChar(' ')) + "while " + condition->toString() + ":";
+        writeBlock(out, body, indent + 4);
+    }
+
+private:
+    /**
+     * Состояние JIT для этого выполнения цикла; scratch используется узлом общего дерева,
+     * когда таблица экземпляра не установлена.
+     */
+    LoopState &state(LoopState &scratch) const {
+        if (!shared) return own;
+        LoopState *found = LoopStates::find(*this);
+        return found ? *found : scratch;
+    }
+
+    mutable LoopState own;
+};
+
+/**
+ * @class BlockNode
+ * @brief Последовательность инструкций, выполняемых подряд.
+ *
+ * Представляет модуль (см. `Parser::parseModule`) и создаётся оптимизатором, когда инструкция
+ * верхнего уровня заменяется несколькими (например, `if` с постоянным условием — телом выбранной
+ * ветви). Возвращает значение последней инструкции.
+ */
+class BlockNode final : public ASTNode {
+public:
+    explicit BlockNode(std::vector<std::shared_ptr<ASTNode>> statements) : statements(std::move(statements)) {}
+
+    std::vector<std::shared_ptr<ASTNode>> statements;
+
+    Value eval(Environment &env) const override {
+        Value lastValue;
+        evalBlock(statements, env, lastValue);
+        return lastValue;
+    }
+
+    [[nodiscard]] QString toString() const override {
+        QString result;
+        write(result, 0);
+        return result;
+    }
+
+    void write(QString &out, const int indent) const override {
+        for (size_t i = 0; i < statements.size(); ++i) {
+            if (i > 0) out += '\n';
+            statements[i]->write(out, indent);
+        }
+    }
+};
+
+/**
+ * @class FunctionNode
+ * @brief Инструкция `def name(params):` — определяет функцию с именем name.
+ *
+ * Тело функции разбирается лениво. При разборе модуля предварительный разбор только проверяет
+ * парность скобок и отступов тела и запоминает его токены; полный разбор выполняется при первом
+ * вызове, и его результат используется при последующих вызовах. Поэтому время запуска зависит
+ * от объёма вызываемого кода, а не от размера модуля, а синтаксическая ошибка внутри тела
+ * обнаруживается при первом вызове функции. Тела функций общего дерева (`shared`, см. `AstTraversal::share`)
+ * разобраны заранее и используются потоками только для чтения.
+ *
+ * @details
+ * Функция выполняется в собственном окружении, родителем которого является окружение модуля:
+ * параметры и присвоенные в теле переменные локальны, остальные имена читаются из модуля.
+ * Замыканий нет. Тела функций не проходят через оптимизатор (`PassManager`), так как типы
+ * параметров меняются от вызова к вызову.
+ *
+ * Вызов функции `async def` не выполняет тело, а возвращает сопрограмму (см. `Coroutine`).
+ */
+class FunctionNode final : public ASTNode, public std::enable_shared_from_this<FunctionNode> {
+public:
+    static constexpr int maxRecursionDepth = 1000;
+    static inline thread_local int depth = 0; //глубина вложенных вызовов (у каждой задачи GreenScheduler своя)
+    static inline thread_local const char *stackLimit = nullptr; //вызов ниже этого адреса стека — ошибка рекурсии (задаёт GreenScheduler)
+
+    /**
+     * @param tokens Токены тела: NEWLINE, INDENT, инструкции тела и завершающий DEDENT
+     */
+    FunctionNode(QString name, std::vector<QString> params, QVector<Token> tokens, const bool isAsync = false) :
+    name(std::move(name)), params(std::move(params)), isAsync(isAsync), tokens(std::move(tokens)) {}
+
+    QString name;
+    std::vector<QString> params;
+    bool isAsync; //async def
+    bool shared = false; //узел общего дерева: копии дерева (AstTraversal::clone) разделяют его
+
+    Value eval(Environment &env) const override {
+        env.set(name, Value(Value::Function(std::const_pointer_cast<FunctionNode>(shared_from_this()))));
+        return Value();
+    }
+
+    /**
+     * @brief Вызывает функцию с аргументами args; caller — окружение вызывающего кода
+     * @return Значение инструкции `return` или 0, если функция завершилась без неё;
+     *         для `async def` — новая сопрограмма
+     * @throws std::runtime_error При неверном числе аргументов, синтаксической ошибке в теле,
+     *                            превышении глубины рекурсии или ошибке выполнения тела
+     */
+    Value call(const std::vector<Value> &args, Environment &caller) const;
+
+    /**
+     * @brief Разбирает тело функции, если оно ещё не разобрано (как при первом вызове)
+     * @throws std::runtime_error При синтаксической ошибке в теле
+     */
+    void parse() const;
+
+    /**
+     * @brief Токены тела функции (для записи в кэш модуля)
+     */
+    [[nodiscard]] const QVector<Token> &bodyTokens() const { return tokens; }
+
+    /**
+     * @brief Инструкции тела функции (разбирает его, если оно ещё не разобрано)
+     * @throws std::runtime_error При синтаксической ошибке в теле
+     */
+    [[nodiscard]] const std::vector<std::shared_ptr<ASTNode>> &statements() const {
+        parse();
+        return body;
+    }
+
+    /**
+     * @brief Проверяет, содержит ли инструкция тела async-функции `await` (см. `AstTraversal::awaitingStatements`)
+     */
+    [[nodiscard]] bool suspends(const ASTNode *statement) const { return awaiting.count(statement) != 0; }
+
+    [[nodiscard]] QString toString() const override {
+        QString result = QString(isAsync ? "async " : "") + "def " + name + "(";
+        for (size_t i = 0; i < params.size(); ++i) {
+            if (i > 0) result += ", ";
+            result += params[i];
+        }
+        return result + "): ...";
+    }
+
+private:
+    friend class Coroutine;
+
+    QVector<Token> tokens;
+    mutable std::vector<std::shared_ptr<ASTNode>> body; //разбирается при первом вызове
+    mutable std::unordered_set<const ASTNode *> awaiting; //инструкции тела, содержащие await
+    mutable bool parsed = false;
+};
+
+/**
+ * @class ReturnNode
+ * @brief Инструкция `return [value]`.
+ *
+ * Сохраняет значение в окружении функции и устанавливает `Environment::returning`, после чего
+ * блоки (`if`, `while`, тело функции) прекращают выполнение своих инструкций.
+ * `return` без значения возвращает 0, так как значения None нет.
+ */
+class ReturnNode final : public ASTNode {
+public:
+    explicit ReturnNode(std::shared_ptr<ASTNode> value) : value(std::move(value)) {}
+
+    std::shared_ptr<ASTNode> value; //может быть nullptr
+
+    Value eval(Environment &env) const override {
+        env.returnValue = value ? value->eval(env) : Value();
+        env.returning = true;
+        return env.returnValue;
+    }
+
+    [[nodiscard]] QString toString() const override {
+        return value ? "return " + value->toString() : "return";
+    }
+};
+
+/**
+ * @class AwaitNode
+ * @brief Выражение `await value` в теле `async def`.
+ *
+ * Узел не вычисляется через `eval`: инструкцию с `await` выполняет кадр сопрограммы (см. `Coroutine`),
+ * который вычисляет операнд, приостанавливается до готовности результата и подставляет его.
+ * Поэтому `await` допустим только как отдельная инструкция, правая часть присваивания
+ * или значение `return`.
+ */
+class AwaitNode final : public ASTNode {
+public:
+    explicit AwaitNode(std::shared_ptr<ASTNode> operand) : operand(std::move(operand)) {}
+
+    std::shared_ptr<ASTNode> operand;
+
+    Value eval(Environment &) const override {
+        throw std::runtime_error("'await' outside coroutine");
+    }
+
+    [[nodiscard]] QString toString() const override {
+        return "await " + operand->toString();
+    }
+};
+
+/**
+ * @class ImportNode
+ * @brief Инструкция `import name`: выполняет модуль `name.py` (см. `ModuleCache::import`).
+ *
+ * Объектов модулей пока нет, поэтому модуль выполняется в окружении импортирующего кода
+ * и его имена становятся глобальными, как при `from name import *`.
+ */
+class ImportNode final : public ASTNode {
+public:
+    explicit ImportNode(QString module) : module(std::move(module)) {}
+
+    QString module;
+
+    Value eval(Environment &env) const override {
+        ModuleCache::import(module, env);
+        return Value();
+    }
+
+    [[nodiscard]] QString toString() const override {
+        return "import " + module;
+    }
+};
+
 /**
  * @class Parser
  * @brief Выполняет разбор последовательности токенов в абстрактное синтаксическое дерево (AST).
@@ -467,16 +1205,35 @@ public:
      */
     explicit Parser(const QVector<Token> &tokens);
 
+    /**
+     * @brief Создает парсер, повторно использующий инструкции из cache (см. `IncrementalParser`)
+     */
+    Parser(const QVector<Token> &tokens, StatementCache *cache);
+
     /**
      * @brief Основной метод разбора, начинает анализ с выражений наивысшего приоритета
      * @return Корневой узел синтаксического дерева
      */
     std::shared_ptr<ASTNode> parse();
 
+    /**
+     * @brief Разбирает всю последовательность токенов как модуль — список инструкций верхнего уровня
+     * @return Узел BlockNode с инструкциями модуля
+     * @throws std::runtime_error При синтаксической ошибке в любой из инструкций
+     */
+    std::shared_ptr<ASTNode> parseModule();
+
+    /**
+     * @brief Разбирает тело функции — блок, сохранённый предварительным разбором `def`
+     * @return Инструкции тела
+     * @throws std::runtime_error При синтаксической ошибке в теле
+     */
+    std::vector<std::shared_ptr<ASTNode>> parseFunctionBody(bool isAsync = false);
+
 private:
     //Здесь методы разделены для анализа выражения согласно приоритету
     /**
-     * @brief Разбирает операции присваивания (=)
+     * @brief Разбирает операции присваивания (=, +=, -=)
      * @return Узел присваивания или выражение более высокого приоритета
      */
     std::shared_ptr<ASTNode> parseAssignment();
@@ -511,6 +1268,18 @@ private:
      */
     std::shared_ptr<ASTNode> parsePower();
 
+    /**
+     * @brief Разбирает постфиксные конструкции: вызовы методов (obj.name(args)), индексы и срезы (obj[i:j:k])
+     * @return Узел вызова метода, индексирования или первичное выражение
+     */
+    std::shared_ptr<ASTNode> parsePostfix();
+
+    /**
+     * @brief Разбирает список аргументов вызова в круглых скобках
+     * @return Узлы выражений-аргументов
+     */
+    std::vector<std::shared_ptr<ASTNode>> parseArguments();
+
     /**
      * @brief Разбирает первичные выражения (числа, строки, переменные, выражения в скобках)
      * @return Узел первичного выражения
@@ -529,6 +1298,12 @@ private:
      */
     std::shared_ptr<ASTNode> parseStringToken();
 
+    /**
+     * @brief Разбирает байтовый токен
+     * @return Узел значения типа bytes
+     */
+    std::shared_ptr<ASTNode> parseBytesToken();
+
     /**
      * @brief Разбирает логический токен
      * @return Узел логического значения
@@ -541,6 +1316,18 @@ private:
      */
     std::shared_ptr<ASTNode> parseIdentifierToken();
 
+    /**
+     * @brief Разбирает индекс или срез в квадратных скобках после выражения object
+     * @return Узел индексирования или среза
+     */
+    std::shared_ptr<ASTNode> parseSubscript(std::shared_ptr<ASTNode> object);
+
+    /**
+     * @brief Разбирает литерал списка
+     * @return Узел списка
+     */
+    std::shared_ptr<ASTNode> parseListLiteral();
+
     /**
      * @brief Разбирает выражение в скобках
      * @return Узел выражения внутри скобок
@@ -567,9 +1354,28 @@ private:
 
 private:
     std::shared_ptr<ASTNode> parseIfStatement();
+    std::shared_ptr<ASTNode> parseWhileStatement();
+    std::shared_ptr<ASTNode> parseImportStatement();
+    std::shared_ptr<ASTNode> parseFunctionDefinition(bool isAsync = false);
+    std::shared_ptr<ASTNode> parseReturnStatement();
+    std::shared_ptr<ASTNode> parseAwaitExpression();
     std::vector<std::shared_ptr<ASTNode>> parseBlock();
 
+    /**
+     * @brief Разбирает инструкцию блока или модуля, используя кэш инструкций, если он задан
+     */
+    std::shared_ptr<ASTNode> parseStatement();
+
+    /**
+     * @brief Предварительный разбор тела функции: проверяет парность скобок и отступов, не строя AST
+     * @return Индекс токена, следующего за телом (после завершающего DEDENT)
+     */
+    [[nodiscard]] int skipFunctionBody() const;
+
     QVector<Token> tokens;
     int current = 0;
+    bool inFunction = false; //разбирается тело функции: `return` допустим
+    bool inAsyncFunction = false; //разбирается тело async-функции: `await` допустим
+    StatementCache *cache = nullptr;
 };
 #endif // PARSER_H
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef PASSMANAGER_H
+#define PASSMANAGER_H
+
+#include "Parser.h"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+/**
+ * @class Pass
+ * @brief Проход оптимизации или анализа над разобранным AST.
+ *
+ * Проход получает корень дерева по ссылке и может заменить его. Окружение передаётся
+ * только для чтения типов и значений переменных на момент выполнения дерева.
+ */
+class Pass {
+public:
+    virtual ~Pass() = default;
+
+    [[nodiscard]] virtual const char *name() const = 0;
+
+    virtual void run(std::shared_ptr<ASTNode> &root, Environment &env) = 0;
+};
+
+/**
+ * @class PassManager
+ * @brief Выполняет последовательность проходов между `Parser::parse()` и `eval`.
+ *
+ * Набор проходов определяется уровнем оптимизации (флаги `-O0`, `-O1`, `-O2`):
+ * - `-O0` — дерево выполняется без изменений;
+ * - `-O1` (по умолчанию) — удаление недостижимых ветвей `if`, удаление мёртвых присваиваний
+ *   и вывод типов;
+ * - `-O2` — дополнительно устранение общих подвыражений и вынос инвариантов циклов.
+ *
+ * Время каждого прохода накапливается; флаг `--time-passes` выводит его при завершении работы.
+ */
+class PassManager {
+public:
+    /**
+     * @brief Создаёт набор проходов для уровня оптимизации level
+     */
+    static PassManager forLevel(int level);
+
+    void add(std::unique_ptr<Pass> pass);
+
+    /**
+     * @brief Выполняет все проходы над деревом root
+     */
+    void run(std::shared_ptr<ASTNode> &root, Environment &env);
+
+    /**
+     * @brief Возвращает суммарное время каждого прохода в текстовом виде
+     */
+    [[nodiscard]] QString timingReport() const;
+
+    /**
+     * @brief Разбирает флаги `-O0`, `-O1`, `-O2` и `--time-passes`
+     * @return true, если флаг относится к оптимизатору
+     */
+    static bool parseFlag(const QString &flag);
+
+    static inline int optimizationLevel = 1;
+    static inline bool timePasses = false;
+
+private:
+    struct Entry {
+        std::unique_ptr<Pass> pass;
+        std::chrono::nanoseconds total{0};
+        int runs = 0;
+    };
+
+    std::vector<Entry> passes;
+};
+
+#endif // PASSMANAGER_H
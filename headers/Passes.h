@@ -0,0 +1,100 @@
+#ifndef PASSES_H
+#define PASSES_H
+
+#include "AstTraversal.h"
+#include "PassManager.h"
+#include <optional>
+#include <unordered_set>
+
+/**
+ * @class TypeInferencePass
+ * @brief Размечает дерево типами (см. `TypeInference`); при report выводит отчёт `--report-types`.
+ */
+class TypeInferencePass final : public Pass {
+public:
+    explicit TypeInferencePass(const bool report) : report(report) {}
+
+    [[nodiscard]] const char *name() const override { return "type-inference"; }
+    void run(std::shared_ptr<ASTNode> &root, Environment &env) override;
+
+private:
+    bool report;
+};
+
+/**
+ * @class UnreachableBranchPass
+ * @brief Удаляет ветви `if`/`elif` с постоянным условием.
+ *
+ * Условие считается постоянным, если состоит только из литералов и бинарных операций и
+ * вычисляется без ошибки. Ложные ветви удаляются, истинная становится веткой `else`; если
+ * остаётся одна ветвь, `if` заменяется её телом.
+ */
+class UnreachableBranchPass final : public Pass {
+public:
+    [[nodiscard]] const char *name() const override { return "unreachable-branches"; }
+    void run(std::shared_ptr<ASTNode> &root, Environment &env) override;
+
+private:
+    void simplifyBlock(AstTraversal::Block &block);
+    static std::optional<bool> constantCondition(const ASTNode *condition);
+};
+
+/**
+ * @class DeadStorePass
+ * @brief Удаляет присваивания, значение которых перезаписывается до первого чтения.
+ *
+ * Мёртвое присваивание `x = expr` удаляется целиком, если expr — константа; иначе остаётся
+ * вычисление expr (оно может завершиться ошибкой), а запись в переменную удаляется. Константные
+ * выражения-инструкции внутри блоков также удаляются.
+ */
+class DeadStorePass final : public Pass {
+public:
+    [[nodiscard]] const char *name() const override { return "dead-stores"; }
+    void run(std::shared_ptr<ASTNode> &root, Environment &env) override;
+
+private:
+    void eliminate(AstTraversal::Block &block);
+    [[nodiscard]] bool cannotFail(const ASTNode *node, const std::unordered_set<QString> &assigned) const;
+    [[nodiscard]] bool isOverwritten(const AstTraversal::Block &block, size_t index, const QString &name) const;
+
+    Environment *env = nullptr;
+};
+
+/**
+ * @class CommonSubexpressionPass
+ * @brief Устраняет повторные вычисления одинаковых чистых выражений в линейном участке блока.
+ *
+ * Рассматриваются бинарные операции над литералами и переменными с доказанным числовым типом:
+ * их результат — неизменяемое значение, поэтому его можно использовать повторно. Первое вхождение
+ * оборачивается в TempNode (Store), последующие заменяются на TempNode (Load). Присваивание
+ * переменной делает недействительными выражения, которые её читают; вложенные блоки и вызовы
+ * пользовательского кода завершают линейный участок.
+ */
+class CommonSubexpressionPass final : public Pass {
+public:
+    [[nodiscard]] const char *name() const override { return "cse"; }
+    void run(std::shared_ptr<ASTNode> &root, Environment &env) override;
+
+private:
+    void eliminate(AstTraversal::Block &block);
+    static QString expressionKey(const ASTNode *node);
+};
+
+/**
+ * @class LoopInvariantPass
+ * @brief Выносит из циклов `while` выражения, не зависящие от переменных, изменяемых в цикле.
+ *
+ * Инвариант заменяется на TempNode (Cached): значение вычисляется при первом обращении после
+ * входа в цикл и далее используется повторно. Вычисление при первом обращении, а не перед циклом,
+ * сохраняет поведение цикла, не выполнившего ни одной итерации, и порядок ошибок.
+ */
+class LoopInvariantPass final : public Pass {
+public:
+    [[nodiscard]] const char *name() const override { return "licm"; }
+    void run(std::shared_ptr<ASTNode> &root, Environment &env) override;
+
+private:
+    void hoist(WhileNode &loop);
+};
+
+#endif // PASSES_H
@@ -0,0 +1,58 @@
+#ifndef PROCESSPOOL_H
+#define PROCESSPOOL_H
+
+#include "Value.h"
+#include <string>
+#include <vector>
+
+class Environment;
+
+/**
+ * @class ProcessPool
+ * @brief Встроенная функция `process_map(func, items[, chunksize])`: применяет функцию пользователя
+ * к элементам списка в дочерних процессах и возвращает список результатов в исходном порядке.
+ *
+ * Рабочие процессы создаются `fork` в момент вызова, поэтому получают уже загруженное окружение
+ * (глобальные переменные, разобранные функции, скомпилированный JIT код) без копирования:
+ * страницы разделяются до первой записи. В отличие от `parallel_map`, функции не нужно изолировать,
+ * и им доступно любое состояние процесса; процессы не мешают друг другу и интерпретатору.
+ *
+ * @details
+ * Список делится на части по chunksize элементов; процессы берут части по очереди из общего счётчика.
+ * Результаты части кодируются компактным двоичным форматом (см. `encode`) и передаются через кольцевой
+ * буфер в общей памяти — у каждого процесса свой, а родитель читает все. Ожидание построено
+ * на семафорах в той же памяти, без каналов. Вывод `print` каждой части передаётся вместе с её
+ * результатами и печатается в порядке частей. Ошибка в части отменяет ещё не начатые части
+ * и передаётся вызывающему коду. Доступно только в Linux.
+ *
+ * Перед созданием процессов тела глобальных функций разбираются (см. `FunctionNode::parse`), поэтому
+ * процессы не повторяют ленивый разбор. `fork` многопоточного процесса небезопасен: дочерний процесс
+ * наследует мьютексы, захваченные другими потоками (очереди `WorkStealingPool`, область `Frozen`,
+ * внутренние структуры Qt), и может зависнуть на них. Поэтому перед `fork` потоки общего пула
+ * `WorkStealingPool` завершаются (`quiesce`; следующий `parallel_map` запускает их снова), а если
+ * в процессе остались другие потоки (например, в режиме `-j` или внутри `parallel_map`), `process_map`
+ * завершается ошибкой.
+ */
+class ProcessPool {
+public:
+    /**
+     * @brief Реализация `process_map` для таблицы встроенных функций
+     * @throws std::runtime_error Если аргументы некорректны, функция завершилась ошибкой, её результат
+     * нельзя передать между процессами, в процессе выполняются другие потоки или рабочий процесс аварийно завершился
+     */
+    static Value call(const std::vector<Value> &args, Environment &env);
+
+    /**
+     * @brief Дописывает в out двоичное представление value: числа, строки, байты, списки и словари
+     * @throws std::runtime_error Для функций, memoryview, сопрограмм, файлов и списков, содержащих себя
+     */
+    static void encode(const Value &value, std::string &out);
+
+    /**
+     * @brief Восстанавливает значение, записанное `encode`, начиная с pos; pos сдвигается за него
+     * @throws std::runtime_error Если данные повреждены
+     */
+    static Value decode(const std::string &in, size_t &pos);
+};
+
+#endif // PROCESSPOOL_H
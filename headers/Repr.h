@@ -0,0 +1,63 @@
+#ifndef REPR_H
+#define REPR_H
+
+#include "Value.h"
+#include <limits>
+#include <string>
+#include <vector>
+
+/**
+ * @class Repr
+ * @brief Записывает текстовое представление значений (`repr` и `str` в Python) в общий буфер UTF-8.
+ *
+ * Вложенные списки и словари записываются рекурсивно в тот же буфер, поэтому время и память
+ * линейны по размеру результата. Контейнер, уже записываемый выше по стеку, выводится как
+ * `[...]` или `{...}`, как в Python. При заданном ограничении maxSize запись прекращается,
+ * как только текст превысит ограничение: он обрезается до maxSize байтов и завершается `...`.
+ *
+ * @code
+ * std::string text;
+ * Repr(text, 80).repr(value);
+ * @endcode
+ */
+class Repr {
+public:
+    static constexpr size_t unlimited = std::numeric_limits<size_t>::max();
+
+    /**
+     * @param out Буфер, в конец которого дописывается текст
+     * @param maxSize Наибольшее число байтов, дописываемых в out (не считая завершающего `...`)
+     */
+    explicit Repr(std::string &out, size_t maxSize = unlimited);
+
+    /**
+     * @brief Дописывает представление value, которое выводит REPL: строки в кавычках с экранированием (`'a\\n'`)
+     */
+    Repr &repr(const Value &value);
+
+    /**
+     * @brief Дописывает значение value так, как его выводит `print`: строки без кавычек, остальное — как `repr`
+     */
+    Repr &str(const Value &value);
+
+    /**
+     * @brief Возвращает true, если текст был обрезан по ограничению размера
+     */
+    [[nodiscard]] bool truncated() const { return cut; }
+
+private:
+    static void appendUtf8(std::string &out, const CompactString &str); //без кавычек и экранирования
+    void writeString(const CompactString &str);
+    void writeList(const Value::List &list);
+    void writeDict(const Value::Dict &dict);
+    bool enter(const void *container); //false, если контейнер уже записывается выше по стеку
+    bool full(); //обрезает текст и возвращает true, если ограничение размера превышено
+
+    std::string &out;
+    size_t start;
+    size_t maxSize;
+    bool cut = false;
+    std::vector<const void *> active; //записываемые сейчас контейнеры
+};
+
+#endif // REPR_H
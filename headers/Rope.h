@@ -0,0 +1,82 @@
+#ifndef ROPE_H
+#define ROPE_H
+
+#include "CompactString.h"
+#include <memory>
+
+/**
+ * @class Rope
+ * @brief Представляет строковое значение интерпретатора с отложенной конкатенацией.
+ *
+ * Rope хранит строку либо в «плоском» виде (готовая `CompactString`), либо как узел конкатенации
+ * двух других строк. Конкатенация через `concat` выполняется за O(1) и не копирует символы:
+ * создаётся лишь новый узел, ссылающийся на оба операнда. Символы копируются один раз —
+ * при первом обращении к содержимому (`flatten`), например при сравнении, хешировании или печати.
+ *
+ * @details
+ * Третий вид узла — срез: он ссылается на диапазон другой строки и не копирует её символы.
+ * Срезы создаются через `slice` только для достаточно длинных фрагментов; короткие фрагменты
+ * дешевле скопировать сразу. Срез копирует свой диапазон при изменении (`append`), при выравнивании,
+ * а также когда он остаётся единственным владельцем намного более длинной строки-источника.
+ *
+ * Благодаря этому построение строки в цикле вида `s = s + piece` выполняется за линейное время,
+ * а не за квадратичное. Для оператора `+=` предусмотрен метод `append`, дописывающий данные
+ * на месте, если строка больше нигде не используется (уникальность проверяет вызывающая сторона).
+ * Обход дерева при выравнивании и разрушение узлов выполняются итеративно, поэтому длинные
+ * цепочки конкатенаций не приводят к переполнению стека.
+ */
+class Rope {
+public:
+    using Ptr = std::shared_ptr<Rope>;
+
+    explicit Rope(CompactString str);
+    ~Rope();
+
+    Rope(const Rope&) = delete;
+    Rope& operator=(const Rope&) = delete;
+
+    /**
+     * @brief Создаёт строку, являющуюся конкатенацией двух строк, без копирования символов
+     */
+    static Ptr concat(const Ptr& left, const Ptr& right);
+
+    /**
+     * @brief Возвращает подстроку [start, start + count), разделяющую буфер source, если она достаточно длинная
+     */
+    static Ptr slice(const Ptr& source, qsizetype start, qsizetype count);
+
+    /**
+     * @brief Возвращает кодовую точку по индексу, не выравнивая срезы
+     */
+    [[nodiscard]] char32_t at(qsizetype index) const;
+
+    /**
+     * @brief Дописывает строку в конец текущей на месте (только для неразделяемых строк)
+     */
+    void append(const Rope& piece);
+
+    /**
+     * @brief Возвращает содержимое строки, при необходимости выполняя отложенную конкатенацию
+     */
+    const CompactString& flatten() const;
+
+    [[nodiscard]] qsizetype length() const { return len; }
+    [[nodiscard]] bool isEmpty() const { return len == 0; }
+    [[nodiscard]] bool isFlat() const { return !left && !base; }
+
+    //Минимальная длина среза, начиная с которой он разделяет буфер источника вместо копирования
+    static constexpr qsizetype MIN_SHARED_SLICE = 256;
+
+private:
+    Rope(Ptr left, Ptr right);
+    Rope(Ptr base, qsizetype offset, qsizetype count);
+
+    mutable CompactString flat; //содержимое (валидно, если узел плоский)
+    mutable Ptr left; //левый операнд отложенной конкатенации
+    mutable Ptr right; //правый операнд отложенной конкатенации
+    mutable Ptr base; //строка-источник среза (плоская)
+    qsizetype offset = 0; //начало среза в строке-источнике
+    qsizetype len = 0; //длина строки, известна без выравнивания
+};
+
+#endif // ROPE_H
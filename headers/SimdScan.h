@@ -0,0 +1,32 @@
+#ifndef SIMDSCAN_H
+#define SIMDSCAN_H
+
+#include <QtGlobal>
+
+/**
+ * @class SimdScan
+ * @brief Содержит SIMD-ядра побайтового сканирования, общие для строк Latin-1 и байтовых последовательностей.
+ *
+ * На платформах с SSE2 ядра обрабатывают по 16 байтов за шаг; на остальных используются
+ * скалярные циклы с тем же результатом.
+ */
+class SimdScan {
+public:
+    /**
+     * @brief Ищет последовательность needle длины needleSize в haystack, начиная с позиции from
+     * @return Индекс первого вхождения или -1
+     */
+    static qsizetype find(const char *haystack, qsizetype size, const char *needle, qsizetype needleSize, qsizetype from);
+
+    /**
+     * @brief Подсчитывает количество байтов c в data
+     */
+    static qsizetype count(const char *data, qsizetype size, char c);
+
+    /**
+     * @brief Меняет регистр ASCII-букв в data на месте
+     */
+    static void asciiCaseMap(char *data, qsizetype size, bool toUpper);
+};
+
+#endif // SIMDSCAN_H
@@ -0,0 +1,38 @@
+#ifndef STRINGMETHODS_H
+#define STRINGMETHODS_H
+
+#include "Value.h"
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class StringMethods
+ * @brief Реализует встроенные методы строк (`find`, `count`, `replace`, `split`, `join`, `strip`,
+ * `startswith`, `lower`, `upper`, `encode` и их варианты).
+ *
+ * Методы работают непосредственно с компактным представлением строки (`CompactString`).
+ * Для строк шириной 1 байт поиск, подсчёт и смена регистра ASCII выполняются SIMD-сканированием
+ * по 16 байтов за шаг (SSE2, см. `SimdScan`); для более широких строк и платформ без SSE2 используются
+ * скалярные реализации с тем же поведением.
+ */
+class StringMethods {
+public:
+    using Method = Value (*)(const CompactString &self, const std::vector<Value> &args);
+
+    /**
+     * @brief Вызывает метод name для строки self с аргументами args
+     * @throws std::runtime_error Если метод не существует или аргументы некорректны
+     */
+    static Value call(const CompactString &self, const QString &name, const std::vector<Value> &args);
+
+    /**
+     * @brief Ищет подстроку needle в строке haystack, начиная с позиции from
+     * @return Индекс первого вхождения или -1
+     */
+    static qsizetype find(const CompactString &haystack, const CompactString &needle, qsizetype from = 0);
+
+private:
+    static const std::unordered_map<QString, Method> &methods();
+};
+
+#endif // STRINGMETHODS_H
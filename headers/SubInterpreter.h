@@ -0,0 +1,74 @@
+#ifndef SUBINTERPRETER_H
+#define SUBINTERPRETER_H
+
+#include "Value.h"
+#include "WorkStealingPool.h"
+#include <QString>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+class ASTNode;
+
+/**
+ * @class SubInterpreter
+ * @brief Выполняет независимые скрипты в изолированных экземплярах интерпретатора, в том числе параллельно.
+ *
+ * Скрипт разбирается один раз (`compile`) вместе с телами функций, после чего разобранное дерево
+ * используется всеми экземплярами только для чтения (см. `AstTraversal::share`). Каждый экземпляр
+ * копирует только инструкции верхнего уровня, которые изменяют проходы оптимизации (`AstTraversal::clone`),
+ * и получает собственные окружение, значения, набор проходов, состояние JIT циклов (`LoopStates`),
+ * кэш машинного кода JIT и буфер вывода, поэтому экземпляры не синхронизируются между собой
+ * и пропускная способность растёт с числом ядер. Данные передаются экземплярам замороженными
+ * значениями, которые читаются всеми потоками без копирования.
+ *
+ * @code
+ * const auto program = SubInterpreter::compile("job.py");
+ * const Value table = Frozen::freeze(load()); //один раз для всех экземпляров
+ * std::vector<std::future<SubInterpreter::Result>> results;
+ * for (int i = 0; i < 1000; ++i) results.push_back(SubInterpreter::start(program, {{"table", table}}));
+ * @endcode
+ */
+class SubInterpreter {
+public:
+    /**
+     * @brief Разобранный скрипт, общий для всех экземпляров
+     */
+    using Program = std::shared_ptr<const ASTNode>;
+
+    struct Result {
+        int status = 0; //0 — успешное выполнение, 1 — ошибка
+        std::string output; //текст, выведенный скриптом (UTF-8)
+        QString error; //сообщение об ошибке при status == 1
+    };
+
+    /**
+     * @brief Разбирает файл path (через кэш модулей, см. `ModuleCache::load`)
+     * @throws std::runtime_error Если файл нельзя прочитать или он содержит синтаксическую ошибку
+     */
+    static Program compile(const QString &path);
+
+    /**
+     * @brief Глобальные переменные, которые получает экземпляр перед выполнением скрипта
+     */
+    using Bindings = std::vector<std::pair<QString, Value>>;
+
+    /**
+     * @brief Выполняет program в новом экземпляре интерпретатора в текущем потоке
+     * @param inputs Начальные глобальные переменные; значения должны быть заморожены заранее
+     * (`Frozen::freeze`), поэтому одна и та же таблица передаётся любому числу экземпляров без копирования.
+     * Если значение не заморожено, экземпляр завершается ошибкой
+     */
+    static Result run(const Program &program, const Bindings &inputs = {});
+
+    /**
+     * @brief Ставит выполнение program в новом экземпляре интерпретатора в очередь пула pool
+     * @throws std::runtime_error Если значение из inputs не заморожено (см. `run`)
+     */
+    static std::future<Result> start(Program program, Bindings inputs = {},
+                                     WorkStealingPool &pool = WorkStealingPool::global());
+};
+
+#endif // SUBINTERPRETER_H
@@ -0,0 +1,90 @@
+#ifndef TYPEINFERENCE_H
+#define TYPEINFERENCE_H
+
+#include "AstTraversal.h"
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TypeInference
+ * @brief Статический вывод примитивных типов для разобранного AST.
+ *
+ * Анализ проходит по дереву в порядке выполнения, отслеживая типы переменных (int, double, bool)
+ * от литералов и присваиваний. Начальные типы берутся из окружения, в котором дерево будет выполнено.
+ * В ветвях `if` типы объединяются, для циклов `while` вычисляется неподвижная точка. Каждому
+ * выражению, тип которого одинаков при любом выполнении, назначается `ASTNode::staticType`;
+ * такие выражения вычисляются без упаковки в `Value`. Если при выполнении тип всё же не выполняется
+ * (переполнение int, значение переменной изменено вне анализируемого кода), выражение вычисляется
+ * заново обычным образом (см. `StaticTypeMismatch`).
+ *
+ * @details
+ * Тип выражения доказывается только там, где числовые обработчики `BinaryDispatch` гарантированно
+ * возвращает одну и ту же альтернативу: арифметика над int и double, сравнения чисел.
+ * Переменная, которая может быть не определена, получает тип своих определений: чтение
+ * неопределённой переменной завершается той же ошибкой, что и в интерпретаторе.
+ * Регионы (корневая инструкция и каждый `if`/`while`), в которых доказаны типы всех выражений,
+ * считаются мономорфными; отчёт о них выводится флагом `--report-types`.
+ */
+class TypeInference {
+public:
+    /**
+     * @struct Region
+     * @brief Итог анализа для одной инструкции или управляющей конструкции.
+     */
+    struct Region {
+        QString description;
+        int expressions = 0; //число выражений в регионе
+        int typedExpressions = 0; //из них с доказанным типом
+        std::map<QString, StaticType> variables; //переменные, которым регион присваивает значения
+
+        [[nodiscard]] bool isMonomorphic() const { return typedExpressions == expressions; }
+    };
+
+    explicit TypeInference(Environment &env) : env(env) {}
+
+    /**
+     * @brief Выводит типы и размечает узлы дерева root
+     */
+    void run(ASTNode &root);
+
+    /**
+     * @brief Возвращает регионы, найденные последним вызовом run()
+     */
+    [[nodiscard]] const std::vector<Region> &regions() const { return found; }
+
+    /**
+     * @brief Возвращает отчёт о регионах в текстовом виде (по строке на регион)
+     */
+    [[nodiscard]] QString report() const;
+
+    /**
+     * @brief Разбирает флаг командной строки `--report-types`
+     * @return true, если флаг относится к выводу типов
+     */
+    static bool parseFlag(const QString &flag);
+
+    static inline bool reportRegions = false;
+
+    static const char *typeName(StaticType type);
+
+private:
+    //Типы переменных в точке программы; переменная без записи имеет тип из окружения
+    using State = std::unordered_map<QString, StaticType>;
+
+    StaticType infer(ASTNode *node, State &state);
+    void inferBlock(const std::vector<std::shared_ptr<ASTNode>> &statements, State &state);
+    [[nodiscard]] std::optional<StaticType> lookup(const State &state, const QString &name) const;
+    [[nodiscard]] State join(const State &a, const State &b) const;
+    static StaticType binaryType(BinOpNode::Operation op, StaticType left, StaticType right);
+
+    void collectRegions(ASTNode *node, bool isRoot);
+    static void measure(ASTNode *node, Region &region);
+
+    Environment &env;
+    std::vector<Region> found;
+    bool importSeen = false; //после import окружение на момент анализа больше не описывает переменные
+};
+
+#endif // TYPEINFERENCE_H
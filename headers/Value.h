@@ -3,8 +3,13 @@
 
 #include <QHash>
 #include <QString>
+#include "Rope.h"
+#include "Buffer.h"
+#include "Bytes.h"
 
 class ASTNode;
+class Awaitable;
+class File;
 
 /**
  * @class Value
@@ -13,7 +18,9 @@ class ASTNode;
  *
  * Класс Value спроектирован для обеспечения гибкого контейнера для хранения и управления множеством типов значений.
  * Он поддерживает различные типы данных, включая целые числа, числа с плавающей точкой, логические значения, строки,
- * списки, словари и функции. Данные хранятся с использованием `std::variant` для эффективного управления типами
+ * байтовые последовательности, списки, словари, функции, ожидаемые объекты (сопрограммы, см. `Coroutine`)
+ * и файлы (см. `File`). Строки хранятся в виде `Rope` поверх компактного
+ * представления `CompactString`, что позволяет откладывать копирование символов при конкатенации. Данные хранятся с использованием `std::variant` для эффективного управления типами
  * и обеспечения типобезопасности.
  *
  * Класс предоставляет конструкторы для инициализации экземпляра `Value` различными типами,
@@ -28,15 +35,24 @@ public:
     using ListPtr = std::shared_ptr<List>;
     using DictPtr = std::shared_ptr<Dict>;
     using FunctionPtr = std::shared_ptr<Function>;
+    using StringPtr = Rope::Ptr;
+    using MemoryViewPtr = std::shared_ptr<MemoryView>;
+    using BytesPtr = std::shared_ptr<Bytes>;
+    using AwaitablePtr = std::shared_ptr<Awaitable>;
+    using FilePtr = std::shared_ptr<File>;
 
     std::variant<
         int,
         double,
         bool,
-        QString,
+        StringPtr,
         ListPtr,
         DictPtr,
-        FunctionPtr
+        FunctionPtr,
+        MemoryViewPtr,
+        BytesPtr,
+        AwaitablePtr,
+        FilePtr
         //В будущем здесь появятся еще типы (наверное)>;
     > data;
 
@@ -45,8 +61,10 @@ public:
     explicit Value(int integer) : data(integer) {}
     explicit Value(double number) : data(number) {}
     explicit Value(bool boolean) : data(boolean) {}
-    explicit Value(const QString& str) : data(str) {}
-    explicit Value(const char* str) : data(QString(str)) {}
+    explicit Value(const QString& str) : data(std::make_shared<Rope>(CompactString(str))) {}
+    explicit Value(const char* str) : data(std::make_shared<Rope>(CompactString(QString(str)))) {}
+    explicit Value(CompactString str) : data(std::make_shared<Rope>(std::move(str))) {}
+    explicit Value(StringPtr str) : data(std::move(str)) {}
 
     explicit Value(const List& list) : data(std::make_shared<List>(list)) {}
     explicit Value(List&& list) : data(std::make_shared<List>(std::move(list))) {}
@@ -57,6 +75,11 @@ public:
     explicit Value(const Function& func) : data(std::make_shared<Function>(func)) {}
     explicit Value(Function&& func) : data(std::make_shared<Function>(std::move(func))) {}
 
+    explicit Value(MemoryViewPtr view) : data(std::move(view)) {}
+    explicit Value(BytesPtr bytes) : data(std::move(bytes)) {}
+    explicit Value(AwaitablePtr awaitable) : data(std::move(awaitable)) {}
+    explicit Value(FilePtr file) : data(std::move(file)) {}
+
     [[nodiscard]] QString toString() const;
     [[nodiscard]] bool toBool() const;
 
@@ -0,0 +1,99 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkStealingPool
+ * @brief Пул потоков с очередью задач у каждого рабочего потока и перехватом задач (work stealing).
+ *
+ * Задача, отправленная из рабочего потока, попадает в конец его собственной очереди и выполняется
+ * им же в порядке LIFO, пока данные задачи ещё в кэше. Задачи из других потоков распределяются
+ * по очередям по кругу. Поток с пустой очередью забирает задачи из начала чужих очередей, поэтому
+ * неравные по длительности задачи выравниваются без общей очереди, на которой соперничали бы все потоки.
+ *
+ * @details
+ * Задача, ожидающая результатов вложенных задач, не должна блокировать поток: `helpUntil`
+ * выполняет задачи пула в ожидающем потоке, пока условие не выполнится. Задачи не должны
+ * выбрасывать исключения — ошибки передаются через результат задачи.
+ *
+ * Рабочие потоки создаются при первой отправке задачи. `quiesce` дожидается выполнения всех задач
+ * и завершает потоки (например, перед `fork`, см. `ProcessPool`); следующая задача создаёт их заново.
+ */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param threadCount Число рабочих потоков (не меньше одного)
+     */
+    explicit WorkStealingPool(int threadCount);
+
+    /**
+     * @brief Дожидается выполнения всех отправленных задач и завершает рабочие потоки
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /**
+     * @brief Ставит задачу task в очередь; запускает рабочие потоки, если они ещё не созданы или завершены `quiesce`
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Дожидается выполнения всех задач и завершает рабочие потоки
+     * @return false, если потоки завершить нельзя: метод вызван из рабочего потока пула
+     * или во время ожидания другие потоки отправили новые задачи
+     */
+    bool quiesce();
+
+    /**
+     * @brief Выполняет задачи пула в текущем потоке, пока done() не вернёт true
+     *
+     * Если задач нет, поток ждёт без нагрузки на процессор. done() должна зависеть только от атомарных
+     * переменных, которые задачи пула изменяют последовательно согласованными операциями.
+     */
+    void helpUntil(const std::function<bool()> &done);
+
+    [[nodiscard]] int threadCount() const { return static_cast<int>(queues.size()); }
+
+    /**
+     * @brief Общий пул процесса с числом потоков, равным числу ядер
+     */
+    static WorkStealingPool &global();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void start();
+    void launch(); //создаёт рабочие потоки; вызывается под lifecycle
+    void work(size_t index);
+    bool runOne(size_t home); //выполняет одну задачу из своей очереди или перехваченную; false, если задач нет
+    [[nodiscard]] size_t homeQueue(); //очередь текущего потока или следующая по кругу
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+    std::mutex lifecycle; //запуск и завершение потоков
+    std::atomic<bool> running{false};
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> helpers{0}; //потоки, ожидающие в helpUntil
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::condition_variable progress; //завершение задачи или новая задача для helpUntil
+    bool stopping = false;
+};
+
+#endif // WORKSTEALINGPOOL_H
@@ -0,0 +1,100 @@
+#ifndef X86EMITTER_H
+#define X86EMITTER_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class X86Emitter
+ * @brief Формирует машинный код x86-64 для JIT-компилятора.
+ *
+ * Эмиттер поддерживает только подмножество инструкций, нужное базовому JIT: 32-битную целочисленную
+ * арифметику, скалярные операции SSE2 над double, сравнения, переходы по меткам и обращения к памяти
+ * вида `[base + disp32]`. Код записывается в обычный буфер; перенос его в исполняемую память
+ * выполняет `CodeCache`.
+ */
+class X86Emitter {
+public:
+    enum Reg : std::uint8_t {
+        RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15
+    };
+
+    /**
+     * @enum Condition
+     * @brief Коды условий для `jcc` и `setcc` (младшие 4 бита опкода).
+     */
+    enum Condition : std::uint8_t {
+        Overflow = 0x0, Below = 0x2, AboveEqual = 0x3, Equal = 0x4, NotEqual = 0x5, BelowEqual = 0x6, Above = 0x7,
+        Parity = 0xA, NoParity = 0xB, Less = 0xC, GreaterEqual = 0xD, LessEqual = 0xE, Greater = 0xF
+    };
+
+    using Label = int;
+
+    [[nodiscard]] const std::vector<std::uint8_t> &code() const { return bytes; }
+
+    // Целочисленные операции (32 бита, если не указано иное)
+    void movRegImm32(Reg dst, std::int32_t imm);
+    void movRegImm64(Reg dst, std::uint64_t imm);
+    void movRegReg(Reg dst, Reg src);
+    void movRegReg64(Reg dst, Reg src);
+    void movRegMem(Reg dst, Reg base, std::int32_t disp);
+    void movMemReg(Reg base, std::int32_t disp, Reg src);
+    void movRegMem64(Reg dst, Reg base, std::int32_t disp);
+    void movMemReg64(Reg base, std::int32_t disp, Reg src);
+    void addRegReg(Reg dst, Reg src);
+    void subRegReg(Reg dst, Reg src);
+    void imulRegReg(Reg dst, Reg src);
+    void cmpRegReg(Reg left, Reg right);
+    void cmpRegImm8(Reg left, std::int8_t imm);
+    void testRegReg(Reg left, Reg right);
+    void cdq();
+    void idiv(Reg divisor);
+    void setcc(Condition condition, Reg dst);
+    void movzxRegReg8(Reg dst, Reg src);
+    void andRegReg(Reg dst, Reg src);
+    void orRegReg(Reg dst, Reg src);
+    void push(Reg reg);
+    void pop(Reg reg);
+    void ret();
+
+    // Скалярные операции SSE2 над double
+    void movsdRegReg(int dst, int src);
+    void movsdRegMem(int dst, Reg base, std::int32_t disp);
+    void movsdMemReg(Reg base, std::int32_t disp, int src);
+    void movqXmmReg(int dst, Reg src);
+    void movqRegXmm(Reg dst, int src);
+    void addsd(int dst, int src);
+    void subsd(int dst, int src);
+    void mulsd(int dst, int src);
+    void divsd(int dst, int src);
+    void ucomisd(int left, int right);
+    void xorpd(int dst, int src);
+    void cvtsi2sd(int dst, Reg src);
+
+    // Метки и переходы
+    Label newLabel();
+    void bind(Label label);
+    void jmp(Label label);
+    void jcc(Condition condition, Label label);
+
+    /**
+     * @brief Разрешает ссылки на метки; вызывается после формирования всего кода
+     */
+    void finalize();
+
+private:
+    void emit(std::uint8_t byte) { bytes.push_back(byte); }
+    void emit32(std::uint32_t value);
+    void rex(bool wide, int reg, int rm, bool force = false);
+    void modRegReg(int reg, int rm);
+    void modRegMem(int reg, Reg base, std::int32_t disp);
+    void sse(std::uint8_t prefix, std::uint8_t opcode, int reg, int rm);
+    void sseMem(std::uint8_t prefix, std::uint8_t opcode, int reg, Reg base, std::int32_t disp);
+    void aluRegReg(std::uint8_t opcode, Reg dst, Reg src);
+
+    std::vector<std::uint8_t> bytes;
+    std::vector<std::int64_t> labels; //позиции меток (-1, пока метка не привязана)
+    std::vector<std::pair<std::size_t, Label>> fixups; //места rel32, ссылающиеся на метки
+};
+
+#endif // X86EMITTER_H
@@ -3,6 +3,5 @@
 int main(const int argc, char *argv[])
 {
     Interpreter interpreter;
-    interpreter.run(argc, argv);
-    return 0;
+    return interpreter.run(argc, argv);
 }
@@ -0,0 +1,282 @@
+#include "AstTraversal.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * Копия литерала, не разделяющая строку или байты с оригиналом (у строк лениво вычисляется хеш).
+     */
+    Value copyValue(const Value &value) {
+        if (const auto *str = std::get_if<Value::StringPtr>(&value.data)) return Value((*str)->flatten());
+        if (const auto *bytes = std::get_if<Value::BytesPtr>(&value.data)) return Value(std::make_shared<Bytes>((*bytes)->data, (*bytes)->isMutable));
+        return value;
+    }
+}
+
+std::vector<ASTNode *> AstTraversal::children(ASTNode *node) {
+    std::vector<ASTNode *> result;
+    auto add = [&result](const std::shared_ptr<ASTNode> &child) { if (child) result.push_back(child.get()); };
+
+    if (const auto *bin = dynamic_cast<BinOpNode *>(node)) {
+        add(bin->left);
+        add(bin->right);
+    } else if (const auto *assign = dynamic_cast<AssignNode *>(node)) {
+        add(assign->valueExpr);
+    } else if (auto *aug = dynamic_cast<AugAssignNode *>(node)) {
+        result.push_back(&aug->binOp);
+    } else if (const auto *temp = dynamic_cast<TempNode *>(node)) {
+        add(temp->expr);
+    } else if (const auto *branch = dynamic_cast<IfNode *>(node)) {
+        add(branch->condition);
+        for (const auto &stmt : branch->body) add(stmt);
+        for (const auto &[condition, body] : branch->elifs) {
+            add(condition);
+            for (const auto &stmt : body) add(stmt);
+        }
+        for (const auto &stmt : branch->elseBody) add(stmt);
+    } else if (const auto *loop = dynamic_cast<WhileNode *>(node)) {
+        add(loop->condition);
+        for (const auto &stmt : loop->body) add(stmt);
+    } else if (const auto *block = dynamic_cast<BlockNode *>(node)) {
+        for (const auto &stmt : block->statements) add(stmt);
+    } else if (const auto *method = dynamic_cast<MethodCallNode *>(node)) {
+        add(method->object);
+        for (const auto &arg : method->args) add(arg);
+    } else if (const auto *call = dynamic_cast<CallNode *>(node)) {
+        for (const auto &arg : call->args) add(arg);
+    } else if (const auto *list = dynamic_cast<ListNode *>(node)) {
+        for (const auto &element : list->elements) add(element);
+    } else if (const auto *ret = dynamic_cast<ReturnNode *>(node)) {
+        add(ret->value);
+    } else if (const auto *await = dynamic_cast<AwaitNode *>(node)) {
+        add(await->operand);
+    } else if (const auto *subscript = dynamic_cast<SubscriptNode *>(node)) {
+        add(subscript->object);
+        add(subscript->start);
+        add(subscript->stop);
+        add(subscript->step);
+    }
+    return result;
+}
+
+void AstTraversal::forEachExpression(ASTNode *node, const std::function<void(std::shared_ptr<ASTNode> &)> &visit) {
+    auto visitOptional = [&visit](std::shared_ptr<ASTNode> &child) { if (child) visit(child); };
+
+    if (auto *bin = dynamic_cast<BinOpNode *>(node)) {
+        visit(bin->left);
+        visit(bin->right);
+    } else if (auto *assign = dynamic_cast<AssignNode *>(node)) {
+        visit(assign->valueExpr);
+    } else if (auto *aug = dynamic_cast<AugAssignNode *>(node)) {
+        //правая часть хранится и в узле, и в его BinOpNode: обе ссылки должны указывать на один узел
+        visit(aug->valueExpr);
+        aug->binOp.right = aug->valueExpr;
+    } else if (auto *branch = dynamic_cast<IfNode *>(node)) {
+        visit(branch->condition);
+        for (auto &elif : branch->elifs) visit(elif.first);
+    } else if (auto *loop = dynamic_cast<WhileNode *>(node)) {
+        visit(loop->condition);
+    } else if (auto *method = dynamic_cast<MethodCallNode *>(node)) {
+        visit(method->object);
+        for (auto &arg : method->args) visit(arg);
+    } else if (auto *call = dynamic_cast<CallNode *>(node)) {
+        for (auto &arg : call->args) visit(arg);
+    } else if (auto *list = dynamic_cast<ListNode *>(node)) {
+        for (auto &element : list->elements) visit(element);
+    } else if (auto *ret = dynamic_cast<ReturnNode *>(node)) {
+        visitOptional(ret->value);
+    } else if (auto *subscript = dynamic_cast<SubscriptNode *>(node)) {
+        visit(subscript->object);
+        visitOptional(subscript->start);
+        visitOptional(subscript->stop);
+        visitOptional(subscript->step);
+    }
+}
+
+void AstTraversal::refresh(ASTNode *statement) {
+    if (auto *aug = dynamic_cast<AugAssignNode *>(statement)) aug->binOp.right = aug->valueExpr;
+}
+
+std::vector<AstTraversal::Block *> AstTraversal::blocks(ASTNode *node) {
+    if (auto *branch = dynamic_cast<IfNode *>(node)) {
+        std::vector<Block *> result = {&branch->body};
+        for (auto &elif : branch->elifs) result.push_back(&elif.second);
+        result.push_back(&branch->elseBody);
+        return result;
+    }
+    if (auto *loop = dynamic_cast<WhileNode *>(node)) return {&loop->body};
+    if (auto *block = dynamic_cast<BlockNode *>(node)) return {&block->statements};
+    return {};
+}
+
+bool AstTraversal::isPure(const ASTNode *node) {
+    if (dynamic_cast<const ValueNode *>(node) || dynamic_cast<const VarNode *>(node)) return true;
+    if (const auto *temp = dynamic_cast<const TempNode *>(node)) return isPure(temp->expr.get());
+    if (const auto *bin = dynamic_cast<const BinOpNode *>(node)) return isPure(bin->left.get()) && isPure(bin->right.get());
+    return false;
+}
+
+bool AstTraversal::callsUserCode(ASTNode *node) {
+    if (dynamic_cast<ImportNode *>(node)) return true;
+    if (const auto *call = dynamic_cast<CallNode *>(node); call && (!Builtins::contains(call->name) || Builtins::callsUserCode(call->name))) return true;
+    const auto nested = children(node);
+    return std::any_of(nested.begin(), nested.end(), callsUserCode);
+}
+
+std::vector<QString> AstTraversal::assignedVariables(ASTNode *node) {
+    std::vector<QString> result;
+    std::function<void(ASTNode *)> collect = [&](ASTNode *current) {
+        if (const auto *assign = dynamic_cast<AssignNode *>(current)) result.push_back(assign->varName);
+        if (const auto *aug = dynamic_cast<AugAssignNode *>(current)) result.push_back(aug->varName);
+        if (const auto *function = dynamic_cast<FunctionNode *>(current)) result.push_back(function->name);
+        for (ASTNode *child : children(current)) collect(child);
+    };
+    collect(node);
+    return result;
+}
+
+bool AstTraversal::reads(ASTNode *node, const QString &name) {
+    if (const auto *var = dynamic_cast<VarNode *>(node); var && var->name == name) return true;
+    if (const auto *aug = dynamic_cast<AugAssignNode *>(node); aug && aug->varName == name) return true;
+    if (const auto *call = dynamic_cast<CallNode *>(node); call && (!Builtins::contains(call->name) || Builtins::callsUserCode(call->name))) return true;
+    if (dynamic_cast<ImportNode *>(node)) return true;
+    const auto nested = children(node);
+    return std::any_of(nested.begin(), nested.end(), [&name](ASTNode *child) { return reads(child, name); });
+}
+
+std::shared_ptr<ASTNode> AstTraversal::clone(const std::shared_ptr<ASTNode> &node, const bool isolated) {
+    const auto copy = [isolated](const std::shared_ptr<ASTNode> &child) { return clone(child, isolated); };
+    const auto cloneAll = [&copy](const Block &block) {
+        Block result;
+        result.reserve(block.size());
+        for (const auto &stmt : block) result.push_back(copy(stmt));
+        return result;
+    };
+
+    if (!node) return nullptr;
+    if (const auto *value = dynamic_cast<const ValueNode *>(node.get())) {
+        if (isolated) return std::make_shared<ValueNode>(copyValue(value->value));
+        return std::make_shared<ValueNode>(value->value);
+    }
+    if (const auto *var = dynamic_cast<const VarNode *>(node.get())) {
+        return std::make_shared<VarNode>(var->name);
+    }
+    if (const auto *bin = dynamic_cast<const BinOpNode *>(node.get())) {
+        return std::make_shared<BinOpNode>(copy(bin->left), bin->op, copy(bin->right));
+    }
+    if (const auto *method = dynamic_cast<const MethodCallNode *>(node.get())) {
+        return std::make_shared<MethodCallNode>(copy(method->object), method->name, cloneAll(method->args));
+    }
+    if (const auto *call = dynamic_cast<const CallNode *>(node.get())) {
+        return std::make_shared<CallNode>(call->name, cloneAll(call->args));
+    }
+    if (const auto *list = dynamic_cast<const ListNode *>(node.get())) {
+        return std::make_shared<ListNode>(cloneAll(list->elements));
+    }
+    if (const auto *subscript = dynamic_cast<const SubscriptNode *>(node.get())) {
+        if (!subscript->isSlice) return std::make_shared<SubscriptNode>(copy(subscript->object), copy(subscript->start));
+        return std::make_shared<SubscriptNode>(copy(subscript->object), copy(subscript->start),
+                                               copy(subscript->stop), copy(subscript->step));
+    }
+    if (const auto *assign = dynamic_cast<const AssignNode *>(node.get())) {
+        return std::make_shared<AssignNode>(assign->varName, copy(assign->valueExpr));
+    }
+    if (const auto *aug = dynamic_cast<const AugAssignNode *>(node.get())) {
+        return std::make_shared<AugAssignNode>(aug->varName, aug->op, copy(aug->valueExpr));
+    }
+    if (const auto *branch = dynamic_cast<const IfNode *>(node.get())) {
+        std::vector<std::pair<std::shared_ptr<ASTNode>, Block>> elifs;
+        for (const auto &[condition, body] : branch->elifs) elifs.emplace_back(copy(condition), cloneAll(body));
+        return std::make_shared<IfNode>(copy(branch->condition), cloneAll(branch->body), std::move(elifs),
+                                        cloneAll(branch->elseBody));
+    }
+    if (const auto *loop = dynamic_cast<const WhileNode *>(node.get())) {
+        return std::make_shared<WhileNode>(copy(loop->condition), cloneAll(loop->body));
+    }
+    if (const auto *block = dynamic_cast<const BlockNode *>(node.get())) {
+        return std::make_shared<BlockNode>(cloneAll(block->statements));
+    }
+    if (const auto *import = dynamic_cast<const ImportNode *>(node.get())) {
+        return std::make_shared<ImportNode>(import->module);
+    }
+    if (const auto *ret = dynamic_cast<const ReturnNode *>(node.get())) {
+        return std::make_shared<ReturnNode>(copy(ret->value));
+    }
+    if (const auto *await = dynamic_cast<const AwaitNode *>(node.get())) {
+        return std::make_shared<AwaitNode>(copy(await->operand));
+    }
+    if (const auto *function = dynamic_cast<const FunctionNode *>(node.get())) {
+        if (isolated && !function->shared) {
+            return std::make_shared<FunctionNode>(function->name, function->params, function->bodyTokens(), function->isAsync);
+        }
+        return node;
+    }
+    throw std::runtime_error("Node can't be copied");
+}
+
+void AstTraversal::share(ASTNode *node) {
+    if (const auto *value = dynamic_cast<ValueNode *>(node)) {
+        if (const auto *str = std::get_if<Value::StringPtr>(&value->value.data)) (void)(*str)->flatten().hash();
+    } else if (auto *loop = dynamic_cast<WhileNode *>(node)) {
+        loop->shared = true;
+    } else if (auto *function = dynamic_cast<FunctionNode *>(node)) {
+        if (function->shared) return;
+        try {
+            for (const auto &stmt : function->statements()) share(stmt.get());
+        } catch (const std::runtime_error &) {
+            return; //тело с синтаксической ошибкой разбирается каждой копией при вызове
+        }
+        function->shared = true;
+    }
+    for (ASTNode *child : children(node)) share(child);
+}
+
+/**
+ * Инструкция приостанавливает сопрограмму, если она сама ожидает (`await x`, `y = await x`,
+ * `return await x`) или является `if`/`while` с такой инструкцией в теле. В остальных положениях
+ * (условие, аргумент вызова, часть выражения) кадр сопрограммы остановиться не может.
+ */
+std::unordered_set<const ASTNode *> AstTraversal::awaitingStatements(const Block &body) {
+    std::function<void(ASTNode *)> forbid = [&forbid](ASTNode *node) {
+        if (dynamic_cast<AwaitNode *>(node)) {
+            throw std::runtime_error("'await' is only allowed as a statement, an assignment value or a return value");
+        }
+        for (ASTNode *child : children(node)) forbid(child);
+    };
+
+    std::unordered_set<const ASTNode *> result;
+    std::function<bool(const Block &)> scan = [&](const Block &block) {
+        bool found = false;
+        for (const auto &statement : block) {
+            ASTNode *node = statement.get();
+            auto *await = dynamic_cast<AwaitNode *>(node);
+            if (const auto *assign = dynamic_cast<AssignNode *>(node)) await = dynamic_cast<AwaitNode *>(assign->valueExpr.get());
+            if (const auto *ret = dynamic_cast<ReturnNode *>(node)) await = dynamic_cast<AwaitNode *>(ret->value.get());
+
+            bool suspends = false;
+            if (await) {
+                forbid(await->operand.get());
+                suspends = true;
+            } else if (const auto *branch = dynamic_cast<IfNode *>(node)) {
+                forbid(branch->condition.get());
+                suspends = scan(branch->body);
+                for (const auto &[condition, elifBody] : branch->elifs) {
+                    forbid(condition.get());
+                    suspends = scan(elifBody) || suspends;
+                }
+                suspends = scan(branch->elseBody) || suspends;
+            } else if (const auto *loop = dynamic_cast<WhileNode *>(node)) {
+                forbid(loop->condition.get());
+                suspends = scan(loop->body);
+            } else {
+                forbid(node);
+            }
+            if (suspends) {
+                result.insert(node);
+                found = true;
+            }
+        }
+        return found;
+    };
+    scan(body);
+    return result;
+}
@@ -0,0 +1,69 @@
+#include "Atoms.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace {
+    struct Atom {
+        size_t hash;
+        std::unique_ptr<QChar[]> storage; //символы имени; не освобождаются, пока атом в таблице
+        QString text; //строка над storage без счётчика ссылок
+        const Atom *next;
+    };
+
+    Atom *create(const size_t hash, const QStringView text, const Atom *next) {
+        auto storage = std::make_unique<QChar[]>(static_cast<size_t>(text.size()));
+        std::copy(text.begin(), text.end(), storage.get());
+        const QString raw = QString::fromRawData(storage.get(), text.size());
+        return new Atom{hash, std::move(storage), raw, next};
+    }
+
+    struct Table {
+        static constexpr size_t bucketCount = 1 << 14;
+
+        std::atomic<const Atom *> buckets[bucketCount] = {};
+        std::atomic<size_t> size{0};
+    };
+
+    Table &table() {
+        static Table &instance = *new Table; //не уничтожается: атомы используются до завершения процесса
+        return instance;
+    }
+
+    /**
+     * Ищет атом в части списка корзины от first до last (не включая last).
+     */
+    const Atom *find(const Atom *first, const Atom *last, const size_t hash, const QStringView text) {
+        for (const Atom *atom = first; atom != last; atom = atom->next) {
+            if (atom->hash == hash && atom->text == text) return atom;
+        }
+        return nullptr;
+    }
+}
+
+/**
+ * Если сравнение с обменом не удалось, другой поток успел добавить атомы в начало списка:
+ * проверяются только они, после чего вставка повторяется.
+ */
+QString Atoms::intern(const QStringView text) {
+    Table &atoms = table();
+    const size_t hash = qHash(text);
+    std::atomic<const Atom *> &bucket = atoms.buckets[hash & (Table::bucketCount - 1)];
+    const Atom *head = bucket.load(std::memory_order_acquire);
+    if (const Atom *found = find(head, nullptr, hash, text)) return found->text;
+
+    Atom *created = create(hash, text, head);
+    while (!bucket.compare_exchange_weak(created->next, created, std::memory_order_release, std::memory_order_acquire)) {
+        if (const Atom *found = find(created->next, head, hash, text)) {
+            delete created;
+            return found->text;
+        }
+        head = created->next;
+    }
+    atoms.size.fetch_add(1, std::memory_order_relaxed);
+    return created->text;
+}
+
+size_t Atoms::count() {
+    return table().size.load(std::memory_order_relaxed);
+}
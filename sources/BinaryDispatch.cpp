@@ -0,0 +1,241 @@
+#include "BinaryDispatch.h"
+#include "Coroutine.h"
+#include "File.h"
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+    void checkDivisionByZero(const double denominator) {
+        if (denominator == 0) {
+            throw std::runtime_error("Division by zero");
+        }
+    }
+
+    /**
+     * Операция над двумя числами типов L и R (int или double). Сложение, вычитание и умножение двух
+     * целых дают целое число, а при переполнении int — результат в double. `//` и `%` над двумя целыми дают int,
+     * над double — double (частное `//` округляется к нулю, `%` вычисляется через std::fmod с тем же знаком, что
+     * и для целых). Остальные операции выполняются в double.
+     */
+    template <typename L, typename R, BinaryOp Op>
+    Value numeric(const Value &l, const Value &r) {
+        const L lv = *std::get_if<L>(&l.data);
+        const R rv = *std::get_if<R>(&r.data);
+        constexpr bool bothInt = std::is_same_v<L, int> && std::is_same_v<R, int>;
+        const double ld = lv;
+        const double rd = rv;
+
+        if constexpr (Op == BinaryOp::Add) {
+            if constexpr (bothInt) {
+                if (int result; !__builtin_add_overflow(lv, rv, &result)) return Value(result);
+            }
+            return Value(ld + rd);
+        } else if constexpr (Op == BinaryOp::Subtract) {
+            if constexpr (bothInt) {
+                if (int result; !__builtin_sub_overflow(lv, rv, &result)) return Value(result);
+            }
+            return Value(ld - rd);
+        } else if constexpr (Op == BinaryOp::Multiply) {
+            if constexpr (bothInt) {
+                if (int result; !__builtin_mul_overflow(lv, rv, &result)) return Value(result);
+            }
+            return Value(ld * rd);
+        } else if constexpr (Op == BinaryOp::Power) {
+            return Value(pow(ld, rd));
+        } else if constexpr (Op == BinaryOp::Divide) {
+            checkDivisionByZero(rd);
+            return Value(ld / rd);
+        } else if constexpr (Op == BinaryOp::Modulo) {
+            checkDivisionByZero(rd);
+            if constexpr (bothInt) return Value(rv == -1 ? 0 : lv % rv); //INT_MIN % -1 вызывает SIGFPE
+            else return Value(std::fmod(ld, rd));
+        } else if constexpr (Op == BinaryOp::IntDivide) {
+            checkDivisionByZero(rd);
+            if constexpr (bothInt) {
+                if (lv == std::numeric_limits<int>::min() && rv == -1) return Value(-ld);
+                return Value(lv / rv);
+            } else {
+                return Value(std::trunc(ld / rd));
+            }
+        } else if constexpr (Op == BinaryOp::Equal) {
+            return Value(ld == rd);
+        } else if constexpr (Op == BinaryOp::NotEqual) {
+            return Value(ld != rd);
+        } else if constexpr (Op == BinaryOp::Greater) {
+            return Value(ld > rd);
+        } else if constexpr (Op == BinaryOp::GreaterEqual) {
+            return Value(ld >= rd);
+        } else if constexpr (Op == BinaryOp::Less) {
+            return Value(ld < rd);
+        } else {
+            return Value(ld <= rd);
+        }
+    }
+
+    /**
+     * Сравнение по результату трёхзначного сравнения cmp.
+     */
+    template <BinaryOp Op>
+    Value fromCompare(const int cmp) {
+        if constexpr (Op == BinaryOp::Equal) return Value(cmp == 0);
+        else if constexpr (Op == BinaryOp::NotEqual) return Value(cmp != 0);
+        else if constexpr (Op == BinaryOp::Greater) return Value(cmp > 0);
+        else if constexpr (Op == BinaryOp::GreaterEqual) return Value(cmp >= 0);
+        else if constexpr (Op == BinaryOp::Less) return Value(cmp < 0);
+        else return Value(cmp <= 0);
+    }
+
+    /**
+     * Конкатенация строк не копирует символы: результатом является узел `Rope`, ссылающийся на оба операнда.
+     */
+    Value concatStrings(const Value &l, const Value &r) {
+        return Value(Rope::concat(*std::get_if<Value::StringPtr>(&l.data), *std::get_if<Value::StringPtr>(&r.data)));
+    }
+
+    /**
+     * Повторение строки на целое число; CountFirst — число стоит слева (`3 * "ab"`).
+     */
+    template <bool CountFirst>
+    Value repeatString(const Value &l, const Value &r) {
+        const Value &str = CountFirst ? r : l;
+        const int times = *std::get_if<int>(&(CountFirst ? l : r).data);
+        return Value((*std::get_if<Value::StringPtr>(&str.data))->flatten().repeated(times));
+    }
+
+    Value concatLists(const Value &l, const Value &r) {
+        const Value::List &lv = **std::get_if<Value::ListPtr>(&l.data);
+        const Value::List &rv = **std::get_if<Value::ListPtr>(&r.data);
+        Value::List result;
+        result.reserve(lv.size() + rv.size());
+        result.insert(result.end(), lv.begin(), lv.end());
+        result.insert(result.end(), rv.begin(), rv.end());
+        return Value(std::move(result));
+    }
+
+    template <bool CountFirst>
+    Value repeatList(const Value &l, const Value &r) {
+        const Value::List &list = **std::get_if<Value::ListPtr>(&(CountFirst ? r : l).data);
+        const int times = *std::get_if<int>(&(CountFirst ? l : r).data);
+        Value::List result;
+        if (times > 0) {
+            result.reserve(list.size() * static_cast<size_t>(times));
+            for (int i = 0; i < times; ++i) result.insert(result.end(), list.begin(), list.end());
+        }
+        return Value(std::move(result));
+    }
+
+    /**
+     * Повторение байтовой последовательности; тип результата (`bytes` или `bytearray`) совпадает с типом операнда.
+     */
+    template <bool CountFirst>
+    Value repeatBytes(const Value &l, const Value &r) {
+        const Bytes &bytes = **std::get_if<Value::BytesPtr>(&(CountFirst ? r : l).data);
+        const int times = *std::get_if<int>(&(CountFirst ? l : r).data);
+        std::string result;
+        if (times > 0) {
+            result.reserve(bytes.data.size() * static_cast<size_t>(times));
+            for (int i = 0; i < times; ++i) result.append(bytes.data);
+        }
+        return Value(std::make_shared<Bytes>(std::move(result), bytes.isMutable));
+    }
+
+    /**
+     * Конкатенация байтовой последовательности с любым значением, предоставляющим непрерывный байтовый буфер.
+     */
+    Value concatBytes(const Value &l, const Value &r) {
+        const Bytes &lv = **std::get_if<Value::BytesPtr>(&l.data);
+        const Buffer buffer = Buffer::of(r);
+        if (buffer.itemSize != 1 || !buffer.isContiguous()) {
+            throw std::runtime_error("can't concat to " + std::string(lv.typeName()));
+        }
+        std::string result;
+        result.reserve(lv.data.size() + static_cast<size_t>(buffer.length));
+        result.append(lv.data).append(reinterpret_cast<const char *>(buffer.data), static_cast<size_t>(buffer.length));
+        return Value(std::make_shared<Bytes>(std::move(result), lv.isMutable));
+    }
+
+    /**
+     * Сравнение двух строк или двух байтовых последовательностей (T — StringPtr или BytesPtr).
+     */
+    template <typename T, BinaryOp Op>
+    Value compare(const Value &l, const Value &r) {
+        const auto &lp = *std::get_if<T>(&l.data);
+        const auto &rp = *std::get_if<T>(&r.data);
+        if constexpr (std::is_same_v<T, Value::BytesPtr>) {
+            return fromCompare<Op>(lp->data.compare(rp->data));
+        } else {
+            const CompactString &lv = lp->flatten();
+            const CompactString &rv = rp->flatten();
+            if constexpr (Op == BinaryOp::Equal) return Value(lv == rv);
+            else if constexpr (Op == BinaryOp::NotEqual) return Value(lv != rv);
+            else return fromCompare<Op>(lv.compare(rv));
+        }
+    }
+
+    template <typename L, typename R, size_t... I>
+    void addNumeric(std::index_sequence<I...>) {
+        (BinaryDispatch::add<L, R>(static_cast<BinaryOp>(I), &numeric<L, R, static_cast<BinaryOp>(I)>), ...);
+    }
+
+    template <typename T, size_t... I>
+    void addComparisons(std::index_sequence<I...>) {
+        constexpr size_t first = static_cast<size_t>(BinaryOp::Equal);
+        (BinaryDispatch::add<T, T>(static_cast<BinaryOp>(first + I), &compare<T, static_cast<BinaryOp>(first + I)>), ...);
+    }
+
+    /**
+     * Регистрирует операции встроенных типов.
+     */
+    void addBuiltinHandlers() {
+        using Ops = std::make_index_sequence<BinaryDispatch::opCount>;
+        using Comparisons = std::make_index_sequence<BinaryDispatch::opCount - static_cast<size_t>(BinaryOp::Equal)>;
+
+        addNumeric<int, int>(Ops{});
+        addNumeric<int, double>(Ops{});
+        addNumeric<double, int>(Ops{});
+        addNumeric<double, double>(Ops{});
+
+        BinaryDispatch::add<Value::StringPtr, Value::StringPtr>(BinaryOp::Add, &concatStrings);
+        addComparisons<Value::StringPtr>(Comparisons{});
+        BinaryDispatch::add<Value::StringPtr, int>(BinaryOp::Multiply, &repeatString<false>);
+        BinaryDispatch::add<int, Value::StringPtr>(BinaryOp::Multiply, &repeatString<true>);
+
+        BinaryDispatch::add<Value::ListPtr, Value::ListPtr>(BinaryOp::Add, &concatLists);
+        BinaryDispatch::add<Value::ListPtr, int>(BinaryOp::Multiply, &repeatList<false>);
+        BinaryDispatch::add<int, Value::ListPtr>(BinaryOp::Multiply, &repeatList<true>);
+
+        BinaryDispatch::add<Value::BytesPtr, Value::BytesPtr>(BinaryOp::Add, &concatBytes);
+        BinaryDispatch::add<Value::BytesPtr, Value::MemoryViewPtr>(BinaryOp::Add, &concatBytes);
+        addComparisons<Value::BytesPtr>(Comparisons{});
+        BinaryDispatch::add<Value::BytesPtr, int>(BinaryOp::Multiply, &repeatBytes<false>);
+        BinaryDispatch::add<int, Value::BytesPtr>(BinaryOp::Multiply, &repeatBytes<true>);
+    }
+
+    const char *typeName(const Value &value) {
+        static const char *names[BinaryDispatch::typeCount] = {
+            "int", "float", "bool", "str", "list", "dict", "function", "memoryview", "bytes", "coroutine", "file"
+        };
+        if (const auto *bytes = std::get_if<Value::BytesPtr>(&value.data)) return (*bytes)->typeName();
+        if (const auto *awaitable = std::get_if<Value::AwaitablePtr>(&value.data)) return (*awaitable)->typeName();
+        if (const auto *file = std::get_if<Value::FilePtr>(&value.data)) return (*file)->typeName();
+        return names[value.data.index()];
+    }
+}
+
+//Таблица инициализирована нулями до динамической инициализации, поэтому регистрация из других
+//единиц трансляции безопасна в любом порядке
+[[maybe_unused]] static const bool builtinsRegistered = (addBuiltinHandlers(), true);
+
+void BinaryDispatch::add(const size_t left, const size_t right, const BinaryOp op, const Handler handler) {
+    handlers[left][right][static_cast<size_t>(op)] = handler;
+}
+
+const char *BinaryDispatch::symbol(const BinaryOp op) {
+    static const char *symbols[opCount] = {"+", "-", "*", "**", "/", "%", "//", "==", "!=", ">", ">=", "<", "<="};
+    return symbols[static_cast<size_t>(op)];
+}
+
+void BinaryDispatch::unsupported(const BinaryOp op, const Value &l, const Value &r) {
+    throw std::runtime_error(std::string("Unsupported operation: ") + typeName(l) + " " + symbol(op) + " " + typeName(r));
+}
@@ -0,0 +1,108 @@
+#include "Buffer.h"
+#include "Value.h"
+#include <cstring>
+
+/**
+ * Возвращает элемент буфера по индексу как целое число без знака.
+ * Чтение выполняется через memcpy, поэтому не зависит от выравнивания данных.
+ *
+ * @param index Индекс элемента (0 <= index < length).
+ * @return Значение элемента.
+ */
+quint32 Buffer::item(const qsizetype index) const {
+    const uchar *p = pointer(index);
+    switch (itemSize) {
+        case 1: return *p;
+        case 2: { quint16 v; std::memcpy(&v, p, sizeof v); return v; }
+        default: { quint32 v; std::memcpy(&v, p, sizeof v); return v; }
+    }
+}
+
+/**
+ * Возвращает указатель на элемент буфера, через который допускается запись.
+ * Используется операциями, заполняющими буфер на месте (например, чтением из файла).
+ *
+ * @param index Индекс элемента (0 <= index < length).
+ * @return Указатель на элемент.
+ * @throws std::runtime_error Если буфер доступен только для чтения.
+ */
+uchar *Buffer::writablePointer(const qsizetype index) const {
+    if (readOnly) throw std::runtime_error("buffer is read-only");
+    return const_cast<uchar *>(pointer(index));
+}
+
+/**
+ * Возвращает часть буфера без копирования данных. Результат разделяет владельца с исходным буфером.
+ *
+ * @param start Индекс первого элемента части.
+ * @param step Шаг между элементами части (в элементах исходного буфера, может быть отрицательным).
+ * @param count Количество элементов части.
+ * @return Буфер, описывающий выбранные элементы.
+ */
+Buffer Buffer::slice(const qsizetype start, const qsizetype step, const qsizetype count) const {
+    Buffer result = *this;
+    result.data = count > 0 ? pointer(start) : data;
+    result.stride = stride * step;
+    result.length = count;
+    return result;
+}
+
+/**
+ * Получает буфер значения.
+ *
+ * Строки предоставляют своё компактное хранилище (ширина элемента 1, 2 или 4 байта, только для чтения);
+ * `bytes` и `bytearray` — свои байты (`bytearray` доступен для записи и не может менять размер, пока
+ * буфер существует); memoryview предоставляет буфер, на который он ссылается.
+ *
+ * @param value Значение, буфер которого требуется получить.
+ * @return Буфер значения.
+ * @throws std::runtime_error Если значение не поддерживает протокол буфера.
+ */
+Buffer Buffer::of(const Value &value) {
+    if (std::holds_alternative<Value::StringPtr>(value.data)) {
+        const Value::StringPtr &rope = std::get<Value::StringPtr>(value.data);
+        const CompactString &str = rope->flatten();
+        Buffer buffer;
+        buffer.owner = rope;
+        buffer.data = str.visit([](const auto &s) { return reinterpret_cast<const uchar *>(s.data()); });
+        buffer.length = str.length();
+        buffer.itemSize = static_cast<int>(str.kind());
+        return buffer;
+    }
+    if (std::holds_alternative<Value::BytesPtr>(value.data)) {
+        const Value::BytesPtr &bytes = std::get<Value::BytesPtr>(value.data);
+        Buffer buffer;
+        buffer.owner = bytes;
+        buffer.data = reinterpret_cast<const uchar *>(bytes->data.data());
+        buffer.length = bytes->length();
+        buffer.readOnly = !bytes->isMutable;
+        if (bytes->isMutable) buffer.exportGuard = bytes->exports;
+        return buffer;
+    }
+    if (std::holds_alternative<Value::MemoryViewPtr>(value.data)) {
+        return std::get<Value::MemoryViewPtr>(value.data)->buffer;
+    }
+    throw std::runtime_error("a bytes-like object is required");
+}
+
+/**
+ * Вызывает метод memoryview. Поддерживается `tolist()`, возвращающий элементы буфера
+ * в виде списка целых чисел.
+ *
+ * @param name Имя метода.
+ * @param args Аргументы вызова.
+ * @return Результат метода.
+ * @throws std::runtime_error Если метод не существует или передан лишний аргумент.
+ */
+Value MemoryView::callMethod(const QString &name, const std::vector<Value> &args) const {
+    if (name == "tolist") {
+        if (!args.empty()) throw std::runtime_error("tolist() takes no arguments");
+        Value::List items;
+        items.reserve(buffer.length);
+        for (qsizetype i = 0; i < buffer.length; ++i) {
+            items.emplace_back(static_cast<int>(buffer.item(i)));
+        }
+        return Value(std::move(items));
+    }
+    throw std::runtime_error("'memoryview' object has no attribute '" + name.toStdString() + "'");
+}
@@ -0,0 +1,193 @@
+#include "Builtins.h"
+#include "EventLoop.h"
+#include "File.h"
+#include "Frozen.h"
+#include "Output.h"
+#include "ParallelMap.h"
+#include "ProcessPool.h"
+
+namespace {
+    void checkArgCount(const std::vector<Value> &args, const size_t count, const char *function) {
+        if (args.size() != count) {
+            throw std::runtime_error(std::string(function) + "() takes exactly " + std::to_string(count) +
+                                     " argument (" + std::to_string(args.size()) + " given)");
+        }
+    }
+
+    /**
+     * Возвращает длину строки, байтовой последовательности, списка, словаря или memoryview. Длина строки известна
+     * без выравнивания отложенных конкатенаций и срезов.
+     */
+    Value builtinLen(const std::vector<Value> &args) {
+        checkArgCount(args, 1, "len");
+        const auto &data = args[0].data;
+        if (std::holds_alternative<Value::StringPtr>(data)) {
+            return Value(static_cast<int>(std::get<Value::StringPtr>(data)->length()));
+        }
+        if (std::holds_alternative<Value::BytesPtr>(data)) {
+            return Value(static_cast<int>(std::get<Value::BytesPtr>(data)->length()));
+        }
+        if (std::holds_alternative<Value::ListPtr>(data)) {
+            return Value(static_cast<int>(std::get<Value::ListPtr>(data)->size()));
+        }
+        if (std::holds_alternative<Value::DictPtr>(data)) {
+            return Value(static_cast<int>(std::get<Value::DictPtr>(data)->size()));
+        }
+        if (std::holds_alternative<Value::MemoryViewPtr>(data)) {
+            return Value(static_cast<int>(std::get<Value::MemoryViewPtr>(data)->buffer.length));
+        }
+        throw std::runtime_error("object has no len()");
+    }
+
+    /**
+     * Возвращает глубоко неизменяемую копию значения, которую потоки разделяют без копирования (см. `Frozen`).
+     * Копия никогда не освобождается, поэтому вызов в цикле с новыми значениями увеличивает память процесса.
+     */
+    Value builtinFreeze(const std::vector<Value> &args) {
+        checkArgCount(args, 1, "freeze");
+        return Frozen::freeze(args[0]);
+    }
+
+    /**
+     * Печатает аргументы через пробел с переводом строки в буфер вывода (см. `Output`).
+     * Возвращаемое значение не используется: REPL не выводит результат вызова `print`.
+     */
+    Value builtinPrint(const std::vector<Value> &args) {
+        Output::print(args);
+        return Value(0);
+    }
+
+    /**
+     * Создаёт memoryview над буфером значения без копирования данных.
+     */
+    Value builtinMemoryView(const std::vector<Value> &args) {
+        checkArgCount(args, 1, "memoryview");
+        return Value(std::make_shared<MemoryView>(Buffer::of(args[0])));
+    }
+
+    /**
+     * Вычисляет содержимое новой байтовой последовательности по аргументам `bytes()`/`bytearray()`:
+     * без аргументов — пустая последовательность; целое число n — n нулевых байтов; строка с
+     * кодировкой — закодированная строка; список целых чисел — байты с этими значениями;
+     * значение с протоколом буфера — копия его байтов.
+     */
+    std::string bytesSource(const std::vector<Value> &args, const char *function) {
+        if (args.size() > 2) {
+            throw std::runtime_error(std::string(function) + "() takes at most 2 arguments (" +
+                                     std::to_string(args.size()) + " given)");
+        }
+        if (args.empty()) return {};
+        const auto &data = args[0].data;
+
+        if (std::holds_alternative<Value::StringPtr>(data)) {
+            if (args.size() < 2 || !std::holds_alternative<Value::StringPtr>(args[1].data)) {
+                throw std::runtime_error("string argument without an encoding");
+            }
+            return Bytes::encode(std::get<Value::StringPtr>(data)->flatten(),
+                                 std::get<Value::StringPtr>(args[1].data)->flatten().toQString());
+        }
+        if (args.size() == 2) throw std::runtime_error("encoding without a string argument");
+
+        if (std::holds_alternative<int>(data)) {
+            const int size = std::get<int>(data);
+            if (size < 0) throw std::runtime_error("negative count");
+            return std::string(static_cast<size_t>(size), '\0');
+        }
+        if (std::holds_alternative<Value::ListPtr>(data)) {
+            const Value::List &items = *std::get<Value::ListPtr>(data);
+            std::string result;
+            result.reserve(items.size());
+            for (const Value &item : items) {
+                if (!std::holds_alternative<int>(item.data) || std::get<int>(item.data) < 0 || std::get<int>(item.data) > 255) {
+                    throw std::runtime_error("bytes must be in range(0, 256)");
+                }
+                result.push_back(static_cast<char>(std::get<int>(item.data)));
+            }
+            return result;
+        }
+
+        const Buffer buffer = Buffer::of(args[0]);
+        if (buffer.isContiguous()) {
+            return std::string(reinterpret_cast<const char *>(buffer.data), static_cast<size_t>(buffer.length * buffer.itemSize));
+        }
+        std::string result;
+        result.reserve(static_cast<size_t>(buffer.length * buffer.itemSize));
+        for (qsizetype i = 0; i < buffer.length; ++i) {
+            result.append(reinterpret_cast<const char *>(buffer.pointer(i)), static_cast<size_t>(buffer.itemSize));
+        }
+        return result;
+    }
+
+    Value builtinBytes(const std::vector<Value> &args) {
+        return Value(std::make_shared<Bytes>(bytesSource(args, "bytes"), false));
+    }
+
+    Value builtinByteArray(const std::vector<Value> &args) {
+        return Value(std::make_shared<Bytes>(bytesSource(args, "bytearray"), true));
+    }
+}
+
+bool Builtins::contains(const QString &name) {
+    return functions().count(name) != 0 || contextFunctions().count(name) != 0;
+}
+
+bool Builtins::callsUserCode(const QString &name) {
+    return contextFunctions().count(name) != 0;
+}
+
+/**
+ * Вызывает встроенную функцию.
+ *
+ * @param name Имя функции.
+ * @param args Вычисленные аргументы вызова.
+ * @param env Окружение вызывающего кода (для функций, вызывающих функции пользователя).
+ * @return Результат функции.
+ * @throws std::runtime_error Если функция с таким именем не существует или аргументы некорректны.
+ */
+Value Builtins::call(const QString &name, const std::vector<Value> &args, Environment &env) {
+    const auto &table = functions();
+    if (const auto it = table.find(name); it != table.end()) return it->second(args);
+    const auto &withContext = contextFunctions();
+    if (const auto it = withContext.find(name); it != withContext.end()) return it->second(args, env);
+    throw std::runtime_error("name '" + name.toStdString() + "' is not defined");
+}
+
+/**
+ * Возвращает таблицу встроенных функций, индексированную по имени функции.
+ */
+const std::unordered_map<QString, Builtins::Function> &Builtins::functions() {
+    static const std::unordered_map<QString, Function> table = {
+        {"len", builtinLen},
+        {"bytes", builtinBytes},
+        {"bytearray", builtinByteArray},
+        {"memoryview", builtinMemoryView},
+        {"print", builtinPrint},
+        {"freeze", builtinFreeze},
+        {"open", File::open},
+        {"create_task", EventLoop::createTask},
+        {"gather", EventLoop::gather},
+        {"sleep", EventLoop::sleep},
+        {"pipe", EventLoop::pipe},
+        {"fd_read", EventLoop::read},
+        {"fd_write", EventLoop::write},
+        {"fd_close", EventLoop::close},
+        {"open_process", EventLoop::openProcess},
+        {"wait_process", EventLoop::waitProcess},
+        {"unix_listen", EventLoop::unixListen},
+        {"unix_accept", EventLoop::unixAccept},
+        {"unix_connect", EventLoop::unixConnect},
+    };
+    return table;
+}
+
+/**
+ * Возвращает таблицу встроенных функций, которым нужно окружение вызывающего кода.
+ */
+const std::unordered_map<QString, Builtins::ContextFunction> &Builtins::contextFunctions() {
+    static const std::unordered_map<QString, ContextFunction> table = {
+        {"parallel_map", ParallelMap::call},
+        {"process_map", ProcessPool::call},
+        {"run", EventLoop::run},
+    };
+    return table;
+}
@@ -0,0 +1,484 @@
+#include "Bytes.h"
+#include "SimdScan.h"
+#include "Value.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace {
+    enum class Encoding { Utf8, Latin1, Ascii };
+
+    Encoding parseEncoding(const QString &name) {
+        static const std::unordered_map<QString, Encoding> encodings = {
+            {"utf-8", Encoding::Utf8}, {"utf8", Encoding::Utf8},
+            {"latin-1", Encoding::Latin1}, {"latin1", Encoding::Latin1}, {"iso-8859-1", Encoding::Latin1},
+            {"ascii", Encoding::Ascii}, {"us-ascii", Encoding::Ascii},
+        };
+        const auto it = encodings.find(name.toLower().replace('_', '-'));
+        if (it == encodings.end()) throw std::runtime_error("unknown encoding: " + name.toStdString());
+        return it->second;
+    }
+
+    [[noreturn]] void decodeError(const QString &encoding, const qsizetype position) {
+        throw std::runtime_error("'" + encoding.toStdString() + "' codec can't decode byte in position " +
+                                 std::to_string(position));
+    }
+
+    bool isAsciiSpace(const char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    void checkArgCount(const std::vector<Value> &args, const size_t min, const size_t max, const char *method) {
+        if (args.size() < min || args.size() > max) {
+            throw std::runtime_error(std::string(method) + "() takes from " + std::to_string(min) + " to " +
+                                     std::to_string(max) + " arguments (" + std::to_string(args.size()) + " given)");
+        }
+    }
+
+    int intArg(const std::vector<Value> &args, const size_t index, const int defaultValue, const char *method) {
+        if (index >= args.size()) return defaultValue;
+        if (!std::holds_alternative<int>(args[index].data)) {
+            throw std::runtime_error(std::string(method) + "() argument " + std::to_string(index + 1) + " must be int");
+        }
+        return std::get<int>(args[index].data);
+    }
+
+    char byteValue(const int value) {
+        if (value < 0 || value > 255) throw std::runtime_error("byte must be in range(0, 256)");
+        return static_cast<char>(value);
+    }
+
+    /**
+     * Возвращает содержимое значения, поддерживающего протокол буфера с элементами шириной 1 байт.
+     * Непрерывные буферы возвращаются без копирования; буферы с шагом копируются в storage.
+     * Строки отклоняются: их нужно явно кодировать методом `encode`.
+     */
+    std::string_view bytesArg(const Value &value, std::string &storage, const char *method) {
+        if (std::holds_alternative<Value::StringPtr>(value.data)) {
+            throw std::runtime_error(std::string(method) + "(): a bytes-like object is required, not 'str'");
+        }
+        const Buffer buffer = Buffer::of(value);
+        if (buffer.itemSize != 1) {
+            throw std::runtime_error(std::string(method) + "(): a bytes-like object is required");
+        }
+        if (buffer.isContiguous()) {
+            return {reinterpret_cast<const char *>(buffer.data), static_cast<size_t>(buffer.length)};
+        }
+        storage.resize(static_cast<size_t>(buffer.length));
+        for (qsizetype i = 0; i < buffer.length; ++i) storage[i] = static_cast<char>(*buffer.pointer(i));
+        return storage;
+    }
+
+    /**
+     * Возвращает искомую последовательность: байтовый объект или целое число (один байт).
+     */
+    std::string_view needleArg(const Value &value, std::string &storage, const char *method) {
+        if (std::holds_alternative<int>(value.data)) {
+            storage.assign(1, byteValue(std::get<int>(value.data)));
+            return storage;
+        }
+        return bytesArg(value, storage, method);
+    }
+
+    qsizetype find(const std::string_view haystack, const std::string_view needle, const qsizetype from) {
+        return SimdScan::find(haystack.data(), static_cast<qsizetype>(haystack.size()),
+                              needle.data(), static_cast<qsizetype>(needle.size()), std::max<qsizetype>(from, 0));
+    }
+
+    /**
+     * Создаёт результат метода того же типа, что и self (методы bytearray возвращают bytearray).
+     */
+    Value sameType(const Bytes &self, std::string data) {
+        return Value(std::make_shared<Bytes>(std::move(data), self.isMutable));
+    }
+
+    void requireMutable(const Bytes &self, const char *method) {
+        if (!self.isMutable) {
+            throw std::runtime_error(std::string("'bytes' object has no attribute '") + method + "'");
+        }
+    }
+
+    Value methodFind(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 2, "find");
+        std::string storage;
+        const std::string_view sub = needleArg(args[0], storage, "find");
+        return Value(static_cast<int>(find(self.data, sub, intArg(args, 1, 0, "find"))));
+    }
+
+    Value methodCount(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "count");
+        std::string storage;
+        const std::string_view sub = needleArg(args[0], storage, "count");
+        if (sub.empty()) return Value(static_cast<int>(self.length() + 1));
+        if (sub.size() == 1) return Value(static_cast<int>(SimdScan::count(self.data.data(), self.length(), sub[0])));
+
+        qsizetype total = 0;
+        for (qsizetype pos = find(self.data, sub, 0); pos >= 0; pos = find(self.data, sub, pos + static_cast<qsizetype>(sub.size()))) {
+            ++total;
+        }
+        return Value(static_cast<int>(total));
+    }
+
+    Value methodReplace(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 2, 3, "replace");
+        std::string oldStorage, newStorage;
+        const std::string_view oldSub = bytesArg(args[0], oldStorage, "replace");
+        const std::string_view newSub = bytesArg(args[1], newStorage, "replace");
+        const int limit = intArg(args, 2, -1, "replace");
+        if (oldSub.empty()) throw std::runtime_error("replace() with an empty pattern is not supported");
+
+        std::string result;
+        size_t copied = 0;
+        int replaced = 0;
+        for (qsizetype pos = find(self.data, oldSub, 0); pos >= 0 && (limit < 0 || replaced < limit);
+             pos = find(self.data, oldSub, static_cast<qsizetype>(copied))) {
+            if (replaced == 0) result.reserve(self.data.size());
+            result.append(self.data, copied, static_cast<size_t>(pos) - copied);
+            result.append(newSub);
+            copied = static_cast<size_t>(pos) + oldSub.size();
+            ++replaced;
+        }
+        if (replaced == 0) return sameType(self, self.data);
+        result.append(self.data, copied, std::string::npos);
+        return sameType(self, std::move(result));
+    }
+
+    Value methodSplit(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 2, "split");
+        const int maxSplit = intArg(args, 1, -1, "split");
+        const std::string &data = self.data;
+        Value::List parts;
+
+        if (args.empty()) {
+            size_t i = 0;
+            while (true) {
+                while (i < data.size() && isAsciiSpace(data[i])) ++i;
+                if (i >= data.size()) break;
+                if (maxSplit >= 0 && static_cast<int>(parts.size()) == maxSplit) {
+                    size_t end = data.size();
+                    while (end > i && isAsciiSpace(data[end - 1])) --end;
+                    parts.push_back(sameType(self, data.substr(i, end - i)));
+                    break;
+                }
+                const size_t start = i;
+                while (i < data.size() && !isAsciiSpace(data[i])) ++i;
+                parts.push_back(sameType(self, data.substr(start, i - start)));
+            }
+            return Value(std::move(parts));
+        }
+
+        std::string storage;
+        const std::string_view sep = bytesArg(args[0], storage, "split");
+        if (sep.empty()) throw std::runtime_error("empty separator");
+        size_t start = 0;
+        for (qsizetype pos = find(data, sep, 0);
+             pos >= 0 && (maxSplit < 0 || static_cast<int>(parts.size()) < maxSplit);
+             pos = find(data, sep, static_cast<qsizetype>(start))) {
+            parts.push_back(sameType(self, data.substr(start, static_cast<size_t>(pos) - start)));
+            start = static_cast<size_t>(pos) + sep.size();
+        }
+        parts.push_back(sameType(self, data.substr(start)));
+        return Value(std::move(parts));
+    }
+
+    /**
+     * Объединяет байтовые объекты списка через разделитель self. Итоговый размер вычисляется
+     * заранее, поэтому буфер результата выделяется один раз.
+     */
+    Value methodJoin(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "join");
+        if (!std::holds_alternative<Value::ListPtr>(args[0].data)) {
+            throw std::runtime_error("join() argument must be a list of bytes-like objects");
+        }
+        const Value::List &items = *std::get<Value::ListPtr>(args[0].data);
+
+        std::vector<std::string> storage(items.size());
+        std::vector<std::string_view> pieces;
+        pieces.reserve(items.size());
+        size_t total = items.empty() ? 0 : self.data.size() * (items.size() - 1);
+        for (size_t i = 0; i < items.size(); ++i) {
+            pieces.push_back(bytesArg(items[i], storage[i], "join"));
+            total += pieces.back().size();
+        }
+
+        std::string result;
+        result.reserve(total);
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            if (i > 0) result.append(self.data);
+            result.append(pieces[i]);
+        }
+        return sameType(self, std::move(result));
+    }
+
+    Value strip(Bytes &self, const std::vector<Value> &args, const bool left, const bool right, const char *method) {
+        checkArgCount(args, 0, 1, method);
+        std::string storage;
+        const bool defaultChars = args.empty();
+        const std::string_view chars = defaultChars ? std::string_view() : bytesArg(args[0], storage, method);
+        auto stripped = [&](const char c) {
+            return defaultChars ? isAsciiSpace(c) : chars.find(c) != std::string_view::npos;
+        };
+
+        size_t begin = 0;
+        size_t end = self.data.size();
+        while (left && begin < end && stripped(self.data[begin])) ++begin;
+        while (right && end > begin && stripped(self.data[end - 1])) --end;
+        return sameType(self, self.data.substr(begin, end - begin));
+    }
+
+    Value methodStartsWith(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "startswith");
+        std::string storage;
+        const std::string_view prefix = bytesArg(args[0], storage, "startswith");
+        return Value(self.data.size() >= prefix.size() && std::memcmp(self.data.data(), prefix.data(), prefix.size()) == 0);
+    }
+
+    Value methodEndsWith(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "endswith");
+        std::string storage;
+        const std::string_view suffix = bytesArg(args[0], storage, "endswith");
+        return Value(self.data.size() >= suffix.size() &&
+                     std::memcmp(self.data.data() + self.data.size() - suffix.size(), suffix.data(), suffix.size()) == 0);
+    }
+
+    Value caseMap(Bytes &self, const std::vector<Value> &args, const bool toUpper, const char *method) {
+        checkArgCount(args, 0, 0, method);
+        std::string result = self.data;
+        SimdScan::asciiCaseMap(result.data(), static_cast<qsizetype>(result.size()), toUpper);
+        return sameType(self, std::move(result));
+    }
+
+    Value methodDecode(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 1, "decode");
+        QString encoding = "utf-8";
+        if (!args.empty()) {
+            if (!std::holds_alternative<Value::StringPtr>(args[0].data)) {
+                throw std::runtime_error("decode() argument 1 must be str");
+            }
+            encoding = std::get<Value::StringPtr>(args[0].data)->flatten().toQString();
+        }
+        return Value(Bytes::decode(self.data.data(), self.length(), encoding));
+    }
+
+    Value methodHex(Bytes &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 0, "hex");
+        static const char digits[] = "0123456789abcdef";
+        std::string result(self.data.size() * 2, '\0');
+        for (size_t i = 0; i < self.data.size(); ++i) {
+            const auto byte = static_cast<unsigned char>(self.data[i]);
+            result[2 * i] = digits[byte >> 4];
+            result[2 * i + 1] = digits[byte & 0xF];
+        }
+        return Value(CompactString::fromLatin1(result.data(), static_cast<qsizetype>(result.size())));
+    }
+
+    Value methodAppend(Bytes &self, const std::vector<Value> &args) {
+        requireMutable(self, "append");
+        checkArgCount(args, 1, 1, "append");
+        const char byte = byteValue(intArg(args, 0, 0, "append"));
+        self.append(&byte, 1);
+        return {};
+    }
+
+    /**
+     * Дописывает в bytearray содержимое байтового объекта или список целых чисел.
+     */
+    Value methodExtend(Bytes &self, const std::vector<Value> &args) {
+        requireMutable(self, "extend");
+        checkArgCount(args, 1, 1, "extend");
+        std::string storage;
+        if (std::holds_alternative<Value::ListPtr>(args[0].data)) {
+            const Value::List &items = *std::get<Value::ListPtr>(args[0].data);
+            storage.reserve(items.size());
+            for (size_t i = 0; i < items.size(); ++i) storage.push_back(byteValue(intArg(items, i, 0, "extend")));
+            self.append(storage.data(), static_cast<qsizetype>(storage.size()));
+            return {};
+        }
+        const std::string_view piece = bytesArg(args[0], storage, "extend");
+        self.append(piece.data(), static_cast<qsizetype>(piece.size()));
+        return {};
+    }
+}
+
+/**
+ * Дописывает байты в конец последовательности на месте. Буфер растёт геометрически,
+ * поэтому серия дописываний работает за амортизированно линейное время. Источник может
+ * указывать внутрь самой последовательности (`a.extend(a)`).
+ *
+ * @param source Указатель на дописываемые байты.
+ * @param size Количество байтов.
+ * @throws std::runtime_error Если на буфер ссылаются memoryview и его размер менять нельзя.
+ */
+void Bytes::append(const char *source, const qsizetype size) {
+    if (size <= 0) return;
+    if (isExported()) {
+        throw std::runtime_error("BufferError: Existing exports of data: object cannot be re-sized");
+    }
+    if (source >= data.data() && source < data.data() + data.size()) {
+        const size_t offset = static_cast<size_t>(source - data.data());
+        data.reserve(std::max(data.size() + static_cast<size_t>(size), data.capacity() * 2));
+        data.append(data, offset, static_cast<size_t>(size));
+        return;
+    }
+    data.append(source, static_cast<size_t>(size));
+}
+
+/**
+ * Возвращает литерал значения. Печатаемые ASCII-символы выводятся как есть, `\t`, `\n`, `\r`
+ * и обратная косая черта экранируются, остальные байты записываются как `\xNN`. Как и в Python,
+ * кавычки выбираются так, чтобы не экранировать одинарные кавычки без необходимости.
+ *
+ * @return Литерал вида `b'...'` или `bytearray(b'...')`.
+ */
+QString Bytes::repr() const {
+    static const char digits[] = "0123456789abcdef";
+    const char quote = data.find('\'') != std::string::npos && data.find('"') == std::string::npos ? '"' : '\'';
+    std::string out = "b";
+    out.reserve(data.size() + 3);
+    out += quote;
+    for (const char c : data) {
+        const auto byte = static_cast<unsigned char>(c);
+        if (c == quote || c == '\\') { out += '\\'; out += c; }
+        else if (c == '\t') out += "\\t";
+        else if (c == '\n') out += "\\n";
+        else if (c == '\r') out += "\\r";
+        else if (byte < 0x20 || byte >= 0x7F) { out += "\\x"; out += digits[byte >> 4]; out += digits[byte & 0xF]; }
+        else out += c;
+    }
+    out += quote;
+    const QString literal = QString::fromLatin1(out.data(), static_cast<qsizetype>(out.size()));
+    return isMutable ? "bytearray(" + literal + ")" : literal;
+}
+
+/**
+ * Кодирует строку в байты.
+ *
+ * @param str Кодируемая строка.
+ * @param encoding Имя кодировки (`utf-8`, `latin-1` или `ascii`, регистр и `_`/`-` не важны).
+ * @return Байты строки.
+ * @throws std::runtime_error Если кодировка неизвестна или символ строки в ней непредставим.
+ */
+std::string Bytes::encode(const CompactString &str, const QString &encoding) {
+    const Encoding kind = parseEncoding(encoding);
+    if (str.isAscii() || (kind == Encoding::Latin1 && str.kind() == CompactString::Kind::Latin1)) {
+        return str.visit([](const auto &s) {
+            if constexpr (std::is_same_v<std::decay_t<decltype(s)>, std::string>) return s;
+            else return std::string();
+        });
+    }
+    if (kind != Encoding::Utf8) {
+        for (qsizetype i = 0; i < str.length(); ++i) {
+            if (str.at(i) >= (kind == Encoding::Ascii ? 0x80u : 0x100u)) {
+                throw std::runtime_error("'" + encoding.toStdString() + "' codec can't encode character in position " +
+                                         std::to_string(i));
+            }
+        }
+    }
+
+    std::string out;
+    out.reserve(static_cast<size_t>(str.length()));
+    for (qsizetype i = 0; i < str.length(); ++i) {
+        const char32_t cp = str.at(i);
+        if (kind != Encoding::Utf8 || cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return out;
+}
+
+/**
+ * Декодирует байты в строку. Данные в кодировке Latin-1 и ASCII копируются в строку шириной
+ * 1 байт без промежуточных преобразований; UTF-8 проверяется и декодируется в кодовые точки.
+ *
+ * @param data Указатель на байты.
+ * @param size Количество байтов.
+ * @param encoding Имя кодировки (`utf-8`, `latin-1` или `ascii`).
+ * @return Декодированная строка.
+ * @throws std::runtime_error Если кодировка неизвестна или байты в ней некорректны.
+ */
+CompactString Bytes::decode(const char *data, const qsizetype size, const QString &encoding) {
+    const Encoding kind = parseEncoding(encoding);
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+    const qsizetype firstNonAscii = std::find_if(bytes, bytes + size, [](const unsigned char c) { return c >= 0x80; }) - bytes;
+    if (firstNonAscii == size || kind == Encoding::Latin1) return CompactString::fromLatin1(data, size);
+
+    if (kind == Encoding::Ascii) decodeError(encoding, firstNonAscii);
+
+    std::u32string points;
+    points.reserve(static_cast<size_t>(size));
+    for (qsizetype i = 0; i < size;) {
+        const unsigned char lead = bytes[i];
+        int extra = 0;
+        char32_t cp = lead;
+        if (lead >= 0xC2 && lead < 0xE0) { extra = 1; cp = lead & 0x1F; }
+        else if (lead >= 0xE0 && lead < 0xF0) { extra = 2; cp = lead & 0x0F; }
+        else if (lead >= 0xF0 && lead < 0xF5) { extra = 3; cp = lead & 0x07; }
+        else if (lead >= 0x80) decodeError(encoding, i);
+        for (int k = 1; k <= extra; ++k) {
+            if (i + k >= size || (bytes[i + k] & 0xC0) != 0x80) decodeError(encoding, i);
+            cp = (cp << 6) | (bytes[i + k] & 0x3F);
+        }
+        if ((extra == 2 && (cp < 0x800 || (cp >= 0xD800 && cp < 0xE000))) || (extra == 3 && (cp < 0x10000 || cp > 0x10FFFF))) {
+            decodeError(encoding, i);
+        }
+        points.push_back(cp);
+        i += extra + 1;
+    }
+    return CompactString::fromCodePoints(points);
+}
+
+/**
+ * Вызывает встроенный метод `bytes` или `bytearray`.
+ *
+ * @param self Последовательность, для которой вызывается метод.
+ * @param name Имя метода.
+ * @param args Вычисленные аргументы вызова.
+ * @return Результат метода.
+ * @throws std::runtime_error Если метода с таким именем нет или аргументы некорректны.
+ */
+Value Bytes::call(Bytes &self, const QString &name, const std::vector<Value> &args) {
+    const auto &table = methods();
+    const auto it = table.find(name);
+    if (it == table.end()) {
+        throw std::runtime_error(std::string("'") + self.typeName() + "' object has no attribute '" + name.toStdString() + "'");
+    }
+    return it->second(self, args);
+}
+
+/**
+ * Возвращает таблицу встроенных методов байтовых последовательностей, индексированную по имени метода.
+ * Методы `append` и `extend` доступны только у `bytearray`.
+ */
+const std::unordered_map<QString, Bytes::Method> &Bytes::methods() {
+    static const std::unordered_map<QString, Method> table = {
+        {"find", methodFind},
+        {"count", methodCount},
+        {"replace", methodReplace},
+        {"split", methodSplit},
+        {"join", methodJoin},
+        {"strip", [](Bytes &self, const std::vector<Value> &args) { return strip(self, args, true, true, "strip"); }},
+        {"lstrip", [](Bytes &self, const std::vector<Value> &args) { return strip(self, args, true, false, "lstrip"); }},
+        {"rstrip", [](Bytes &self, const std::vector<Value> &args) { return strip(self, args, false, true, "rstrip"); }},
+        {"startswith", methodStartsWith},
+        {"endswith", methodEndsWith},
+        {"lower", [](Bytes &self, const std::vector<Value> &args) { return caseMap(self, args, false, "lower"); }},
+        {"upper", [](Bytes &self, const std::vector<Value> &args) { return caseMap(self, args, true, "upper"); }},
+        {"decode", methodDecode},
+        {"hex", methodHex},
+        {"append", methodAppend},
+        {"extend", methodExtend},
+    };
+    return table;
+}
@@ -0,0 +1,316 @@
+#include "CompactString.h"
+#include <algorithm>
+#include <vector>
+
+namespace {
+    /**
+     * Возвращает кодовую точку элемента строкового хранилища любой ширины.
+     */
+    char32_t codePoint(const std::string &s, const size_t i) { return static_cast<unsigned char>(s[i]); }
+    char32_t codePoint(const std::u16string &s, const size_t i) { return s[i]; }
+    char32_t codePoint(const std::u32string &s, const size_t i) { return s[i]; }
+
+    /**
+     * Дописывает элементы src в dst, приводя их к ширине dst.
+     * Вызывающая сторона гарантирует, что все кодовые точки src помещаются в элемент dst.
+     */
+    template<typename Dst, typename Src>
+    void appendUnits(Dst &dst, const Src &src) {
+        if constexpr (std::is_same_v<Dst, Src>) {
+            dst.append(src);
+        } else {
+            const size_t base = dst.size();
+            dst.resize(base + src.size());
+            for (size_t i = 0; i < src.size(); ++i) {
+                dst[base + i] = static_cast<typename Dst::value_type>(codePoint(src, i));
+            }
+        }
+    }
+
+    CompactString::Kind kindFor(const char32_t maxCodePoint) {
+        if (maxCodePoint < 0x100) return CompactString::Kind::Latin1;
+        if (maxCodePoint < 0x10000) return CompactString::Kind::UCS2;
+        return CompactString::Kind::UCS4;
+    }
+}
+
+/**
+ * Создаёт компактную строку из QString.
+ *
+ * UTF-16 декодируется в кодовые точки (суррогатные пары объединяются), после чего
+ * строка записывается в хранилище минимальной достаточной ширины.
+ *
+ * @param str Исходная строка.
+ */
+CompactString::CompactString(const QString &str) {
+    std::u32string points;
+    points.reserve(str.length());
+    for (qsizetype i = 0; i < str.length(); ++i) {
+        char32_t cp = str[i].unicode();
+        if (QChar::isHighSurrogate(cp) && i + 1 < str.length() && str[i + 1].isLowSurrogate()) {
+            cp = QChar::surrogateToUcs4(str[i], str[i + 1]);
+            ++i;
+        }
+        points.push_back(cp);
+    }
+    *this = fromCodePoints(points);
+}
+
+/**
+ * Создаёт компактную строку из кодовых точек. Ширина элемента выбирается по наибольшей
+ * кодовой точке последовательности.
+ *
+ * @param points Кодовые точки строки.
+ * @return Строка в минимальной ширине.
+ */
+CompactString CompactString::fromCodePoints(const std::u32string &points) {
+    CompactString result;
+    const char32_t maxCodePoint = points.empty() ? 0 : *std::max_element(points.begin(), points.end());
+    result.ascii = maxCodePoint < 0x80;
+    switch (kindFor(maxCodePoint)) {
+        case Kind::Latin1: result.storage = std::string(); break;
+        case Kind::UCS2: result.storage = std::u16string(); break;
+        case Kind::UCS4: result.storage = std::u32string(); break;
+    }
+    std::visit([&](auto &s) { appendUnits(s, points); }, result.storage);
+    return result;
+}
+
+/**
+ * Создаёт компактную строку из байтов Latin-1 без промежуточных преобразований.
+ *
+ * @param data Указатель на байты строки.
+ * @param size Количество байтов.
+ * @return Строка шириной 1 байт.
+ */
+CompactString CompactString::fromLatin1(const char *data, const qsizetype size) {
+    CompactString result;
+    result.storage = std::string(data, size);
+    result.ascii = std::all_of(data, data + size, [](const char c) { return static_cast<unsigned char>(c) < 0x80; });
+    return result;
+}
+
+/**
+ * Преобразует строку в QString (UTF-16). Кодовые точки вне BMP кодируются суррогатными парами.
+ *
+ * @return Строка в представлении Qt.
+ */
+QString CompactString::toQString() const {
+    return visit([](const auto &s) {
+        using Storage = std::decay_t<decltype(s)>;
+        if constexpr (std::is_same_v<Storage, std::string>) {
+            return QString::fromLatin1(s.data(), static_cast<qsizetype>(s.size()));
+        } else if constexpr (std::is_same_v<Storage, std::u16string>) {
+            return QString(reinterpret_cast<const QChar *>(s.data()), static_cast<qsizetype>(s.size()));
+        } else {
+            return QString::fromUcs4(s.data(), static_cast<qsizetype>(s.size()));
+        }
+    });
+}
+
+qsizetype CompactString::length() const {
+    return visit([](const auto &s) { return static_cast<qsizetype>(s.size()); });
+}
+
+/**
+ * Возвращает кодовую точку по индексу. Благодаря фиксированной ширине элемента
+ * операция выполняется за O(1).
+ *
+ * @param index Индекс символа (0 <= index < length()).
+ * @return Кодовая точка символа.
+ */
+char32_t CompactString::at(const qsizetype index) const {
+    return visit([index](const auto &s) { return codePoint(s, static_cast<size_t>(index)); });
+}
+
+/**
+ * Возвращает хеш строки (FNV-1a по кодовым точкам). Значение вычисляется при первом
+ * обращении и кешируется до следующего изменения строки.
+ *
+ * @return Хеш строки.
+ */
+size_t CompactString::hash() const {
+    if (!hashed) {
+        cachedHash = visit([](const auto &s) {
+            size_t h = 14695981039346656037ull;
+            for (size_t i = 0; i < s.size(); ++i) {
+                h = (h ^ codePoint(s, i)) * 1099511628211ull;
+            }
+            return h;
+        });
+        hashed = true;
+    }
+    return cachedHash;
+}
+
+/**
+ * Лексикографически сравнивает строки по кодовым точкам.
+ *
+ * @param other Строка для сравнения.
+ * @return Отрицательное число, если текущая строка меньше; ноль, если строки равны;
+ *         положительное число, если текущая строка больше.
+ */
+int CompactString::compare(const CompactString &other) const {
+    return std::visit([](const auto &a, const auto &b) {
+        const size_t n = std::min(a.size(), b.size());
+        for (size_t i = 0; i < n; ++i) {
+            const char32_t ca = codePoint(a, i);
+            const char32_t cb = codePoint(b, i);
+            if (ca != cb) return ca < cb ? -1 : 1;
+        }
+        if (a.size() == b.size()) return 0;
+        return a.size() < b.size() ? -1 : 1;
+    }, storage, other.storage);
+}
+
+/**
+ * Проверяет строки на равенство. Так как строки хранятся в минимальной ширине,
+ * строки разной ширины заведомо различны, а для одинаковой ширины достаточно сравнить хранилища.
+ *
+ * @param other Строка для сравнения.
+ * @return true, если строки равны.
+ */
+bool CompactString::operator==(const CompactString &other) const {
+    if (storage.index() != other.storage.index()) return false;
+    if (hashed && other.hashed && cachedHash != other.cachedHash) return false;
+    return storage == other.storage;
+}
+
+/**
+ * Дописывает строку other в конец текущей. Если other содержит более широкие символы,
+ * текущая строка предварительно расширяется до нужной ширины.
+ *
+ * @param other Дописываемая строка.
+ */
+void CompactString::append(const CompactString &other) {
+    if (other.isEmpty()) return;
+    if (other.kind() > kind()) widen(other.kind());
+    std::visit([&](auto &dst) {
+        other.visit([&](const auto &src) { appendUnits(dst, src); });
+    }, storage);
+    ascii = ascii && other.ascii;
+    hashed = false;
+}
+
+/**
+ * Дописывает фрагмент строки other в конец текущей. Ширина результата выбирается по ширине other,
+ * поэтому после серии таких вызовов может понадобиться normalize().
+ *
+ * @param other Строка-источник.
+ * @param pos Начальная позиция фрагмента.
+ * @param count Длина фрагмента.
+ */
+void CompactString::append(const CompactString &other, const qsizetype pos, const qsizetype count) {
+    if (count <= 0) return;
+    if (other.kind() > kind()) widen(other.kind());
+    std::visit([&](auto &dst) {
+        other.visit([&](const auto &src) {
+            const size_t base = dst.size();
+            dst.resize(base + static_cast<size_t>(count));
+            for (qsizetype i = 0; i < count; ++i) {
+                dst[base + i] = static_cast<typename std::decay_t<decltype(dst)>::value_type>(codePoint(src, pos + i));
+            }
+        });
+    }, storage);
+    ascii = ascii && other.ascii;
+    hashed = false;
+}
+
+/**
+ * Приводит строку к минимальной ширине элемента. Используется после сборки строки
+ * из фрагментов более широких строк (например, в replace или срезах).
+ */
+void CompactString::normalize() {
+    const char32_t maxCodePoint = visit([](const auto &s) {
+        char32_t m = 0;
+        for (size_t i = 0; i < s.size(); ++i) m = std::max(m, codePoint(s, i));
+        return m;
+    });
+    ascii = maxCodePoint < 0x80;
+    if (kindFor(maxCodePoint) == kind()) return;
+
+    decltype(storage) narrower;
+    switch (kindFor(maxCodePoint)) {
+        case Kind::Latin1: narrower = std::string(); break;
+        case Kind::UCS2: narrower = std::u16string(); break;
+        case Kind::UCS4: return;
+    }
+    std::visit([&](auto &dst) { visit([&](const auto &src) { appendUnits(dst, src); }); }, narrower);
+    storage = std::move(narrower);
+}
+
+/**
+ * Резервирует место под size элементов. Если kind шире текущей ширины, строка сразу расширяется,
+ * чтобы последующие вызовы append не копировали данные повторно.
+ *
+ * @param size Ожидаемое количество элементов.
+ * @param kind Ожидаемая ширина элемента.
+ */
+void CompactString::reserve(const qsizetype size, const Kind kind) {
+    if (kind > this->kind()) widen(kind);
+    std::visit([size](auto &s) { s.reserve(static_cast<size_t>(size)); }, storage);
+}
+
+/**
+ * Возвращает строку, повторённую times раз.
+ *
+ * @param times Количество повторений; при значении <= 0 возвращается пустая строка.
+ * @return Новая строка той же ширины.
+ */
+CompactString CompactString::repeated(const qsizetype times) const {
+    CompactString result;
+    if (times <= 0 || isEmpty()) return result;
+    result.storage = visit([times](const auto &s) {
+        std::decay_t<decltype(s)> out;
+        out.reserve(s.size() * static_cast<size_t>(times));
+        for (qsizetype i = 0; i < times; ++i) out.append(s);
+        return std::variant<std::string, std::u16string, std::u32string>(std::move(out));
+    });
+    result.ascii = ascii;
+    return result;
+}
+
+/**
+ * Возвращает подстроку длиной не более count, начиная с позиции pos.
+ * Ширина результата уменьшается, если подстрока её допускает.
+ *
+ * @param pos Начальная позиция.
+ * @param count Максимальная длина подстроки.
+ * @return Подстрока.
+ */
+CompactString CompactString::mid(const qsizetype pos, const qsizetype count) const {
+    CompactString result;
+    const qsizetype len = length();
+    if (pos >= len || count <= 0) return result;
+    const qsizetype n = std::min(count, len - pos);
+
+    char32_t maxCodePoint = 0;
+    for (qsizetype i = pos; i < pos + n; ++i) maxCodePoint = std::max(maxCodePoint, at(i));
+
+    switch (kindFor(maxCodePoint)) {
+        case Kind::Latin1: result.storage = std::string(); break;
+        case Kind::UCS2: result.storage = std::u16string(); break;
+        case Kind::UCS4: result.storage = std::u32string(); break;
+    }
+    std::visit([&](auto &dst) {
+        visit([&](const auto &src) { appendUnits(dst, src.substr(static_cast<size_t>(pos), static_cast<size_t>(n))); });
+    }, result.storage);
+    result.ascii = maxCodePoint < 0x80;
+    return result;
+}
+
+/**
+ * Расширяет хранилище строки до ширины to, сохраняя её содержимое.
+ *
+ * @param to Новая ширина элемента (не меньше текущей).
+ */
+void CompactString::widen(const Kind to) {
+    decltype(storage) wider;
+    switch (to) {
+        case Kind::Latin1: return;
+        case Kind::UCS2: wider = std::u16string(); break;
+        case Kind::UCS4: wider = std::u32string(); break;
+    }
+    std::visit([&](auto &dst) { visit([&](const auto &src) { appendUnits(dst, src); }); }, wider);
+    storage = std::move(wider);
+}
@@ -0,0 +1,147 @@
+#include "Coroutine.h"
+#include "GreenScheduler.h"
+#include "Parser.h"
+#include <utility>
+
+namespace {
+    /**
+     * Узел await, результат которого ожидает инструкция statement, или nullptr.
+     */
+    const AwaitNode *awaitOf(const ASTNode *statement) {
+        if (const auto *await = dynamic_cast<const AwaitNode *>(statement)) return await;
+        if (const auto *assign = dynamic_cast<const AssignNode *>(statement)) {
+            return dynamic_cast<const AwaitNode *>(assign->valueExpr.get());
+        }
+        if (const auto *ret = dynamic_cast<const ReturnNode *>(statement)) {
+            return dynamic_cast<const AwaitNode *>(ret->value.get());
+        }
+        return nullptr;
+    }
+}
+
+void Future::setResult(Value result) {
+    if (done()) return;
+    value = std::move(result);
+    finish(State::Finished);
+}
+
+void Future::setError(std::string message) {
+    if (done()) return;
+    error = std::move(message);
+    finish(State::Failed);
+}
+
+const Value &Future::result() const {
+    if (state == State::Failed) throw std::runtime_error(error);
+    return value;
+}
+
+void Future::onDone(Callback callback) {
+    if (done()) callback();
+    else callbacks.push_back(std::move(callback));
+}
+
+void Future::repr(std::string &out) const {
+    out += '<';
+    out += typeName();
+    out += state == State::Pending ? " pending>" : " finished>";
+}
+
+void Future::finish(const State finalState) {
+    state = finalState;
+    for (const Callback &callback : std::exchange(callbacks, {})) callback();
+}
+
+Coroutine::Coroutine(std::shared_ptr<const FunctionNode> function, const std::vector<Value> &args, Environment &globals) :
+function(std::move(function)), locals(&globals) {
+    for (size_t i = 0; i < args.size(); ++i) locals.set(this->function->params[i], args[i]);
+    cursors.push_back({&this->function->body, 0, nullptr});
+}
+
+void Coroutine::claim() {
+    if (finished) throw std::runtime_error("cannot reuse already awaited coroutine");
+    if (claimed) throw std::runtime_error("coroutine is being awaited already");
+    claimed = true;
+}
+
+void Coroutine::repr(std::string &out) const {
+    out += "<coroutine " + function->name.toStdString() + ">";
+}
+
+/**
+ * Инструкции без await выполняются обычным `eval`; инструкция с await вычисляет операнд и
+ * приостанавливает кадр, а `if` и `while`, содержащие await, открывают курсор по своему блоку.
+ * Итерация цикла — шаг задачи `GreenScheduler`, как в `WhileNode::eval`.
+ */
+Coroutine::Step Coroutine::resume(const Value &sent) {
+    try {
+        if (pending) {
+            if (dynamic_cast<const AssignNode *>(pending)) {
+                locals.set(static_cast<const AssignNode *>(pending)->varName, sent);
+            } else if (dynamic_cast<const ReturnNode *>(pending)) {
+                locals.returnValue = sent;
+                locals.returning = true;
+            }
+            pending = nullptr;
+            if (locals.returning) return finish();
+        }
+
+        while (!cursors.empty()) {
+            Cursor &cursor = cursors.back();
+            if (cursor.next == cursor.block->size()) {
+                if (cursor.loop) {
+                    GreenScheduler::step();
+                    if (cursor.loop->condition->evalCondition(locals)) {
+                        cursor.next = 0;
+                        continue;
+                    }
+                }
+                cursors.pop_back();
+                continue;
+            }
+
+            const ASTNode *statement = (*cursor.block)[cursor.next++].get();
+            if (const AwaitNode *await = awaitOf(statement)) {
+                const Value operand = await->operand->eval(locals);
+                const auto *awaitable = std::get_if<Value::AwaitablePtr>(&operand.data);
+                if (!awaitable) {
+                    throw std::runtime_error("Object can't be used in 'await' expression");
+                }
+                pending = statement;
+                return {*awaitable, Value()};
+            }
+            if (function->suspends(statement)) enter(statement);
+            else statement->eval(locals);
+            if (locals.returning) return finish();
+        }
+        return finish();
+    } catch (...) {
+        cursors.clear();
+        finished = true;
+        throw;
+    }
+}
+
+void Coroutine::enter(const ASTNode *statement) {
+    if (const auto *branch = dynamic_cast<const IfNode *>(statement)) {
+        if (branch->condition->evalCondition(locals)) {
+            cursors.push_back({&branch->body});
+            return;
+        }
+        for (const auto &[condition, body] : branch->elifs) {
+            if (condition->evalCondition(locals)) {
+                cursors.push_back({&body});
+                return;
+            }
+        }
+        cursors.push_back({&branch->elseBody});
+    } else if (const auto *loop = dynamic_cast<const WhileNode *>(statement)) {
+        if (loop->condition->evalCondition(locals)) cursors.push_back({&loop->body, 0, loop});
+    }
+}
+
+Coroutine::Step Coroutine::finish() {
+    cursors.clear();
+    finished = true;
+    return {nullptr, locals.returning ? std::exchange(locals.returnValue, Value()) : Value()};
+}
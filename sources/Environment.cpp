@@ -3,6 +3,7 @@
 /**
  * Устанавливает переменную в окружении с указанным именем и значением.
  * Если переменная уже существует, её значение будет обновлено.
+ * Переменная всегда создаётся в этом окружении, даже если родитель содержит переменную с тем же именем.
  *
  * @param name Имя переменной для установки или обновления.
  * @param value Значение, которое нужно связать с указанным именем переменной.
@@ -13,7 +14,7 @@ void Environment::set(const QString& name, const Value& value)
 }
 
 /**
- * Возвращает ссылку на значение переменной с указанным именем из окружения.
+ * Возвращает ссылку на значение переменной с указанным именем из окружения или его родителей.
  * Если переменная с данным именем не существует, выбрасывается исключение std::runtime_error.
  *
  * @param name Имя переменной, значение которой требуется получить.
@@ -21,9 +22,52 @@ void Environment::set(const QString& name, const Value& value)
  * @throws std::runtime_error Если переменная с указанным именем не найдена.
  */
 Value& Environment::get(const QString& name)
+{
+    if (Value *value = find(name)) return *value;
+    throw std::runtime_error("Undefined variable: " + name.toStdString());
+}
+
+/**
+ * Ищет переменную с указанным именем в окружении и его родителях, не выбрасывая исключение при её отсутствии.
+ *
+ * @param name Имя переменной.
+ * @return Указатель на значение переменной или nullptr, если переменная не определена.
+ *         Указатель остаётся действительным, пока переменная не удалена из окружения.
+ */
+Value* Environment::find(const QString& name)
+{
+    for (Environment *env = this; env; env = env->parent) {
+        if (Value *value = env->findLocal(name)) return value;
+    }
+    return nullptr;
+}
+
+/**
+ * Возвращает ссылку на локальную переменную для изменения на месте (`x += ...`).
+ * Переменные родительского окружения так не изменяются: как и в Python, составное присваивание
+ * глобальной переменной внутри функции является ошибкой.
+ *
+ * @param name Имя переменной.
+ * @return Ссылка на значение переменной этого окружения.
+ * @throws std::runtime_error Если переменная не определена в этом окружении.
+ */
+Value& Environment::getLocal(const QString& name)
+{
+    if (Value *value = findLocal(name)) return *value;
+    if (find(name)) {
+        throw std::runtime_error("local variable '" + name.toStdString() + "' referenced before assignment");
+    }
+    throw std::runtime_error("Undefined variable: " + name.toStdString());
+}
+
+/**
+ * Ищет переменную только в этом окружении, без обращения к родителям.
+ *
+ * @param name Имя переменной.
+ * @return Указатель на значение переменной или nullptr, если переменная не определена локально.
+ */
+Value* Environment::findLocal(const QString& name)
 {
     const auto it = variables.find(name);
-    if (it == variables.end())
-        throw std::runtime_error("Undefined variable: " + name.toStdString());
-    return it->second;
+    return it == variables.end() ? nullptr : &it->second;
 }
@@ -0,0 +1,574 @@
+#include "EventLoop.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+#ifdef __linux__
+#include "Bytes.h"
+#include "GreenScheduler.h"
+#include "Rope.h"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+#endif
+
+#ifdef __linux__
+
+namespace {
+    std::string errnoMessage(const int code) {
+        return "[Errno " + std::to_string(code) + "] " + std::strerror(code);
+    }
+
+    [[noreturn]] void throwErrno() {
+        throw std::runtime_error(errnoMessage(errno));
+    }
+
+    void checkArgCount(const std::vector<Value> &args, const size_t count, const char *function) {
+        if (args.size() != count) {
+            throw std::runtime_error(std::string(function) + "() takes exactly " + std::to_string(count) +
+                                     " argument (" + std::to_string(args.size()) + " given)");
+        }
+    }
+
+    int intArg(const Value &value, const char *function) {
+        const auto *integer = std::get_if<int>(&value.data);
+        if (!integer) throw std::runtime_error(std::string(function) + "() argument must be an integer");
+        return *integer;
+    }
+
+    std::string pathArg(const Value &value, const char *function) {
+        const auto *str = std::get_if<Value::StringPtr>(&value.data);
+        if (!str) throw std::runtime_error(std::string(function) + "() argument must be a string");
+        return (*str)->flatten().toQString().toStdString();
+    }
+
+    sockaddr_un unixAddress(const std::string &path) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) throw std::runtime_error("AF_UNIX path too long");
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        return address;
+    }
+
+    int unixSocket() {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) throwErrno();
+        return fd;
+    }
+
+    /**
+     * Код возврата в формате Python: отрицательный номер сигнала, если процесс завершён сигналом.
+     */
+    int exitCode(const int status) {
+        return WIFSIGNALED(status) ? -WTERMSIG(status) : WEXITSTATUS(status);
+    }
+}
+
+/**
+ * Задача: ведёт стек кадров сопрограмм от сопрограммы, с которой она создана, до самой вложенной.
+ * Результат задачи — результат первой сопрограммы.
+ */
+class EventLoop::Task : public Future, public std::enable_shared_from_this<Task> {
+public:
+    Task(EventLoop &loop, std::shared_ptr<Coroutine> coroutine) : loop(loop) {
+        frames.push_back(std::move(coroutine));
+    }
+
+    [[nodiscard]] const char *typeName() const override { return "Task"; }
+
+    /**
+     * Продолжает кадры, пока задача не начнёт ожидать незавершённую операцию или не завершится.
+     */
+    void step() {
+        try {
+            if (awaited) sent = std::exchange(awaited, nullptr)->result();
+            while (!frames.empty()) {
+                Coroutine::Step next = frames.back()->resume(std::exchange(sent, Value()));
+                if (!next.awaiting) {
+                    frames.pop_back();
+                    sent = std::move(next.value);
+                    continue;
+                }
+                if (auto coroutine = std::dynamic_pointer_cast<Coroutine>(next.awaiting)) {
+                    coroutine->claim();
+                    frames.push_back(std::move(coroutine));
+                    continue;
+                }
+                const auto future = std::static_pointer_cast<Future>(next.awaiting);
+                if (future.get() == this) throw std::runtime_error("Task cannot await on itself");
+                if (future->done()) {
+                    sent = future->result();
+                    continue;
+                }
+                awaited = future;
+                future->onDone([self = shared_from_this()] {
+                    self->loop.callSoon([self] { self->step(); });
+                });
+                return;
+            }
+        } catch (const std::exception &e) {
+            frames.clear();
+            setError(e.what());
+            return;
+        }
+        setResult(std::exchange(sent, Value()));
+    }
+
+private:
+    EventLoop &loop;
+    std::vector<std::shared_ptr<Coroutine>> frames;
+    Value sent; //результат ожидания, передаваемый верхнему кадру
+    std::shared_ptr<Future> awaited; //операция, завершения которой ждёт задача
+};
+
+EventLoop::EventLoop() : epoll(epoll_create1(EPOLL_CLOEXEC)) {
+    if (epoll < 0) throwErrno();
+}
+
+EventLoop::~EventLoop() {
+    ::close(epoll);
+}
+
+EventLoop &EventLoop::running(const char *function) {
+    if (!current) throw std::runtime_error(std::string(function) + "(): no running event loop");
+    return *current;
+}
+
+void EventLoop::callSoon(Callback callback) {
+    ready.push_back(std::move(callback));
+}
+
+void EventLoop::callLater(const Clock::duration delay, Callback callback) {
+    timers.push({Clock::now() + delay, timerSequence++, std::move(callback)});
+}
+
+void EventLoop::submit(const int fd, const bool writing, Attempt attempt, const std::shared_ptr<Future> &future) {
+    const auto it = watches.find(fd);
+    const bool queued = it != watches.end() && !(writing ? it->second.writers : it->second.readers).empty();
+    if (!queued && attempt()) return; //операции с дескриптором выполняются по очереди
+
+    Watch &watch = watches[fd];
+    (writing ? watch.writers : watch.readers).push_back(std::move(attempt));
+    watch.futures.push_back(future);
+    update(fd, watch);
+}
+
+/**
+ * Приводит маску epoll в соответствие с ожидающими операциями; дескриптор без операций удаляется из epoll.
+ */
+void EventLoop::update(const int fd, Watch &watch) {
+    std::uint32_t events = 0;
+    if (!watch.readers.empty()) events |= EPOLLIN;
+    if (!watch.writers.empty()) events |= EPOLLOUT;
+    if (events == watch.events) {
+        if (events == 0) watches.erase(fd);
+        return;
+    }
+
+    epoll_event event{};
+    event.events = events;
+    event.data.fd = fd;
+    const int op = watch.events == 0 ? EPOLL_CTL_ADD : events == 0 ? EPOLL_CTL_DEL : EPOLL_CTL_MOD;
+    if (epoll_ctl(epoll, op, fd, &event) < 0) {
+        const int code = errno;
+        for (const auto &future : watch.futures) future->setError(errnoMessage(code));
+        watches.erase(fd);
+        return;
+    }
+    watch.events = events;
+    if (events == 0) watches.erase(fd);
+}
+
+/**
+ * Дескриптор закрывается: ожидающие его операции завершаются ошибкой.
+ */
+void EventLoop::forget(const int fd) {
+    const auto it = watches.find(fd);
+    if (it == watches.end()) return;
+    if (it->second.events != 0) epoll_ctl(epoll, EPOLL_CTL_DEL, fd, nullptr);
+    const std::vector<std::shared_ptr<Future>> futures = std::move(it->second.futures);
+    watches.erase(it);
+    for (const auto &future : futures) future->setError(errnoMessage(EBADF));
+}
+
+/**
+ * Выполняет операции готового дескриптора, пока они завершаются. При ошибке или закрытии
+ * второй стороны попытка операции сама узнаёт причину от системного вызова.
+ */
+void EventLoop::dispatch(const int fd, const std::uint32_t events) {
+    const auto it = watches.find(fd);
+    if (it == watches.end()) return;
+    Watch &watch = it->second;
+    auto drain = [](std::deque<Attempt> &queue) {
+        while (!queue.empty() && queue.front()()) queue.pop_front();
+    };
+    if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) drain(watch.readers);
+    if (events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) drain(watch.writers);
+    watch.futures.erase(std::remove_if(watch.futures.begin(), watch.futures.end(),
+                                       [](const std::shared_ptr<Future> &future) { return future->done(); }),
+                        watch.futures.end());
+    update(fd, watch);
+}
+
+/**
+ * Ждёт готовности дескрипторов (не дольше срока ближайшего таймера, без ожидания при block == false)
+ * и выполняет готовые операции и истёкшие таймеры.
+ */
+void EventLoop::poll(const bool block) {
+    int timeout = block ? -1 : 0;
+    if (block && !timers.empty()) {
+        const auto delay = std::chrono::ceil<std::chrono::milliseconds>(timers.top().deadline - Clock::now());
+        timeout = static_cast<int>(std::max<std::chrono::milliseconds::rep>(delay.count(), 0));
+    }
+
+    if (!watches.empty() || timeout != 0) {
+        epoll_event events[64];
+        const int count = epoll_wait(epoll, events, 64, timeout);
+        if (count < 0 && errno != EINTR) throwErrno();
+        for (int i = 0; i < count; ++i) dispatch(events[i].data.fd, events[i].events);
+    }
+
+    const auto now = Clock::now();
+    while (!timers.empty() && timers.top().deadline <= now) {
+        callSoon(timers.top().callback);
+        timers.pop();
+    }
+}
+
+std::shared_ptr<EventLoop::Task> EventLoop::spawn(const std::shared_ptr<Coroutine> &coroutine) {
+    coroutine->claim();
+    auto task = std::make_shared<Task>(*this, coroutine);
+    callSoon([task] { task->step(); });
+    return task;
+}
+
+/**
+ * Операция для ожидания value: сопрограмма запускается задачей, задача или Future возвращаются как есть.
+ */
+std::shared_ptr<Future> EventLoop::awaitableOf(const Value &value, const char *function) {
+    const auto *awaitable = std::get_if<Value::AwaitablePtr>(&value.data);
+    if (!awaitable) throw std::runtime_error(std::string(function) + "() argument must be a coroutine or a task");
+    if (auto coroutine = std::dynamic_pointer_cast<Coroutine>(*awaitable)) return spawn(coroutine);
+    return std::static_pointer_cast<Future>(*awaitable);
+}
+
+/**
+ * Выполняет готовые обратные вызовы по одному поколению за итерацию, чтобы операции ввода-вывода
+ * и таймеры проверялись между ними.
+ */
+Value EventLoop::run(const std::vector<Value> &args, Environment &) {
+    checkArgCount(args, 1, "run");
+    const auto *awaitable = std::get_if<Value::AwaitablePtr>(&args[0].data);
+    const auto coroutine = awaitable ? std::dynamic_pointer_cast<Coroutine>(*awaitable) : nullptr;
+    if (!coroutine) throw std::runtime_error("run() argument must be a coroutine");
+    if (current) throw std::runtime_error("run() cannot be called from a running event loop");
+
+    EventLoop loop;
+    current = &loop;
+    struct Reset {
+        ~Reset() { current = nullptr; }
+    } reset;
+
+    const auto main = loop.spawn(coroutine);
+    while (!main->done()) {
+        if (loop.ready.empty() && loop.timers.empty() && loop.watches.empty()) {
+            throw std::runtime_error("run(): the coroutine is waiting for a task that can never finish");
+        }
+        const bool block = loop.ready.empty() && !GreenScheduler::inTask();
+        loop.poll(block);
+        if (loop.ready.empty() && !block) { //в задаче планировщика ожидание приостанавливает задачу, а не поток
+            GreenScheduler::wait(loop.epoll, loop.timers.empty() ? Clock::time_point::max() : loop.timers.top().deadline);
+            loop.poll(false);
+        }
+        for (std::deque<Callback> batch = std::exchange(loop.ready, {}); !batch.empty(); batch.pop_front()) {
+            batch.front()();
+        }
+    }
+    return main->result();
+}
+
+Value EventLoop::createTask(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "create_task");
+    EventLoop &loop = running("create_task");
+    const auto *awaitable = std::get_if<Value::AwaitablePtr>(&args[0].data);
+    const auto coroutine = awaitable ? std::dynamic_pointer_cast<Coroutine>(*awaitable) : nullptr;
+    if (!coroutine) throw std::runtime_error("create_task() argument must be a coroutine");
+    return Value(Value::AwaitablePtr(loop.spawn(coroutine)));
+}
+
+/**
+ * Результат — список результатов в порядке аргументов; первая ошибка завершает ожидание.
+ */
+Value EventLoop::gather(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "gather");
+    EventLoop &loop = running("gather");
+    const auto *list = std::get_if<Value::ListPtr>(&args[0].data);
+    if (!list) throw std::runtime_error("gather() argument must be a list");
+
+    struct State {
+        std::shared_ptr<Future> result = std::make_shared<Future>();
+        Value::List values;
+        size_t remaining = 0;
+    };
+    const auto state = std::make_shared<State>();
+    state->values.resize((*list)->size());
+    state->remaining = (*list)->size();
+    if (state->remaining == 0) state->result->setResult(Value(Value::List()));
+
+    for (size_t i = 0; i < (*list)->size(); ++i) {
+        const auto future = loop.awaitableOf((**list)[i], "gather");
+        future->onDone([state, future, i] {
+            try {
+                state->values[i] = future->result();
+            } catch (const std::exception &e) {
+                state->result->setError(e.what());
+                return;
+            }
+            if (--state->remaining == 0) state->result->setResult(Value(std::move(state->values)));
+        });
+    }
+    return Value(Value::AwaitablePtr(state->result));
+}
+
+Value EventLoop::sleep(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "sleep");
+    EventLoop &loop = running("sleep");
+    double seconds = 0;
+    if (const auto *integer = std::get_if<int>(&args[0].data)) seconds = *integer;
+    else if (const auto *number = std::get_if<double>(&args[0].data)) seconds = *number;
+    else throw std::runtime_error("sleep() argument must be a number");
+    if (!std::isfinite(seconds)) throw std::runtime_error("sleep() argument must be finite");
+
+    auto future = std::make_shared<Future>();
+    const auto delay = std::chrono::duration<double>(std::max(seconds, 0.0));
+    loop.callLater(std::chrono::duration_cast<Clock::duration>(delay), [future] { future->setResult(Value()); });
+    return Value(Value::AwaitablePtr(future));
+}
+
+Value EventLoop::pipe(const std::vector<Value> &args) {
+    checkArgCount(args, 0, "pipe");
+    int fds[2];
+    if (::pipe2(fds, O_NONBLOCK | O_CLOEXEC) < 0) throwErrno();
+    return Value(Value::List{Value(fds[0]), Value(fds[1])});
+}
+
+Value EventLoop::read(const std::vector<Value> &args) {
+    checkArgCount(args, 2, "fd_read");
+    EventLoop &loop = running("fd_read");
+    const int fd = intArg(args[0], "fd_read");
+    const int size = intArg(args[1], "fd_read");
+    if (size < 0) throw std::runtime_error("fd_read() size must be non-negative");
+
+    auto future = std::make_shared<Future>();
+    loop.submit(fd, false, [fd, size, future] {
+        std::string data(static_cast<size_t>(size), '\0');
+        const ssize_t count = ::read(fd, data.data(), data.size());
+        if (count < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return false;
+            future->setError(errnoMessage(errno));
+            return true;
+        }
+        data.resize(static_cast<size_t>(count));
+        future->setResult(Value(std::make_shared<Bytes>(std::move(data), false)));
+        return true;
+    }, future);
+    return Value(Value::AwaitablePtr(future));
+}
+
+/**
+ * Запись завершается, когда записаны все байты; результат — их число.
+ */
+Value EventLoop::write(const std::vector<Value> &args) {
+    checkArgCount(args, 2, "fd_write");
+    EventLoop &loop = running("fd_write");
+    const int fd = intArg(args[0], "fd_write");
+    const auto *bytes = std::get_if<Value::BytesPtr>(&args[1].data);
+    if (!bytes) throw std::runtime_error("fd_write() argument 2 must be bytes");
+
+    auto future = std::make_shared<Future>();
+    auto data = std::make_shared<std::string>((*bytes)->data); //bytearray может измениться до окончания записи
+    auto written = std::make_shared<size_t>(0);
+    loop.submit(fd, true, [fd, data, written, future] {
+        while (*written < data->size()) {
+            const ssize_t count = ::write(fd, data->data() + *written, data->size() - *written);
+            if (count < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return false;
+                future->setError(errnoMessage(errno));
+                return true;
+            }
+            *written += static_cast<size_t>(count);
+        }
+        future->setResult(Value(static_cast<int>(*written)));
+        return true;
+    }, future);
+    return Value(Value::AwaitablePtr(future));
+}
+
+Value EventLoop::close(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "fd_close");
+    const int fd = intArg(args[0], "fd_close");
+    if (current) current->forget(fd);
+    if (::close(fd) < 0 && errno != EINTR) throwErrno();
+    return Value();
+}
+
+/**
+ * Запускает `/bin/sh -c cmd`; стандартный вывод процесса направляется в канал, читаемый через `fd_read`.
+ */
+Value EventLoop::openProcess(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "open_process");
+    const std::string command = pathArg(args[0], "open_process");
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC) < 0) throwErrno();
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    const char *argv[] = {"sh", "-c", command.c_str(), nullptr};
+    pid_t pid = 0;
+    const int code = posix_spawn(&pid, "/bin/sh", &actions, nullptr, const_cast<char *const *>(argv), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fds[1]);
+    if (code != 0) {
+        ::close(fds[0]);
+        throw std::runtime_error(errnoMessage(code));
+    }
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    return Value(Value::List{Value(static_cast<int>(pid)), Value(fds[0])});
+}
+
+/**
+ * Завершение процесса ожидается через pidfd; если ядро его не поддерживает, процесс опрашивается по таймеру.
+ */
+Value EventLoop::waitProcess(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "wait_process");
+    EventLoop &loop = running("wait_process");
+    const pid_t pid = intArg(args[0], "wait_process");
+
+    auto future = std::make_shared<Future>();
+    auto reap = [pid, future] {
+        int status = 0;
+        const pid_t result = waitpid(pid, &status, WNOHANG);
+        if (result == 0) return false;
+        if (result < 0) future->setError(errnoMessage(errno));
+        else future->setResult(Value(exitCode(status)));
+        return true;
+    };
+
+#ifdef SYS_pidfd_open
+    const int pidfd = static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    const int pidfd = -1;
+#endif
+    if (pidfd >= 0) {
+        fcntl(pidfd, F_SETFD, FD_CLOEXEC);
+        future->onDone([pidfd, &loop] { loop.callSoon([pidfd] { ::close(pidfd); }); });
+        loop.submit(pidfd, false, reap, future);
+    } else if (!reap()) {
+        struct Retry {
+            EventLoop &loop;
+            decltype(reap) attempt;
+            void operator()() const {
+                if (!attempt()) loop.callLater(std::chrono::milliseconds(10), *this);
+            }
+        };
+        loop.callLater(std::chrono::milliseconds(10), Retry{loop, reap});
+    }
+    return Value(Value::AwaitablePtr(future));
+}
+
+Value EventLoop::unixListen(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "unix_listen");
+    const sockaddr_un address = unixAddress(pathArg(args[0], "unix_listen"));
+    const int fd = unixSocket();
+    if (bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) < 0 || listen(fd, SOMAXCONN) < 0) {
+        const int code = errno;
+        ::close(fd);
+        throw std::runtime_error(errnoMessage(code));
+    }
+    return Value(fd);
+}
+
+Value EventLoop::unixAccept(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "unix_accept");
+    EventLoop &loop = running("unix_accept");
+    const int fd = intArg(args[0], "unix_accept");
+
+    auto future = std::make_shared<Future>();
+    loop.submit(fd, false, [fd, future] {
+        const int client = accept4(fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ECONNABORTED) return false;
+            future->setError(errnoMessage(errno));
+            return true;
+        }
+        future->setResult(Value(client));
+        return true;
+    }, future);
+    return Value(Value::AwaitablePtr(future));
+}
+
+Value EventLoop::unixConnect(const std::vector<Value> &args) {
+    checkArgCount(args, 1, "unix_connect");
+    EventLoop &loop = running("unix_connect");
+    const sockaddr_un address = unixAddress(pathArg(args[0], "unix_connect"));
+    const int fd = unixSocket();
+
+    auto future = std::make_shared<Future>();
+    if (connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == 0) {
+        future->setResult(Value(fd));
+    } else if (errno == EINPROGRESS) {
+        loop.submit(fd, true, [fd, future] {
+            int code = 0;
+            socklen_t length = sizeof(code);
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &code, &length) < 0) code = errno;
+            if (code == 0) {
+                future->setResult(Value(fd));
+            } else {
+                ::close(fd);
+                future->setError(errnoMessage(code));
+            }
+            return true;
+        }, future);
+    } else {
+        const int code = errno;
+        ::close(fd);
+        throw std::runtime_error(errnoMessage(code));
+    }
+    return Value(Value::AwaitablePtr(future));
+}
+
+#else
+
+namespace {
+    [[noreturn]] void unsupported() {
+        throw std::runtime_error("asynchronous I/O is only supported on Linux");
+    }
+}
+
+Value EventLoop::run(const std::vector<Value> &, Environment &) { unsupported(); }
+Value EventLoop::createTask(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::gather(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::sleep(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::pipe(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::read(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::write(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::close(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::openProcess(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::waitProcess(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::unixListen(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::unixAccept(const std::vector<Value> &) { unsupported(); }
+Value EventLoop::unixConnect(const std::vector<Value> &) { unsupported(); }
+
+#endif
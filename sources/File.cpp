@@ -0,0 +1,405 @@
+#include "File.h"
+#include "Bytes.h"
+#include "Value.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    void checkArgCount(const std::vector<Value> &args, const size_t min, const size_t max, const char *method) {
+        if (args.size() < min || args.size() > max) {
+            throw std::runtime_error(std::string(method) + "() takes " + (min == max ? "exactly " : "at most ") +
+                                     std::to_string(max) + " argument (" + std::to_string(args.size()) + " given)");
+        }
+    }
+
+    /**
+     * Длина последовательности UTF-8 по первому байту; некорректный байт считается отдельным символом,
+     * а ошибку сообщает декодирование.
+     */
+    size_t sequenceLength(const unsigned char lead) {
+        if (lead < 0x80) return 1;
+        if ((lead >> 5) == 0x6) return 2;
+        if ((lead >> 4) == 0xE) return 3;
+        if ((lead >> 3) == 0x1E) return 4;
+        return 1;
+    }
+
+    void writeAll(QFile &file, const char *data, size_t size) {
+        while (size != 0) {
+            const qint64 count = file.write(data, static_cast<qint64>(size));
+            if (count < 0) throw std::runtime_error(file.errorString().toStdString());
+            data += count;
+            size -= static_cast<size_t>(count);
+        }
+    }
+
+    Value methodRead(File &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 1, "read");
+        qint64 size = -1;
+        if (!args.empty()) {
+            const auto *requested = std::get_if<int>(&args[0].data);
+            if (!requested) throw std::runtime_error("read() argument must be an integer");
+            size = *requested;
+        }
+        return self.read(size);
+    }
+
+    Value methodReadLine(File &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 0, "readline");
+        return self.readLine();
+    }
+
+    /**
+     * Читает все оставшиеся строки в список.
+     */
+    Value methodReadLines(File &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 0, "readlines");
+        Value::List lines;
+        for (Value line = self.readLine(); line.toBool(); line = self.readLine()) lines.push_back(std::move(line));
+        return Value(std::move(lines));
+    }
+
+    Value methodLineView(File &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 0, "lineview");
+        return self.lineView();
+    }
+
+    Value methodReadInto(File &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "readinto");
+        if (!self.isBinary()) throw std::runtime_error("'TextIOWrapper' object has no attribute 'readinto'");
+        return Value(static_cast<int>(self.readInto(Buffer::of(args[0]))));
+    }
+
+    Value methodWrite(File &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "write");
+        return Value(static_cast<int>(self.write(args[0])));
+    }
+
+    Value methodFlush(File &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 0, "flush");
+        self.flush();
+        return {};
+    }
+
+    Value methodClose(File &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 0, "close");
+        self.close();
+        return {};
+    }
+}
+
+/**
+ * Открывает файл. Обычный файл от `mapThreshold` байт, открытый для чтения, отображается в память;
+ * если отображение не удалось, файл читается блоками.
+ *
+ * @param args Путь и необязательный режим (по умолчанию `r`).
+ * @return Файловый объект.
+ * @throws std::runtime_error Если режим некорректен или файл не удалось открыть.
+ */
+Value File::open(const std::vector<Value> &args) {
+    checkArgCount(args, 1, 2, "open");
+    const auto *path = std::get_if<Value::StringPtr>(&args[0].data);
+    if (!path) throw std::runtime_error("open() argument 1 must be str");
+    QString mode = "r";
+    if (args.size() == 2) {
+        const auto *requested = std::get_if<Value::StringPtr>(&args[1].data);
+        if (!requested) throw std::runtime_error("open() argument 2 must be str");
+        mode = (*requested)->flatten().toQString();
+    }
+
+    static const std::unordered_set<QString> modes = {"r", "rt", "rb", "w", "wt", "wb", "a", "at", "ab"};
+    if (modes.count(mode) == 0) throw std::runtime_error("invalid mode: '" + mode.toStdString() + "'");
+    const bool writable = !mode.startsWith("r");
+    const bool binary = mode.endsWith("b");
+
+    const QString name = (*path)->flatten().toQString();
+    auto file = std::make_shared<QFile>(name);
+    const auto flags = !writable ? QIODevice::ReadOnly | QIODevice::Unbuffered
+                     : mode.startsWith("w") ? QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered
+                                            : QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered;
+    if (!file->open(flags)) {
+        throw std::runtime_error(file->errorString().toStdString() + ": '" + name.toStdString() + "'");
+    }
+    return Value(std::make_shared<File>(std::move(file), std::move(mode), binary, writable));
+}
+
+File::File(std::shared_ptr<QFile> file, QString mode, const bool binary, const bool writable) :
+file(std::move(file)), name(this->file->fileName()), mode(std::move(mode)), binary(binary), writable(writable) {
+    if (writable || this->file->isSequential()) return;
+    const qint64 size = this->file->size();
+    if (size < mapThreshold) return;
+#ifdef _WIN32
+    const uchar *address = this->file->map(0, size);
+    if (!address) return;
+    mapping = std::shared_ptr<const uchar>(this->file, address); //отображение QFile живёт, пока открыт файл
+#else
+    void *address = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, this->file->handle(), 0);
+    if (address == MAP_FAILED) return;
+    mapping = std::shared_ptr<const uchar>(static_cast<const uchar *>(address), [size](const uchar *data) {
+        munmap(const_cast<uchar *>(data), static_cast<size_t>(size));
+    });
+    madvise(address, static_cast<size_t>(size), MADV_SEQUENTIAL);
+#endif
+    mapped = mapping.get();
+    mappedSize = size;
+}
+
+File::~File() {
+    try {
+        close();
+    } catch (const std::exception &) {
+        //ошибку записи при уничтожении некому сообщить
+    }
+}
+
+const char *File::typeName() const {
+    if (!binary) return "TextIOWrapper";
+    return writable ? "BufferedWriter" : "BufferedReader";
+}
+
+QString File::repr() const {
+    QString result = "<_io.";
+    result += typeName();
+    result += " name='" + name + "' mode='" + mode + "'";
+    if (!file) result += " closed";
+    return result + ">";
+}
+
+void File::requireOpen(const char *method, const bool writing) const {
+    if (!file) throw std::runtime_error("I/O operation on closed file");
+    if (writing && !writable) throw std::runtime_error(std::string(method) + "(): file not open for writing");
+    if (!writing && writable) throw std::runtime_error(std::string(method) + "(): file not open for reading");
+}
+
+/**
+ * Для отображённого файла возвращает весь остаток. Иначе дочитывает блоки в buffer, пока данных
+ * меньше want; прочитанная часть буфера при этом отбрасывается.
+ */
+std::string_view File::available(const size_t want) {
+    if (mapped) return {reinterpret_cast<const char *>(mapped + position), static_cast<size_t>(mappedSize - position)};
+    while (buffer.size() - start < want && !eof) {
+        buffer.erase(0, start);
+        start = 0;
+        const size_t filled = buffer.size();
+        buffer.resize(filled + bufferSize);
+        const qint64 count = file->read(buffer.data() + filled, static_cast<qint64>(bufferSize));
+        buffer.resize(filled + static_cast<size_t>(std::max<qint64>(count, 0)));
+        if (count < 0) throw std::runtime_error(file->errorString().toStdString());
+        if (count == 0) eof = true;
+    }
+    return {buffer.data() + start, buffer.size() - start};
+}
+
+size_t File::lineLength() {
+    size_t scanned = 0;
+    for (;;) {
+        const std::string_view rest = available(scanned + 1);
+        if (const void *newline = std::memchr(rest.data() + scanned, '\n', rest.size() - scanned)) {
+            return static_cast<size_t>(static_cast<const char *>(newline) - rest.data()) + 1;
+        }
+        if (mapped || eof) return rest.size();
+        scanned = rest.size();
+    }
+}
+
+/**
+ * Сдвигает позицию чтения. Прочитанные страницы отображения освобождаются каждые 64 МиБ:
+ * при повторном обращении (через memoryview) они снова читаются из файла.
+ */
+void File::consume(const size_t size) {
+    if (!mapped) {
+        start += size;
+        return;
+    }
+    position += static_cast<qint64>(size);
+#ifndef _WIN32
+    constexpr qint64 releaseStep = 64 << 20;
+    if (position - released >= releaseStep) {
+        const qint64 page = sysconf(_SC_PAGESIZE);
+        const qint64 end = position / page * page;
+        madvise(const_cast<uchar *>(mapped) + released, static_cast<size_t>(end - released), MADV_DONTNEED);
+        released = end;
+    }
+#endif
+}
+
+Value File::decoded(const std::string_view bytes) const {
+    if (binary) return Value(std::make_shared<Bytes>(std::string(bytes), false));
+    return Value(Bytes::decode(bytes.data(), static_cast<qsizetype>(bytes.size()), "utf-8"));
+}
+
+/**
+ * В текстовом режиме size символов занимают не больше 4 * size байт UTF-8: столько данных
+ * запрашивается, а затем отсчитываются целые символы.
+ */
+Value File::read(const qint64 size) {
+    requireOpen("read", false);
+    size_t length;
+    std::string_view rest;
+    if (size < 0) {
+        rest = available(std::numeric_limits<size_t>::max());
+        length = rest.size();
+    } else if (binary) {
+        rest = available(static_cast<size_t>(size));
+        length = std::min(static_cast<size_t>(size), rest.size());
+    } else {
+        rest = available(static_cast<size_t>(size) * 4);
+        length = 0;
+        for (qint64 chars = 0; chars < size && length < rest.size(); ++chars) {
+            length += sequenceLength(static_cast<unsigned char>(rest[length]));
+        }
+        length = std::min(length, rest.size());
+    }
+    Value result = decoded(rest.substr(0, length));
+    consume(length);
+    return result;
+}
+
+Value File::readLine() {
+    requireOpen("readline", false);
+    const size_t length = lineLength();
+    Value result = decoded(available(length).substr(0, length));
+    consume(length);
+    return result;
+}
+
+/**
+ * Строка отображённого файла не копируется: буфер memoryview ссылается на отображение и удерживает его.
+ * Строка файла, читаемого блоками, копируется в отдельный объект `bytes`, так как буфер блоков переиспользуется.
+ */
+Value File::lineView() {
+    requireOpen("lineview", false);
+    const size_t length = lineLength();
+    Buffer view;
+    if (mapped) {
+        view.owner = mapping;
+        view.data = mapped + position;
+    } else {
+        const auto copy = std::make_shared<Bytes>(std::string(available(length).substr(0, length)), false);
+        view.owner = copy;
+        view.data = reinterpret_cast<const uchar *>(copy->data.data());
+    }
+    view.length = static_cast<qsizetype>(length);
+    consume(length);
+    return Value(std::make_shared<MemoryView>(std::move(view)));
+}
+
+/**
+ * Данные из буфера блоков или отображения копируются в target; если буфер блоков пуст, данные
+ * читаются из файла прямо в target, без промежуточного копирования.
+ */
+qint64 File::readInto(const Buffer &target) {
+    requireOpen("readinto", false);
+    if (target.readOnly) throw std::runtime_error("readinto() argument must be read-write bytes-like object");
+    if (!target.isContiguous() || target.itemSize != 1) {
+        throw std::runtime_error("readinto() argument must be a contiguous byte buffer");
+    }
+    if (target.length == 0) return 0;
+    char *out = reinterpret_cast<char *>(target.writablePointer(0));
+
+    if (!mapped && start == buffer.size() && !eof) {
+        const qint64 count = file->read(out, target.length);
+        if (count < 0) throw std::runtime_error(file->errorString().toStdString());
+        if (count == 0) eof = true;
+        return count;
+    }
+    const std::string_view rest = available(0);
+    const size_t length = std::min(static_cast<size_t>(target.length), rest.size());
+    std::memcpy(out, rest.data(), length);
+    consume(length);
+    return static_cast<qint64>(length);
+}
+
+/**
+ * Данные не меньше буфера записи записываются сразу, минуя его.
+ */
+qint64 File::write(const Value &data) {
+    requireOpen("write", true);
+    std::string encoded;
+    std::string_view bytes;
+    qint64 count;
+    const auto *str = std::get_if<Value::StringPtr>(&data.data);
+    if (!binary) {
+        if (!str) throw std::runtime_error("write() argument must be str");
+        encoded = Bytes::encode((*str)->flatten(), "utf-8");
+        bytes = encoded;
+        count = (*str)->length();
+    } else {
+        if (str) throw std::runtime_error("a bytes-like object is required, not 'str'");
+        const Buffer buffer = Buffer::of(data);
+        if (!buffer.isContiguous() || buffer.itemSize != 1) {
+            throw std::runtime_error("write() argument must be a contiguous byte buffer");
+        }
+        bytes = {reinterpret_cast<const char *>(buffer.data), static_cast<size_t>(buffer.length)};
+        count = buffer.length;
+    }
+
+    if (pending.size() + bytes.size() > bufferSize) flush();
+    if (bytes.size() >= bufferSize) writeAll(*file, bytes.data(), bytes.size());
+    else pending += bytes;
+    return count;
+}
+
+void File::flush() {
+    if (!file) throw std::runtime_error("I/O operation on closed file");
+    const std::string data = std::exchange(pending, {});
+    writeAll(*file, data.data(), data.size());
+}
+
+/**
+ * Закрывает файл; повторное закрытие ничего не делает. Если запись буфера завершилась ошибкой,
+ * файл всё равно закрывается, а ошибка передаётся вызывающему коду.
+ */
+void File::close() {
+    if (!file) return;
+    const std::string data = std::exchange(pending, {});
+    const std::shared_ptr<QFile> closing = std::exchange(file, nullptr);
+    mapping.reset();
+    mapped = nullptr;
+    buffer.clear();
+    start = 0;
+    writeAll(*closing, data.data(), data.size());
+}
+
+/**
+ * Вызывает встроенный метод файла.
+ *
+ * @param self Файл, для которого вызывается метод.
+ * @param name Имя метода.
+ * @param args Вычисленные аргументы вызова.
+ * @return Результат метода.
+ * @throws std::runtime_error Если метода с таким именем нет или вызов завершился ошибкой.
+ */
+Value File::call(File &self, const QString &name, const std::vector<Value> &args) {
+    const auto &table = methods();
+    const auto it = table.find(name);
+    if (it == table.end()) {
+        throw std::runtime_error(std::string("'") + self.typeName() + "' object has no attribute '" + name.toStdString() + "'");
+    }
+    return it->second(self, args);
+}
+
+/**
+ * Возвращает таблицу встроенных методов файла, индексированную по имени метода.
+ */
+const std::unordered_map<QString, File::Method> &File::methods() {
+    static const std::unordered_map<QString, Method> table = {
+        {"read", methodRead},
+        {"readline", methodReadLine},
+        {"readlines", methodReadLines},
+        {"lineview", methodLineView},
+        {"readinto", methodReadInto},
+        {"write", methodWrite},
+        {"flush", methodFlush},
+        {"close", methodClose},
+    };
+    return table;
+}
@@ -0,0 +1,136 @@
+#include "Frozen.h"
+#include "Coroutine.h"
+#include "File.h"
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    /**
+     * Область памяти замороженных объектов: блоки выделяются по 1 МиБ и никогда не освобождаются.
+     */
+    class Heap {
+    public:
+        static constexpr size_t blockSize = 1 << 20;
+
+        void *allocate(const size_t size, const size_t alignment) {
+            std::lock_guard lock(mutex);
+            size_t offset = (used + alignment - 1) / alignment * alignment;
+            if (blocks.empty() || offset + size > blockCapacity) {
+                blockCapacity = std::max(blockSize, size);
+                blocks.push_back(std::make_unique<std::byte[]>(blockCapacity));
+                offset = 0;
+            }
+            used = offset + size;
+            total += size;
+            return blocks.back().get() + offset;
+        }
+
+        size_t bytes() {
+            std::lock_guard lock(mutex);
+            return total;
+        }
+
+    private:
+        std::mutex mutex;
+        std::vector<std::unique_ptr<std::byte[]>> blocks;
+        size_t blockCapacity = 0;
+        size_t used = 0;
+        size_t total = 0;
+    };
+
+    Heap &heap() {
+        static Heap &instance = *new Heap; //не уничтожается: объекты области доступны до завершения процесса
+        return instance;
+    }
+
+    /**
+     * Создаёт объект T в области; возвращаемый указатель не владеет объектом и не имеет счётчика ссылок.
+     */
+    template <typename T, typename... Args>
+    std::shared_ptr<T> allocate(Args &&...args) {
+        T *object = new (heap().allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        return std::shared_ptr<T>(std::shared_ptr<T>(), object);
+    }
+
+    template <typename T>
+    bool isImmortal(const std::shared_ptr<T> &ptr) {
+        return ptr && ptr.use_count() == 0;
+    }
+
+    /**
+     * Обход графа с сохранением разделяемых подграфов и циклов: контейнер добавляется в memo
+     * до заморозки элементов.
+     */
+    class Freezer {
+    public:
+        Value freeze(const Value &value) {
+            if (Frozen::isFrozen(value)) return value;
+            if (const auto *str = std::get_if<Value::StringPtr>(&value.data)) return remember(str->get(), [&] {
+                auto frozen = allocate<Rope>((*str)->flatten());
+                (void)frozen->flatten().hash();
+                return Value(Value::StringPtr(frozen));
+            });
+            if (const auto *bytes = std::get_if<Value::BytesPtr>(&value.data)) return remember(bytes->get(), [&] {
+                return Value(allocate<Bytes>((*bytes)->data, false));
+            });
+            if (const auto *list = std::get_if<Value::ListPtr>(&value.data)) {
+                if (const auto it = memo.find(list->get()); it != memo.end()) return it->second;
+                auto frozen = allocate<Value::List>();
+                Value result;
+                result.data = frozen;
+                memo.emplace(list->get(), result);
+                frozen->reserve((*list)->size());
+                for (const Value &item : **list) frozen->push_back(freeze(item));
+                return result;
+            }
+            if (const auto *dict = std::get_if<Value::DictPtr>(&value.data)) {
+                if (const auto it = memo.find(dict->get()); it != memo.end()) return it->second;
+                auto frozen = allocate<Value::Dict>();
+                Value result;
+                result.data = frozen;
+                memo.emplace(dict->get(), result);
+                frozen->reserve((*dict)->size());
+                for (auto it = (*dict)->cbegin(); it != (*dict)->cend(); ++it) frozen->insert(it.key(), freeze(it.value()));
+                return result;
+            }
+            if (std::holds_alternative<Value::FunctionPtr>(value.data)) throw std::runtime_error("cannot freeze function");
+            if (const auto *awaitable = std::get_if<Value::AwaitablePtr>(&value.data)) {
+                throw std::runtime_error(std::string("cannot freeze ") + (*awaitable)->typeName());
+            }
+            if (const auto *file = std::get_if<Value::FilePtr>(&value.data)) {
+                throw std::runtime_error(std::string("cannot freeze ") + (*file)->typeName());
+            }
+            throw std::runtime_error("cannot freeze memoryview");
+        }
+
+    private:
+        template <typename F>
+        Value remember(const void *original, F &&create) {
+            if (const auto it = memo.find(original); it != memo.end()) return it->second;
+            return memo.emplace(original, create()).first->second;
+        }
+
+        std::unordered_map<const void *, Value> memo;
+    };
+}
+
+Value Frozen::freeze(const Value &value) {
+    return Freezer().freeze(value);
+}
+
+bool Frozen::isFrozen(const Value &value) {
+    return std::visit([](const auto &data) {
+        using T = std::decay_t<decltype(data)>;
+        if constexpr (std::is_same_v<T, int> || std::is_same_v<T, double> || std::is_same_v<T, bool>) return true;
+        else return isImmortal(data);
+    }, value.data);
+}
+
+size_t Frozen::heapBytes() {
+    return heap().bytes();
+}
@@ -0,0 +1,350 @@
+#include "GreenScheduler.h"
+#include "EventLoop.h"
+#include "ModuleCache.h"
+#include "Output.h"
+#include "Parser.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <ucontext.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+#include <unistd.h>
+#endif
+
+struct GreenScheduler::Task {
+    GreenScheduler *scheduler = nullptr;
+    SubInterpreter::Program program;
+    SubInterpreter::Bindings inputs;
+    std::promise<SubInterpreter::Result> result;
+    bool started = false;
+    bool finished = false;
+    bool parked = false; //задача ждёт в wait
+    int waitFd = -1;
+    std::chrono::steady_clock::time_point deadline;
+
+    std::uint64_t steps = 0; //шаги завершённых квантов
+    std::int64_t slice = 0; //размер текущего кванта
+    bool carried = false; //задача вытеснена в точке переключения: шаг, вызвавший вытеснение, выполнится в следующем кванте
+    std::chrono::steady_clock::duration elapsed{}; //длительность завершённых квантов
+    std::chrono::steady_clock::time_point sliceStart;
+
+    //состояние потока, принадлежащее задаче, пока она не выполняется
+    std::string *output = nullptr;
+    int depth = 0;
+    const char *stackLimit = nullptr;
+    EventLoop *loop = nullptr;
+    LoopStates *loops = nullptr;
+    std::function<void(std::shared_ptr<ASTNode> &, Environment &)> prepare;
+
+#ifdef _WIN32
+    void *fiber = nullptr;
+#else
+    ucontext_t context{};
+    void *stack = nullptr;
+    std::size_t mappedSize = 0;
+#endif
+};
+
+namespace {
+    /**
+     * Меняет местами состояние потока и состояние, сохранённое задачей: вызывается при входе в задачу
+     * и при возврате из неё.
+     */
+    void exchangeThreadState(std::string *&output, int &depth, const char *&stackLimit, EventLoop *&loop,
+                             LoopStates *&loops, std::function<void(std::shared_ptr<ASTNode> &, Environment &)> &prepare) {
+        output = Output::redirect(output);
+        loop = EventLoop::exchangeCurrent(loop);
+        loops = LoopStates::exchangeCurrent(loops);
+        std::swap(FunctionNode::depth, depth);
+        std::swap(FunctionNode::stackLimit, stackLimit);
+        std::swap(ModuleCache::prepare, prepare);
+    }
+}
+
+GreenScheduler::Options &GreenScheduler::options() {
+    static Options settings;
+    return settings;
+}
+
+bool GreenScheduler::parseFlag(const QString &flag) {
+    auto number = [&flag](const QString &prefix) {
+        bool ok = false;
+        const int value = flag.mid(prefix.length()).toInt(&ok);
+        if (!ok || value <= 0) throw std::runtime_error("Invalid value for " + prefix.toStdString());
+        return value;
+    };
+
+    Options &settings = options();
+    if (flag.startsWith("--green-quantum=")) settings.quantum = number("--green-quantum=");
+    else if (flag.startsWith("--task-steps=")) settings.maxSteps = static_cast<std::uint64_t>(number("--task-steps="));
+    else if (flag.startsWith("--task-time=")) settings.maxTime = std::chrono::milliseconds(number("--task-time="));
+    else if (flag.startsWith("--task-stack=")) {
+        settings.stackSize = static_cast<std::size_t>(number("--task-stack=")) * 1024;
+        if (settings.stackSize < minStackSize) {
+            throw std::runtime_error("--task-stack must be at least " + std::to_string(minStackSize / 1024) + " KiB");
+        }
+    }
+    else return false;
+    return true;
+}
+
+GreenScheduler::GreenScheduler(Options settings) : settings(settings) {}
+
+GreenScheduler::~GreenScheduler() {
+    for (const auto &task : ready) release(*task);
+    for (const auto &task : waiting) release(*task);
+#ifdef __linux__
+    if (epoll >= 0) ::close(epoll);
+#endif
+}
+
+std::future<SubInterpreter::Result> GreenScheduler::spawn(SubInterpreter::Program program, SubInterpreter::Bindings inputs) {
+    auto task = std::make_unique<Task>();
+    task->scheduler = this;
+    task->program = std::move(program);
+    task->inputs = std::move(inputs);
+    auto future = task->result.get_future();
+    ready.push_back(std::move(task));
+    return future;
+}
+
+/**
+ * Задачи выполняются по кругу: задача, исчерпавшая квант, встаёт в конец очереди. Перед каждым квантом
+ * проверяются ожидающие задачи: без ожидания, если очередь не пуста, иначе с блокировкой.
+ */
+void GreenScheduler::run() {
+    if (inTask()) throw std::runtime_error("GreenScheduler::run() cannot be called from a task");
+#ifdef _WIN32
+    const bool converted = !IsThreadAFiber();
+    context = converted ? ConvertThreadToFiber(nullptr) : GetCurrentFiber();
+#else
+    ucontext_t threadContext{};
+    context = &threadContext;
+#endif
+
+    while (!ready.empty() || !waiting.empty()) {
+        if (!waiting.empty()) wake(ready.empty());
+        if (ready.empty()) continue;
+        std::unique_ptr<Task> task = std::move(ready.front());
+        ready.pop_front();
+        resume(*task);
+        if (task->finished) release(*task);
+        else if (task->parked) park(std::move(task));
+        else ready.push_back(std::move(task));
+    }
+
+#ifdef _WIN32
+    if (converted) ConvertFiberToThread();
+#endif
+    context = nullptr;
+}
+
+/**
+ * Передаёт управление задаче на один квант. Стек создаётся при первом запуске; если его не удалось
+ * выделить, задача завершается ошибкой, не начав выполнение.
+ */
+void GreenScheduler::resume(Task &task) {
+    if (!task.started) {
+        task.started = true;
+#ifdef _WIN32
+        task.fiber = CreateFiberEx(0, stackSize(), 0, [](void *) { enter(); }, nullptr);
+        const bool allocated = task.fiber != nullptr;
+#else
+        const auto page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const std::size_t size = (stackSize() + page - 1) / page * page + page;
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+        flags |= MAP_NORESERVE; //страницы стека выделяются по мере использования
+#endif
+        void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        const bool allocated = memory != MAP_FAILED;
+        if (allocated) {
+            mprotect(memory, page, PROT_NONE); //сторожевая страница: переполнение стека не портит чужую память
+            task.stack = memory;
+            task.mappedSize = size;
+            getcontext(&task.context);
+            task.context.uc_stack.ss_sp = static_cast<char *>(memory) + page;
+            task.context.uc_stack.ss_size = size - page;
+            task.context.uc_link = static_cast<ucontext_t *>(context);
+            makecontext(&task.context, enter, 0);
+        }
+#endif
+        if (!allocated) {
+            task.result.set_value({1, {}, "cannot allocate task stack"});
+            task.finished = true;
+            return;
+        }
+    }
+
+    task.slice = settings.quantum;
+    if (settings.maxSteps != 0) {
+        task.slice = static_cast<std::int64_t>(std::min<std::uint64_t>(task.slice, settings.maxSteps - task.steps));
+    }
+    exchangeThreadState(task.output, task.depth, task.stackLimit, task.loop, task.loops, task.prepare);
+    current = &task;
+    budget = task.carried ? task.slice - 1 : task.slice; //вызвавший вытеснение шаг относится к этому кванту
+    task.sliceStart = std::chrono::steady_clock::now();
+#ifdef _WIN32
+    SwitchToFiber(task.fiber);
+#else
+    swapcontext(static_cast<ucontext_t *>(context), &task.context);
+#endif
+    current = nullptr;
+    budget = std::numeric_limits<std::int64_t>::max();
+    exchangeThreadState(task.output, task.depth, task.stackLimit, task.loop, task.loops, task.prepare);
+}
+
+/**
+ * Регистрирует дескриптор ожидающей задачи в epoll планировщика. Если это не удалось, задача остаётся
+ * в очереди и проверяет события в каждом своём кванте.
+ */
+void GreenScheduler::park(std::unique_ptr<Task> task) {
+#ifdef __linux__
+    if (epoll < 0) epoll = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = task.get();
+    if (epoll >= 0 && epoll_ctl(epoll, EPOLL_CTL_ADD, task->waitFd, &event) == 0) {
+        waiting.push_back(std::move(task));
+        return;
+    }
+#endif
+    task->parked = false;
+    ready.push_back(std::move(task));
+}
+
+/**
+ * При block == true ждёт, пока дескриптор одной из задач не станет готов, но не дольше ближайшего срока.
+ */
+void GreenScheduler::wake(const bool block) {
+#ifdef __linux__
+    int timeout = 0;
+    if (block) {
+        const auto deadline = std::min_element(waiting.begin(), waiting.end(), [](const auto &a, const auto &b) {
+            return a->deadline < b->deadline;
+        })->get()->deadline;
+        if (deadline == std::chrono::steady_clock::time_point::max()) timeout = -1;
+        else {
+            const auto delay = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            timeout = static_cast<int>(std::clamp<std::chrono::milliseconds::rep>(delay.count(), 0, INT_MAX));
+        }
+    }
+
+    epoll_event events[64];
+    const int count = epoll_wait(epoll, events, 64, timeout);
+    for (int i = 0; i < count; ++i) static_cast<Task *>(events[i].data.ptr)->parked = false;
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = waiting.begin(); it != waiting.end();) {
+        Task &task = **it;
+        if (task.parked && task.deadline > now) {
+            ++it;
+            continue;
+        }
+        task.parked = false;
+        epoll_ctl(epoll, EPOLL_CTL_DEL, task.waitFd, nullptr);
+        ready.push_back(std::move(*it));
+        it = waiting.erase(it);
+    }
+#else
+    static_cast<void>(block);
+#endif
+}
+
+std::size_t GreenScheduler::stackSize() const {
+    return std::max(settings.stackSize, minStackSize);
+}
+
+void GreenScheduler::release(Task &task) {
+#ifdef _WIN32
+    if (task.fiber) DeleteFiber(task.fiber);
+    task.fiber = nullptr;
+#else
+    if (task.stack) munmap(task.stack, task.mappedSize);
+    task.stack = nullptr;
+#endif
+}
+
+/**
+ * Квант текущей задачи исчерпан: учитываются его шаги и время, после чего задача либо завершается
+ * ошибкой (исключение раскручивает её стек до `SubInterpreter::run`), либо уступает поток.
+ * Вытеснение происходит в шаге slice + 1, поэтому за квант выполняется ровно slice шагов,
+ * а вызвавший вытеснение шаг выполняется в следующем кванте.
+ */
+void GreenScheduler::preempt() {
+    if (!current) {
+        budget = std::numeric_limits<std::int64_t>::max();
+        return;
+    }
+    suspend(static_cast<std::uint64_t>(current->slice), true);
+}
+
+bool GreenScheduler::canYield() {
+    return current && !current->scheduler->ready.empty();
+}
+
+/**
+ * Задача, возобновлённый шаг которой засчитан в квант (carried), к моменту вызова выполнила
+ * slice - budget шагов, как и задача, начавшая квант с полным бюджетом.
+ */
+void GreenScheduler::yield() {
+    if (!canYield()) return;
+    suspend(static_cast<std::uint64_t>(current->slice - std::max<std::int64_t>(budget, 0)), false);
+}
+
+/**
+ * Задача уступает поток, как в yield, но возвращается в очередь только после завершения ожидания (см. `wake`).
+ */
+void GreenScheduler::wait(const int fd, const std::chrono::steady_clock::time_point deadline) {
+    if (!current) return;
+    current->parked = true;
+    current->waitFd = fd;
+    current->deadline = deadline;
+    suspend(static_cast<std::uint64_t>(current->slice - std::max<std::int64_t>(budget, 0)), false);
+}
+
+void GreenScheduler::suspend(const std::uint64_t consumed, const bool carried) {
+    Task *task = current;
+    const Options &limits = task->scheduler->settings;
+    task->steps += consumed;
+    task->elapsed += std::chrono::steady_clock::now() - task->sliceStart;
+    task->slice = 0;
+    task->carried = carried;
+    budget = 0; //при раскрутке стека каждая следующая точка переключения снова завершает задачу
+    if (limits.maxSteps != 0 && task->steps >= limits.maxSteps) {
+        throw std::runtime_error("task exceeded step limit (" + std::to_string(limits.maxSteps) + " steps)");
+    }
+    if (limits.maxTime.count() != 0 && task->elapsed >= limits.maxTime) {
+        throw std::runtime_error("task exceeded time limit (" + std::to_string(limits.maxTime.count()) + " ms)");
+    }
+
+#ifdef _WIN32
+    SwitchToFiber(task->scheduler->context);
+#else
+    swapcontext(&task->context, static_cast<ucontext_t *>(task->scheduler->context));
+#endif
+}
+
+/**
+ * Выполняет программу текущей задачи на её стеке. После возврата управление переходит
+ * в `run` (через uc_link или переключение волокна).
+ */
+void GreenScheduler::enter() {
+    Task &task = *current;
+    const char top = 0;
+    FunctionNode::stackLimit = reinterpret_cast<const char *>(
+        reinterpret_cast<std::uintptr_t>(&top) - (task.scheduler->stackSize() - stackReserve));
+    task.result.set_value(SubInterpreter::run(task.program, task.inputs));
+    task.finished = true;
+#ifdef _WIN32
+    SwitchToFiber(task.scheduler->context); //функция волокна не должна возвращать управление
+#endif
+}
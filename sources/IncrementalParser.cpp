@@ -0,0 +1,102 @@
+#include "IncrementalParser.h"
+#include "AstTraversal.h"
+#include "Parser.h"
+
+/**
+ * Определяет протяжённость инструкции по токенам отступов: простая инструкция заканчивается
+ * переводом строки, составная — DEDENT своего блока, если за ним не следует `elif`/`else`.
+ * Перевод строки после ':' заголовка, за которым следует INDENT, открывает блок и инструкцию
+ * не завершает. DEDENT охватывающего блока и конец файла также завершают инструкцию.
+ *
+ * @return Ключ — типы и значения токенов инструкции.
+ */
+QString StatementCache::key(const QVector<Token> &tokens, const int start, int &end) {
+    const auto continuesBranch = [&tokens](const int i) {
+        return i < tokens.size() && tokens[i].type == TOKEN_KEYWORD &&
+               (tokens[i].value == "elif" || tokens[i].value == "else");
+    };
+    const auto opensBlock = [&tokens, start](const int i) {
+        return i > start && tokens[i - 1].type == TOKEN_OP && tokens[i - 1].value == ":" &&
+               i + 1 < tokens.size() && tokens[i + 1].type == TOKEN_INDENT;
+    };
+
+    int depth = 0;
+    end = start;
+    while (end < tokens.size()) {
+        const LexTokenType type = tokens[end].type;
+        if (type == TOKEN_EOF || (depth == 0 && ((type == TOKEN_NEWLINE && !opensBlock(end)) || type == TOKEN_DEDENT))) break;
+        if (type == TOKEN_INDENT) ++depth;
+        ++end;
+        if (type == TOKEN_DEDENT && --depth == 0 && !continuesBranch(end)) break;
+    }
+
+    QString result;
+    for (int i = start; i < end; ++i) {
+        result += QChar(u'0' + tokens[i].type);
+        result += tokens[i].value;
+        result += QChar(u'\x1f');
+    }
+    return result;
+}
+
+std::shared_ptr<ASTNode> StatementCache::find(const QString &key) const {
+    const auto it = statements.find(key);
+    return it == statements.end() ? nullptr : it->second;
+}
+
+void StatementCache::store(const QString &key, std::shared_ptr<ASTNode> statement) {
+    if (statements.size() >= maxEntries) statements.clear();
+    statements[key] = std::move(statement);
+}
+
+/**
+ * Разбирает текст с кэшем инструкций и возвращает копию результата: кэшированные деревья
+ * остаются неизменными, когда копия оптимизируется и выполняется.
+ */
+std::shared_ptr<ASTNode> IncrementalParser::parse(const QString &source) {
+    const QVector<Token> tokens = tokenize(source);
+    return AstTraversal::clone(Parser(tokens, &statements).parseModule());
+}
+
+/**
+ * Собирает поток токенов из токенов отдельных строк. Перевод строки, INDENT и DEDENT добавляются
+ * теми же функциями, что и в `Lexer::tokenize`.
+ */
+QVector<Token> IncrementalParser::tokenize(const QString &source) {
+    const QStringList sourceLines = source.split('\n');
+    if (lines.size() + static_cast<size_t>(sourceLines.size()) > maxLines) lines.clear();
+
+    QVector<Token> tokens;
+    QVector<int> indentStack = {0};
+    for (qsizetype i = 0; i < sourceLines.size(); ++i) {
+        const int lineNumber = static_cast<int>(i) + 1;
+        const LineTokens *line = lexLine(sourceLines[i]);
+        if (!line) return Lexer().tokenize(source);
+
+        if (i > 0) Lexer::appendLayout(tokens, indentStack, line->indent, lineNumber);
+        for (const Token &token : line->tokens) {
+            tokens.push_back(Token(token.type, token.value, lineNumber + token.line - 1));
+        }
+    }
+    Lexer::appendEnd(tokens, indentStack, static_cast<int>(sourceLines.size()));
+    return tokens;
+}
+
+/**
+ * Возвращает токены строки text, лексируя её только при первой встрече.
+ *
+ * @return Токены строки или nullptr, если строку нельзя лексировать отдельно от остального текста.
+ */
+const IncrementalParser::LineTokens *IncrementalParser::lexLine(const QString &text) {
+    if (const auto it = lines.find(text); it != lines.end()) return &it->second;
+
+    LineTokens line;
+    try {
+        line.tokens = Lexer().tokenize(text);
+    } catch (const std::runtime_error &) {
+        return nullptr; //литерал продолжается на другой строке или ошибка: решает обычный лексер
+    }
+    line.tokens.pop_back(); //EOF
+    line.indent = Lexer::measureIndent(text, 0);
+    return &lines.emplace(text, std::move(line)).first->second;
+}
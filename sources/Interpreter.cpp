@@ -1,9 +1,21 @@
 #ifdef _WIN32
 #include <windows.h>
+#else
+#include <unistd.h>
 #endif
 #include "Interpreter.h"
+#include "GreenScheduler.h"
+#include "IncrementalParser.h"
 #include "Lexer.h"
+#include "Output.h"
 #include "Parser.h"
+#include "SubInterpreter.h"
+#include "TypeInference.h"
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+#include <exception>
 #include <iostream>
 #include <sstream>
 
@@ -44,16 +56,144 @@ struct PromptLine {
     std::string prompt;  // ">>> " или "... "
     std::string buffer;  // введённый текст
 };
-#endif
 
 COORD getCursorPosition() {
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
     return csbi.dwCursorPosition;
 }
+#endif
+
+/**
+ * Проверяет, выводит ли REPL результат инструкции ast: присваивания, `import`, `def` и вызов `print` ничего не выводят.
+ */
+static bool echoesResult(const ASTNode *ast) {
+    if (const auto *call = dynamic_cast<const CallNode *>(ast)) return call->name != "print";
+    return !dynamic_cast<const AssignNode *>(ast) &&
+           !dynamic_cast<const AugAssignNode *>(ast) &&
+           !dynamic_cast<const ImportNode *>(ast) &&
+           !dynamic_cast<const FunctionNode *>(ast);
+}
+
+/**
+ * Выполняет проходы анализа и оптимизации над разобранным деревом перед его выполнением в окружении env.
+ */
+void Interpreter::optimize(std::shared_ptr<ASTNode> &ast, Environment &env) {
+    passManager.run(ast, env);
+}
+
+/**
+ * Выполняет файл path целиком без приглашения, истории и настройки консоли. Разобранное дерево
+ * берётся из кэша модулей (см. `ModuleCache`), если исходный файл не изменился.
+ *
+ * @return Код завершения процесса: 0 при успешном выполнении, 1 при ошибке чтения, разбора или выполнения.
+ */
+int Interpreter::runScript(const QString &path) {
+    Environment env;
+    try {
+        auto ast = ModuleCache::load(path);
+        optimize(ast, env);
+        ast->eval(env);
+    } catch (const std::exception& e) {
+        Output::flush();
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Выполняет скрипты paths одновременно, каждый в собственном экземпляре интерпретатора
+ * (см. `SubInterpreter`): в пуле потоков или, если green, в текущем потоке как задачи
+ * `GreenScheduler`. Модули ищутся в каталогах всех скриптов. Вывод скриптов печатается
+ * целиком в порядке аргументов, ошибки — в stderr с путём скрипта.
+ *
+ * @return 0, если все скрипты выполнены успешно, иначе 1
+ */
+int Interpreter::runScripts(const std::vector<QString> &paths, const bool green) {
+    for (const QString &path : paths) {
+        const QString directory = QFileInfo(path).absolutePath();
+        if (std::find(ModuleCache::searchPath.begin(), ModuleCache::searchPath.end(), directory) == ModuleCache::searchPath.end()) {
+            ModuleCache::searchPath.push_back(directory);
+        }
+    }
+
+    GreenScheduler scheduler;
+    std::vector<std::future<SubInterpreter::Result>> results;
+    std::vector<QString> loadErrors(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        try {
+            const auto program = SubInterpreter::compile(paths[i]);
+            results.push_back(green ? scheduler.spawn(program) : SubInterpreter::start(program));
+        } catch (const std::exception& e) {
+            results.emplace_back();
+            loadErrors[i] = QString::fromUtf8(e.what());
+        }
+    }
+    scheduler.run();
+
+    int status = 0;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const SubInterpreter::Result result = results[i].valid() ? results[i].get()
+                                                                 : SubInterpreter::Result{1, {}, loadErrors[i]};
+        Output::write(result.output);
+        if (result.status != 0) {
+            Output::flush();
+            std::cerr << paths[i].toStdString() << ": Error: " << result.error.toStdString() << "\n";
+            status = 1;
+        }
+    }
+    return status;
+}
 
+void Interpreter::printStatistics() const {
+    Output::flush();
+    if (Jit::options().printStats) std::cerr << Jit::stats().toStdString() << "\n";
+    if (PassManager::timePasses) std::cerr << passManager.timingReport().toStdString();
+}
+
+int Interpreter::run(int argc, char* argv[]) {
+    QString scriptPath;
+    bool parallel = false;
+    bool green = false;
+    for (int i = 1; i < argc; ++i) {
+        if (argv[i][0] != '-') {
+            scriptPath = QString::fromLocal8Bit(argv[i]); //остальные аргументы относятся к скрипту
+            if (parallel || green) {
+                std::vector<QString> paths;
+                for (int j = i; j < argc; ++j) paths.push_back(QString::fromLocal8Bit(argv[j]));
+                const int status = runScripts(paths, green);
+                printStatistics();
+                return status;
+            }
+            break;
+        }
+        if (std::strcmp(argv[i], "-j") == 0) {
+            parallel = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "-g") == 0) {
+            green = true;
+            continue;
+        }
+        try {
+            if (!Jit::parseFlag(argv[i]) && !TypeInference::parseFlag(argv[i]) && !PassManager::parseFlag(argv[i]) &&
+                !ModuleCache::parseFlag(argv[i]) && !GreenScheduler::parseFlag(argv[i])) {
+                std::cerr << "Unknown option: " << argv[i] << "\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+        }
+    }
+    passManager = PassManager::forLevel(PassManager::optimizationLevel);
+    ModuleCache::prepare = [this](std::shared_ptr<ASTNode> &ast, Environment &env) { optimize(ast, env); };
+    ModuleCache::searchPath = {scriptPath.isEmpty() ? QDir::currentPath() : QFileInfo(scriptPath).absolutePath()};
+    if (!scriptPath.isEmpty()) {
+        const int status = runScript(scriptPath);
+        printStatistics();
+        return status;
+    }
 
-void Interpreter::run(int argc, char* argv[]) {
 #ifdef _WIN32
     // Настройка консоли
     ConsoleModeGuard consoleGuard;
@@ -67,6 +207,7 @@ void Interpreter::run(int argc, char* argv[]) {
     }
 #endif
 
+
     std::cout
       << "Hello and welcome to my minimal Python interpreter!\n"
          "Made by Semenov Oleg, with care from MathMech. Let's code!\n";
@@ -115,6 +256,7 @@ void Interpreter::run(int argc, char* argv[]) {
     newPrompt(">>> ");
     Environment env;
     Lexer lexer;
+    IncrementalParser blockParser;
 
     INPUT_RECORD rec;
     DWORD read;
@@ -317,10 +459,14 @@ if (vk == VK_RETURN) {
         editingHistory = false;
         // выполняем блок
         try {
-            auto tokens = lexer.tokenize(QString::fromStdString(block));
-            auto ast = Parser(tokens).parse();
+            //Блоки часто повторно вызываются из истории и редактируются: неизменённые строки
+            //и инструкции не лексируются и не разбираются заново
+            auto ast = blockParser.parse(QString::fromStdString(block));
+            optimize(ast, env);
             ast->eval(env);
-        } catch (const std::runtime_error& e) {
+            Output::flush();
+        } catch (const std::exception& e) {
+            Output::flush();
             std::cout << "\nError: " << e.what();
         }
         // сбрасываем состояние блока
@@ -342,13 +488,15 @@ if (vk == VK_RETURN) {
         try {
             auto tokens = lexer.tokenize(QString::fromStdString(line));
             auto ast = Parser(tokens).parse();
+            optimize(ast, env);
             auto result = ast->eval(env);
-            if (!result.toString().isEmpty() &&
-                !dynamic_cast<AssignNode*>(ast.get()))
-            {
-                std::cout << "\n" << result.toString().toStdString();
+            if (echoesResult(ast.get())) {
+                Output::write("\n");
+                Output::writeRepr(result);
             }
-        } catch (const std::runtime_error& e) {
+            Output::flush();
+        } catch (const std::exception& e) {
+            Output::flush();
             std::cout << "\nError: " << e.what() << "\n";
         }
 
@@ -479,21 +627,54 @@ if (vk == VK_BACK) {
     }
 #else
     // fallback
+    Environment env;
+    Lexer lexer;
+    IncrementalParser blockParser;
     std::string line;
-    while (std::getline(std::cin, line)) {
-        if (line == "exit" || line == "quit" || line == "q") break;
+    std::string block; //накапливаемый блок (строка, оканчивающаяся на ':', и её тело до пустой строки)
+
+    auto execute = [&](const std::string &source, const bool printResult) {
         try {
-            auto tokens = lexer.tokenize(QString::fromStdString(line));
-            auto ast = Parser(tokens).parse();
+            auto ast = printResult ? Parser(lexer.tokenize(QString::fromStdString(source))).parse()
+                                   : blockParser.parse(QString::fromStdString(source));
+            optimize(ast, env);
             auto result = ast->eval(env);
-            if (!result.toString().isEmpty() &&
-                !dynamic_cast<AssignNode*>(ast.get()))
-            {
-                std::cout << result.toString().toStdString() << "\n";
+            if (printResult && echoesResult(ast.get())) {
+                Output::writeRepr(result);
+                Output::write("\n");
             }
-        } catch (const std::runtime_error& e) {
-            std::cout << "Error: " << e.what() << "\n";
+        } catch (const std::exception& e) {
+            Output::write("Error: ");
+            Output::write(e.what());
+            Output::write("\n");
         }
+    };
+
+    //При вводе с терминала вывод сбрасывается перед ожиданием каждой строки, при вводе из файла
+    //или канала — только при заполнении буфера и при завершении
+    const bool interactive = isatty(STDIN_FILENO);
+    while (true) {
+        if (interactive) Output::flush();
+        if (!std::getline(std::cin, line)) break;
+        if (!block.empty()) {
+            if (!line.empty()) {
+                block += "\n" + line;
+                continue;
+            }
+            execute(block, false);
+            block.clear();
+            continue;
+        }
+        if (line == "exit" || line == "quit" || line == "q") break;
+        if (!line.empty() && line.back() == ':') {
+            block = line;
+            continue;
+        }
+        execute(line, true);
     }
+    if (!block.empty()) execute(block, false);
 #endif
-}
\ No newline at end of file
+
+    printStatistics();
+    return 0;
+}
@@ -0,0 +1,759 @@
+#include "Jit.h"
+#include "Parser.h"
+#include "X86Emitter.h"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+
+#ifdef MYPYTHON_JIT
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+using Reg = X86Emitter::Reg;
+using Condition = X86Emitter::Condition;
+using SlotType = CompiledLoop::SlotType;
+
+/**
+ * @class JitCompiler
+ * @brief Переводит цикл `while` в машинный код x86-64.
+ *
+ * Компиляция выполняется в два прохода. Анализ обходит цикл, назначает каждой переменной ячейку
+ * кадра с типом из окружения и проверяет, что каждое выражение имеет известный примитивный тип,
+ * а присваивания не меняют тип переменной. Генерация кода обходит дерево повторно: результат
+ * выражения помещается в eax (int, bool) или xmm0 (double), правый операнд — в ecx или xmm1.
+ * Наиболее часто используемые переменные размещаются в регистрах на всё время работы цикла.
+ *
+ * Регистр rdi указывает на кадр, rbp хранит указатель стека на входе, поэтому выход в интерпретатор
+ * возможен из любой точки, в том числе при промежуточных значениях на стеке.
+ */
+class JitCompiler {
+public:
+    explicit JitCompiler(Environment &env) : env(env) {}
+
+    /**
+     * @brief Компилирует цикл
+     * @return Описание кадра и машинный код или std::nullopt, если цикл не поддерживается
+     */
+    std::optional<std::pair<CompiledLoop, std::vector<std::uint8_t>>> compile(const WhileNode &loop);
+
+private:
+    struct Slot {
+        SlotType type;
+        bool written = false;
+        int uses = 0;
+        int reg = -1; //регистр общего назначения (int, bool) или номер xmm (double); -1 — ячейка кадра
+    };
+
+    //Регистры для переменных: caller-saved идут первыми, так как их не нужно сохранять в прологе
+    static constexpr Reg intRegisters[] = {
+        X86Emitter::R8, X86Emitter::R9, X86Emitter::R10, X86Emitter::R11, X86Emitter::RSI,
+        X86Emitter::RBX, X86Emitter::R12, X86Emitter::R13, X86Emitter::R14, X86Emitter::R15
+    };
+    static constexpr int firstXmmRegister = 2; //xmm0, xmm1 — операнды, xmm15 — вспомогательный
+    static constexpr int lastXmmRegister = 14;
+    static constexpr int scratchXmm = 15;
+
+    //Анализ
+    bool analyzeStatements(const std::vector<std::shared_ptr<ASTNode>> &statements);
+    bool analyzeStatement(const ASTNode *node);
+    std::optional<SlotType> typeOf(const ASTNode *node);
+    int slotFor(const QString &name);
+
+    //Генерация кода
+    void allocateRegisters();
+    [[nodiscard]] std::int32_t slotOffset(const int slot) const { return 8 * slot; }
+    [[nodiscard]] std::int32_t shadowOffset(const int slot) const { return 8 * (static_cast<int>(slots.size()) + slot); }
+    void emitLoad(int slot, Reg intTarget, int xmmTarget);
+    void emitStore(int slot);
+    void emitStatements(const std::vector<std::shared_ptr<ASTNode>> &statements);
+    void emitStatement(const ASTNode *node);
+    SlotType emitExpr(const ASTNode *node);
+    void emitLeaf(const ASTNode *node, Reg intTarget, int xmmTarget);
+    void emitOperands(const BinOpNode *node, bool asDouble);
+    void emitArithmetic(const BinOpNode *node, BinOpNode::Operation op, SlotType resultType);
+
+    /**
+     * Результат сравнения во флагах процессора: условие истинности и обработка неупорядоченного
+     * результата (NaN) при сравнении double.
+     */
+    struct Test {
+        Condition condition;
+        int unordered; //0 — учтено условием, -1 — ложь при NaN, 1 — истина при NaN
+    };
+    Test emitComparison(const BinOpNode *node, BinOpNode::Operation op);
+    void emitJumpIfFalse(const ASTNode *node, X86Emitter::Label falseLabel);
+
+    static bool isComparison(BinOpNode::Operation op);
+    static Condition invert(const Condition condition) { return static_cast<Condition>(condition ^ 1); }
+
+    Environment &env;
+    std::vector<QString> names;
+    std::vector<Slot> slots;
+    std::unordered_map<QString, int> slotIndex;
+    X86Emitter x86;
+    X86Emitter::Label bailLabel = -1;
+};
+
+int JitCompiler::slotFor(const QString &name) {
+    if (const auto it = slotIndex.find(name); it != slotIndex.end()) return it->second;
+    const Value *value = env.find(name);
+    if (!value) return -1;
+
+    SlotType type;
+    if (std::holds_alternative<int>(value->data)) type = SlotType::Int;
+    else if (std::holds_alternative<double>(value->data)) type = SlotType::Double;
+    else if (std::holds_alternative<bool>(value->data)) type = SlotType::Bool;
+    else return -1;
+
+    slots.push_back({type});
+    names.push_back(name);
+    return slotIndex[name] = static_cast<int>(slots.size() - 1);
+}
+
+bool JitCompiler::isComparison(const BinOpNode::Operation op) {
+    using Op = BinOpNode::Operation;
+    return op == Op::Equal || op == Op::NotEqual || op == Op::Greater ||
+           op == Op::GreaterEqual || op == Op::Less || op == Op::LessEqual;
+}
+
+/**
+ * Определяет тип выражения. Типы операций повторяют числовые обработчики `BinaryDispatch`;
+ * операции, которые интерпретатор выполняет иначе чем над числами (строки, bool в арифметике,
+ * возведение в степень, `//` и `%` над double), не поддерживаются.
+ */
+std::optional<SlotType> JitCompiler::typeOf(const ASTNode *node) {
+    if (const auto *temp = dynamic_cast<const TempNode *>(node)) return typeOf(temp->expr.get());
+    if (const auto *value = dynamic_cast<const ValueNode *>(node)) {
+        if (std::holds_alternative<int>(value->value.data)) return SlotType::Int;
+        if (std::holds_alternative<double>(value->value.data)) return SlotType::Double;
+        if (std::holds_alternative<bool>(value->value.data)) return SlotType::Bool;
+        return std::nullopt;
+    }
+    if (const auto *var = dynamic_cast<const VarNode *>(node)) {
+        const int slot = slotFor(var->name);
+        if (slot < 0) return std::nullopt;
+        ++slots[slot].uses;
+        return slots[slot].type;
+    }
+    if (const auto *bin = dynamic_cast<const BinOpNode *>(node)) {
+        const auto l = typeOf(bin->left.get());
+        const auto r = typeOf(bin->right.get());
+        if (!l || !r || *l == SlotType::Bool || *r == SlotType::Bool) return std::nullopt;
+
+        using Op = BinOpNode::Operation;
+        const Op op = BinOpNode::parseOperation(bin->op);
+        if (isComparison(op)) return SlotType::Bool;
+        const bool bothInt = *l == SlotType::Int && *r == SlotType::Int;
+        switch (op) {
+            case Op::Add:
+            case Op::Subtract:
+            case Op::Multiply: return bothInt ? SlotType::Int : SlotType::Double;
+            case Op::Divide: return SlotType::Double;
+            case Op::IntDivide:
+            case Op::Modulo: return bothInt ? std::optional(SlotType::Int) : std::nullopt;
+            default: return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+bool JitCompiler::analyzeStatements(const std::vector<std::shared_ptr<ASTNode>> &statements) {
+    return std::all_of(statements.begin(), statements.end(), [this](const auto &stmt) { return analyzeStatement(stmt.get()); });
+}
+
+bool JitCompiler::analyzeStatement(const ASTNode *node) {
+    if (const auto *assign = dynamic_cast<const AssignNode *>(node)) {
+        const auto type = typeOf(assign->valueExpr.get());
+        const int slot = slotFor(assign->varName);
+        if (!type || slot < 0 || slots[slot].type != *type) return false;
+        slots[slot].written = true;
+        ++slots[slot].uses;
+        return true;
+    }
+    if (const auto *aug = dynamic_cast<const AugAssignNode *>(node)) {
+        const auto type = typeOf(&aug->binOp);
+        const int slot = slotFor(aug->varName);
+        if (!type || slot < 0 || slots[slot].type != *type) return false;
+        slots[slot].written = true;
+        return true;
+    }
+    if (const auto *branch = dynamic_cast<const IfNode *>(node)) {
+        if (!typeOf(branch->condition.get()) || !analyzeStatements(branch->body)) return false;
+        for (const auto &[condition, body] : branch->elifs) {
+            if (!typeOf(condition.get()) || !analyzeStatements(body)) return false;
+        }
+        return analyzeStatements(branch->elseBody);
+    }
+    if (const auto *loop = dynamic_cast<const WhileNode *>(node)) {
+        return typeOf(loop->condition.get()) && analyzeStatements(loop->body);
+    }
+    return typeOf(node).has_value();
+}
+
+/**
+ * Размещает переменные в регистрах в порядке убывания числа обращений к ним.
+ */
+void JitCompiler::allocateRegisters() {
+    std::vector<int> order(slots.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+    std::stable_sort(order.begin(), order.end(), [this](const int a, const int b) { return slots[a].uses > slots[b].uses; });
+
+    size_t nextInt = 0;
+    int nextXmm = firstXmmRegister;
+    for (const int i : order) {
+        if (slots[i].type == SlotType::Double) {
+            if (nextXmm <= lastXmmRegister) slots[i].reg = nextXmm++;
+        } else if (nextInt < std::size(intRegisters)) {
+            slots[i].reg = intRegisters[nextInt++];
+        }
+    }
+}
+
+void JitCompiler::emitLoad(const int slot, const Reg intTarget, const int xmmTarget) {
+    const Slot &s = slots[slot];
+    if (s.type == SlotType::Double) {
+        if (s.reg >= 0) x86.movsdRegReg(xmmTarget, s.reg);
+        else x86.movsdRegMem(xmmTarget, X86Emitter::RDI, slotOffset(slot));
+    } else {
+        if (s.reg >= 0) x86.movRegReg(intTarget, static_cast<Reg>(s.reg));
+        else x86.movRegMem(intTarget, X86Emitter::RDI, slotOffset(slot));
+    }
+}
+
+void JitCompiler::emitStore(const int slot) {
+    const Slot &s = slots[slot];
+    if (s.type == SlotType::Double) {
+        if (s.reg >= 0) x86.movsdRegReg(s.reg, 0);
+        else x86.movsdMemReg(X86Emitter::RDI, slotOffset(slot), 0);
+    } else {
+        if (s.reg >= 0) x86.movRegReg(static_cast<Reg>(s.reg), X86Emitter::RAX);
+        else x86.movMemReg(X86Emitter::RDI, slotOffset(slot), X86Emitter::RAX);
+    }
+}
+
+/**
+ * Загружает лист выражения (константу или переменную) непосредственно в регистр правого операнда,
+ * не используя стек.
+ */
+void JitCompiler::emitLeaf(const ASTNode *node, const Reg intTarget, const int xmmTarget) {
+    if (const auto *value = dynamic_cast<const ValueNode *>(node)) {
+        const auto &data = value->value.data;
+        if (std::holds_alternative<double>(data)) {
+            std::uint64_t bits;
+            const double number = std::get<double>(data);
+            std::memcpy(&bits, &number, sizeof bits);
+            x86.movRegImm64(intTarget, bits);
+            x86.movqXmmReg(xmmTarget, intTarget);
+        } else {
+            x86.movRegImm32(intTarget, std::holds_alternative<int>(data) ? std::get<int>(data) : std::get<bool>(data));
+        }
+        return;
+    }
+    emitLoad(slotIndex.at(static_cast<const VarNode *>(node)->name), intTarget, xmmTarget);
+}
+
+/**
+ * Вычисляет операнды бинарной операции: левый — в eax/xmm0, правый — в ecx/xmm1.
+ * Если asDouble, целые операнды преобразуются в double. Составной правый операнд вычисляется
+ * первым и сохраняется на стеке на время вычисления левого.
+ */
+void JitCompiler::emitOperands(const BinOpNode *node, const bool asDouble) {
+    const ASTNode *right = node->right.get();
+    const bool rightIsLeaf = dynamic_cast<const ValueNode *>(right) || dynamic_cast<const VarNode *>(right);
+    SlotType rightType;
+
+    if (rightIsLeaf) {
+        const SlotType leftType = emitExpr(node->left.get());
+        if (asDouble && leftType == SlotType::Int) x86.cvtsi2sd(0, X86Emitter::RAX);
+        rightType = *typeOf(right);
+        emitLeaf(right, X86Emitter::RCX, 1);
+    } else {
+        rightType = emitExpr(right);
+        if (rightType == SlotType::Double) x86.movqRegXmm(X86Emitter::RAX, 0);
+        x86.push(X86Emitter::RAX);
+        const SlotType leftType = emitExpr(node->left.get());
+        if (asDouble && leftType == SlotType::Int) x86.cvtsi2sd(0, X86Emitter::RAX);
+        x86.pop(X86Emitter::RCX);
+        if (rightType == SlotType::Double) x86.movqXmmReg(1, X86Emitter::RCX);
+    }
+    if (asDouble && rightType == SlotType::Int) x86.cvtsi2sd(1, X86Emitter::RCX);
+}
+
+void JitCompiler::emitArithmetic(const BinOpNode *node, const BinOpNode::Operation op, const SlotType resultType) {
+    using Op = BinOpNode::Operation;
+    if (resultType == SlotType::Int) {
+        emitOperands(node, false);
+        switch (op) {
+            //при переполнении интерпретатор переходит к double: итерация повторяется в интерпретаторе
+            case Op::Add:
+                x86.addRegReg(X86Emitter::RAX, X86Emitter::RCX);
+                x86.jcc(X86Emitter::Overflow, bailLabel);
+                break;
+            case Op::Subtract:
+                x86.subRegReg(X86Emitter::RAX, X86Emitter::RCX);
+                x86.jcc(X86Emitter::Overflow, bailLabel);
+                break;
+            case Op::Multiply:
+                x86.imulRegReg(X86Emitter::RAX, X86Emitter::RCX);
+                x86.jcc(X86Emitter::Overflow, bailLabel);
+                break;
+            case Op::IntDivide:
+                //idiv отбрасывает дробную часть, как целочисленное деление в BinaryDispatch; INT_MIN // -1
+                //не помещается в int (и вызывает исключение процессора), поэтому делитель -1 передаётся интерпретатору
+                x86.testRegReg(X86Emitter::RCX, X86Emitter::RCX);
+                x86.jcc(X86Emitter::Equal, bailLabel);
+                x86.cmpRegImm8(X86Emitter::RCX, -1);
+                x86.jcc(X86Emitter::Equal, bailLabel);
+                x86.cdq();
+                x86.idiv(X86Emitter::RCX);
+                break;
+            case Op::Modulo: {
+                //делитель -1 обрабатывается отдельно: idiv INT_MIN, -1 вызывает исключение процессора
+                const auto general = x86.newLabel();
+                const auto done = x86.newLabel();
+                x86.testRegReg(X86Emitter::RCX, X86Emitter::RCX);
+                x86.jcc(X86Emitter::Equal, bailLabel);
+                x86.cmpRegImm8(X86Emitter::RCX, -1);
+                x86.jcc(X86Emitter::NotEqual, general);
+                x86.movRegImm32(X86Emitter::RAX, 0);
+                x86.jmp(done);
+                x86.bind(general);
+                x86.cdq();
+                x86.idiv(X86Emitter::RCX);
+                x86.movRegReg(X86Emitter::RAX, X86Emitter::RDX);
+                x86.bind(done);
+                break;
+            }
+            default: break;
+        }
+        return;
+    }
+
+    emitOperands(node, true);
+    switch (op) {
+        case Op::Add: x86.addsd(0, 1); break;
+        case Op::Subtract: x86.subsd(0, 1); break;
+        case Op::Multiply: x86.mulsd(0, 1); break;
+        case Op::Divide: {
+            const auto nonZero = x86.newLabel();
+            x86.xorpd(scratchXmm, scratchXmm);
+            x86.ucomisd(1, scratchXmm);
+            x86.jcc(X86Emitter::Parity, nonZero);
+            x86.jcc(X86Emitter::Equal, bailLabel);
+            x86.bind(nonZero);
+            x86.divsd(0, 1);
+            break;
+        }
+        default: break;
+    }
+}
+
+/**
+ * Сравнивает операнды и возвращает условие истинности. Целые числа сравниваются как int,
+ * остальные — как double; для double условия подобраны так, что сравнение с NaN ложно
+ * (кроме `!=`), как и в интерпретаторе.
+ */
+JitCompiler::Test JitCompiler::emitComparison(const BinOpNode *node, const BinOpNode::Operation op) {
+    using Op = BinOpNode::Operation;
+    const bool asDouble = *typeOf(node->left.get()) == SlotType::Double || *typeOf(node->right.get()) == SlotType::Double;
+    emitOperands(node, asDouble);
+
+    if (!asDouble) {
+        x86.cmpRegReg(X86Emitter::RAX, X86Emitter::RCX);
+        switch (op) {
+            case Op::Equal: return {X86Emitter::Equal, 0};
+            case Op::NotEqual: return {X86Emitter::NotEqual, 0};
+            case Op::Greater: return {X86Emitter::Greater, 0};
+            case Op::GreaterEqual: return {X86Emitter::GreaterEqual, 0};
+            case Op::Less: return {X86Emitter::Less, 0};
+            default: return {X86Emitter::LessEqual, 0};
+        }
+    }
+    switch (op) {
+        case Op::Less: x86.ucomisd(1, 0); return {X86Emitter::Above, 0};
+        case Op::LessEqual: x86.ucomisd(1, 0); return {X86Emitter::AboveEqual, 0};
+        case Op::Greater: x86.ucomisd(0, 1); return {X86Emitter::Above, 0};
+        case Op::GreaterEqual: x86.ucomisd(0, 1); return {X86Emitter::AboveEqual, 0};
+        case Op::Equal: x86.ucomisd(0, 1); return {X86Emitter::Equal, -1};
+        default: x86.ucomisd(0, 1); return {X86Emitter::NotEqual, 1};
+    }
+}
+
+SlotType JitCompiler::emitExpr(const ASTNode *node) {
+    //значения, сохранённые оптимизатором во временных узлах, в машинном коде вычисляются заново
+    if (const auto *temp = dynamic_cast<const TempNode *>(node)) return emitExpr(temp->expr.get());
+    if (dynamic_cast<const ValueNode *>(node) || dynamic_cast<const VarNode *>(node)) {
+        emitLeaf(node, X86Emitter::RAX, 0);
+        return *typeOf(node);
+    }
+
+    const auto *bin = static_cast<const BinOpNode *>(node);
+    const BinOpNode::Operation op = BinOpNode::parseOperation(bin->op);
+    if (!isComparison(op)) {
+        const SlotType type = *typeOf(node);
+        emitArithmetic(bin, op, type);
+        return type;
+    }
+
+    const Test test = emitComparison(bin, op);
+    x86.setcc(test.condition, X86Emitter::RAX);
+    x86.movzxRegReg8(X86Emitter::RAX, X86Emitter::RAX);
+    if (test.unordered != 0) {
+        x86.setcc(test.unordered < 0 ? X86Emitter::NoParity : X86Emitter::Parity, X86Emitter::RCX);
+        x86.movzxRegReg8(X86Emitter::RCX, X86Emitter::RCX);
+        if (test.unordered < 0) x86.andRegReg(X86Emitter::RAX, X86Emitter::RCX);
+        else x86.orRegReg(X86Emitter::RAX, X86Emitter::RCX);
+    }
+    return SlotType::Bool;
+}
+
+/**
+ * Вычисляет условие и переходит на falseLabel, если оно ложно. Сравнения переводятся
+ * непосредственно в условный переход, без промежуточного значения bool.
+ */
+void JitCompiler::emitJumpIfFalse(const ASTNode *node, const X86Emitter::Label falseLabel) {
+    const auto *bin = dynamic_cast<const BinOpNode *>(node);
+    if (bin && isComparison(BinOpNode::parseOperation(bin->op))) {
+        const Test test = emitComparison(bin, BinOpNode::parseOperation(bin->op));
+        if (test.unordered < 0) x86.jcc(X86Emitter::Parity, falseLabel);
+        if (test.unordered > 0) {
+            const auto isTrue = x86.newLabel();
+            x86.jcc(X86Emitter::Parity, isTrue);
+            x86.jcc(invert(test.condition), falseLabel);
+            x86.bind(isTrue);
+        } else {
+            x86.jcc(invert(test.condition), falseLabel);
+        }
+        return;
+    }
+
+    if (emitExpr(node) == SlotType::Double) {
+        const auto isTrue = x86.newLabel();
+        x86.xorpd(scratchXmm, scratchXmm);
+        x86.ucomisd(0, scratchXmm);
+        x86.jcc(X86Emitter::Parity, isTrue);
+        x86.jcc(X86Emitter::Equal, falseLabel);
+        x86.bind(isTrue);
+    } else {
+        x86.testRegReg(X86Emitter::RAX, X86Emitter::RAX);
+        x86.jcc(X86Emitter::Equal, falseLabel);
+    }
+}
+
+void JitCompiler::emitStatements(const std::vector<std::shared_ptr<ASTNode>> &statements) {
+    for (const auto &stmt : statements) emitStatement(stmt.get());
+}
+
+void JitCompiler::emitStatement(const ASTNode *node) {
+    if (const auto *assign = dynamic_cast<const AssignNode *>(node)) {
+        emitExpr(assign->valueExpr.get());
+        emitStore(slotIndex.at(assign->varName));
+        return;
+    }
+    if (const auto *aug = dynamic_cast<const AugAssignNode *>(node)) {
+        emitExpr(&aug->binOp);
+        emitStore(slotIndex.at(aug->varName));
+        return;
+    }
+    if (const auto *branch = dynamic_cast<const IfNode *>(node)) {
+        const auto end = x86.newLabel();
+        auto next = x86.newLabel();
+        emitJumpIfFalse(branch->condition.get(), next);
+        emitStatements(branch->body);
+        x86.jmp(end);
+        for (const auto &[condition, body] : branch->elifs) {
+            x86.bind(next);
+            next = x86.newLabel();
+            emitJumpIfFalse(condition.get(), next);
+            emitStatements(body);
+            x86.jmp(end);
+        }
+        x86.bind(next);
+        emitStatements(branch->elseBody);
+        x86.bind(end);
+        return;
+    }
+    if (const auto *loop = dynamic_cast<const WhileNode *>(node)) {
+        const auto top = x86.newLabel();
+        const auto exit = x86.newLabel();
+        x86.bind(top);
+        emitJumpIfFalse(loop->condition.get(), exit);
+        emitStatements(loop->body);
+        x86.jmp(top);
+        x86.bind(exit);
+        return;
+    }
+    emitExpr(node);
+}
+
+/**
+ * Компилирует цикл в функцию `int(int64_t *frame)`, возвращающую 0 при завершении цикла
+ * и 1 при выходе в интерпретатор.
+ */
+std::optional<std::pair<CompiledLoop, std::vector<std::uint8_t>>> JitCompiler::compile(const WhileNode &loop) {
+    if (!typeOf(loop.condition.get()) || !analyzeStatements(loop.body)) return std::nullopt;
+    allocateRegisters();
+
+    std::vector<Reg> saved = {X86Emitter::RBP};
+    for (const Slot &slot : slots) {
+        if (slot.type != SlotType::Double && slot.reg >= X86Emitter::RBX &&
+            (slot.reg == X86Emitter::RBX || slot.reg >= X86Emitter::R12)) {
+            saved.push_back(static_cast<Reg>(slot.reg));
+        }
+    }
+
+    for (const Reg reg : saved) x86.push(reg);
+    x86.movRegReg64(X86Emitter::RBP, X86Emitter::RSP);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].reg < 0) continue;
+        if (slots[i].type == SlotType::Double) x86.movsdRegMem(slots[i].reg, X86Emitter::RDI, slotOffset(static_cast<int>(i)));
+        else x86.movRegMem(static_cast<Reg>(slots[i].reg), X86Emitter::RDI, slotOffset(static_cast<int>(i)));
+    }
+
+    bailLabel = x86.newLabel();
+    const auto top = x86.newLabel();
+    const auto exit = x86.newLabel();
+    const auto epilogue = x86.newLabel();
+
+    //Начало итерации: копия изменяемых переменных для отката при выходе в интерпретатор
+    x86.bind(top);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        const int slot = static_cast<int>(i);
+        if (!slots[i].written) continue;
+        if (slots[i].reg < 0) {
+            x86.movRegMem64(X86Emitter::RAX, X86Emitter::RDI, slotOffset(slot));
+            x86.movMemReg64(X86Emitter::RDI, shadowOffset(slot), X86Emitter::RAX);
+        } else if (slots[i].type == SlotType::Double) {
+            x86.movsdMemReg(X86Emitter::RDI, shadowOffset(slot), slots[i].reg);
+        } else {
+            x86.movMemReg(X86Emitter::RDI, shadowOffset(slot), static_cast<Reg>(slots[i].reg));
+        }
+    }
+    emitJumpIfFalse(loop.condition.get(), exit);
+    emitStatements(loop.body);
+    x86.jmp(top);
+
+    x86.bind(exit);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].reg < 0 || !slots[i].written) continue;
+        if (slots[i].type == SlotType::Double) x86.movsdMemReg(X86Emitter::RDI, slotOffset(static_cast<int>(i)), slots[i].reg);
+        else x86.movMemReg(X86Emitter::RDI, slotOffset(static_cast<int>(i)), static_cast<Reg>(slots[i].reg));
+    }
+    x86.movRegImm32(X86Emitter::RAX, 0);
+    x86.jmp(epilogue);
+
+    x86.bind(bailLabel);
+    x86.movRegImm32(X86Emitter::RAX, 1);
+
+    x86.bind(epilogue);
+    x86.movRegReg64(X86Emitter::RSP, X86Emitter::RBP);
+    for (auto it = saved.rbegin(); it != saved.rend(); ++it) x86.pop(*it);
+    x86.ret();
+    x86.finalize();
+
+    CompiledLoop compiled;
+    compiled.slotNames = names;
+    for (const Slot &slot : slots) {
+        compiled.slotTypes.push_back(slot.type);
+        compiled.slotWritten.push_back(slot.written);
+    }
+    return std::make_pair(std::move(compiled), x86.code());
+}
+
+CodeCache::~CodeCache() {
+    for (const auto &block : blocks) release(*block);
+}
+
+/**
+ * Копирует машинный код в новый участок памяти и делает его исполняемым.
+ * Если кеш заполнен, предварительно вытесняются блоки, которые дольше всего не использовались.
+ *
+ * @param code Машинный код.
+ * @return Блок кода или nullptr, если размещение невозможно.
+ */
+std::shared_ptr<CodeBlock> CodeCache::install(const std::vector<std::uint8_t> &code) {
+#ifdef MYPYTHON_JIT
+    const auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t size = (code.size() + pageSize - 1) / pageSize * pageSize;
+    if (size > capacity) return nullptr;
+    while (used + size > capacity && !blocks.empty()) evictOne();
+
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return nullptr;
+    std::memcpy(memory, code.data(), code.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return nullptr;
+    }
+
+    auto block = std::make_shared<CodeBlock>();
+    block->memory = memory;
+    block->size = size;
+    touch(*block);
+    used += size;
+    blocks.push_back(block);
+    return block;
+#else
+    return nullptr;
+#endif
+}
+
+void CodeCache::release(CodeBlock &block) {
+    if (!block.isValid()) return;
+#ifdef MYPYTHON_JIT
+    munmap(block.memory, block.size);
+#endif
+    used -= block.size;
+    block.memory = nullptr;
+}
+
+void CodeCache::evictOne() {
+    const auto victim = std::min_element(blocks.begin(), blocks.end(), [](const auto &a, const auto &b) {
+        return a->lastUse < b->lastUse;
+    });
+    release(**victim);
+    blocks.erase(victim);
+    ++evictions;
+}
+
+JitOptions &Jit::options() {
+    static JitOptions jitOptions;
+    return jitOptions;
+}
+
+CodeCache &Jit::codeCache() {
+    static thread_local CodeCache cache(options().codeCacheSize);
+    return cache;
+}
+
+/**
+ * Разбирает флаг командной строки JIT-компилятора:
+ * `--jit`, `--jit-threshold=N`, `--jit-max-bailouts=N`, `--jit-cache-size=KiB`, `--jit-stats`.
+ *
+ * @param flag Аргумент командной строки.
+ * @return true, если аргумент является флагом JIT-компилятора.
+ * @throws std::runtime_error Если значение флага не является положительным числом.
+ */
+bool Jit::parseFlag(const QString &flag) {
+    auto number = [&flag](const QString &prefix) {
+        bool ok = false;
+        const int value = flag.mid(prefix.length()).toInt(&ok);
+        if (!ok || value <= 0) throw std::runtime_error("Invalid value for " + prefix.toStdString());
+        return value;
+    };
+
+    JitOptions &jit = options();
+    if (flag == "--jit") jit.enabled = true;
+    else if (flag == "--jit-stats") jit.printStats = true;
+    else if (flag.startsWith("--jit-threshold=")) jit.hotLoopThreshold = number("--jit-threshold=");
+    else if (flag.startsWith("--jit-max-bailouts=")) jit.maxBailouts = number("--jit-max-bailouts=");
+    else if (flag.startsWith("--jit-cache-size=")) jit.codeCacheSize = static_cast<std::size_t>(number("--jit-cache-size=")) * 1024;
+    else return false;
+    return true;
+}
+
+/**
+ * Компилирует цикл и размещает его код в кеше.
+ *
+ * @param loop Цикл, ставший горячим.
+ * @param env Окружение, по значениям которого определяются типы переменных.
+ * @return Скомпилированный цикл или nullptr.
+ */
+std::shared_ptr<CompiledLoop> Jit::compile(const WhileNode &loop, Environment &env) {
+#ifdef MYPYTHON_JIT
+    auto result = JitCompiler(env).compile(loop);
+    if (!result) {
+        ++rejectedLoops;
+        return nullptr;
+    }
+    codeCache().setCapacity(options().codeCacheSize);
+    auto compiled = std::make_shared<CompiledLoop>(std::move(result->first));
+    compiled->code = codeCache().install(result->second);
+    if (!compiled->code) {
+        ++rejectedLoops;
+        return nullptr;
+    }
+    ++compiledLoops;
+    return compiled;
+#else
+    ++rejectedLoops;
+    return nullptr;
+#endif
+}
+
+/**
+ * Проверяет типы переменных, распаковывает их в кадр, выполняет машинный код и записывает
+ * изменённые переменные обратно в окружение. При выходе в интерпретатор переменные
+ * восстанавливаются из копии на начало итерации.
+ *
+ * @param loop Скомпилированный цикл.
+ * @param env Окружение выполнения.
+ * @return Результат выполнения (см. RunResult).
+ */
+Jit::RunResult Jit::run(CompiledLoop &loop, Environment &env) {
+    if (!loop.code || !loop.code->isValid()) return RunResult::Evicted;
+
+    const size_t n = loop.slotNames.size();
+    std::vector<std::int64_t> frame(2 * n);
+    std::vector<Value *> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        //Изменяемые переменные записываются обратно, поэтому должны быть локальными:
+        //глобальные переменные функция только читает
+        Value *value = loop.slotWritten[i] ? env.findLocal(loop.slotNames[i]) : env.find(loop.slotNames[i]);
+        if (!value) {
+            ++loop.bailouts;
+            return RunResult::NotEntered;
+        }
+        const auto &data = value->data;
+        switch (loop.slotTypes[i]) {
+            case CompiledLoop::SlotType::Int:
+                if (!std::holds_alternative<int>(data)) { ++loop.bailouts; return RunResult::NotEntered; }
+                frame[i] = std::get<int>(data);
+                break;
+            case CompiledLoop::SlotType::Double:
+                if (!std::holds_alternative<double>(data)) { ++loop.bailouts; return RunResult::NotEntered; }
+                std::memcpy(&frame[i], &std::get<double>(data), sizeof(double));
+                break;
+            case CompiledLoop::SlotType::Bool:
+                if (!std::holds_alternative<bool>(data)) { ++loop.bailouts; return RunResult::NotEntered; }
+                frame[i] = std::get<bool>(data);
+                break;
+        }
+        values[i] = value;
+    }
+
+    codeCache().touch(*loop.code);
+    const auto function = reinterpret_cast<int (*)(std::int64_t *)>(loop.code->memory);
+    const bool bailedOut = function(frame.data()) != 0;
+
+    for (size_t i = 0; i < n; ++i) {
+        if (!loop.slotWritten[i]) continue;
+        const std::int64_t raw = bailedOut ? frame[n + i] : frame[i];
+        switch (loop.slotTypes[i]) {
+            case CompiledLoop::SlotType::Int:
+                *values[i] = Value(static_cast<int>(static_cast<std::int32_t>(static_cast<std::uint32_t>(raw))));
+                break;
+            case CompiledLoop::SlotType::Double: {
+                double number;
+                std::memcpy(&number, &raw, sizeof number);
+                *values[i] = Value(number);
+                break;
+            }
+            case CompiledLoop::SlotType::Bool:
+                *values[i] = Value(static_cast<std::uint32_t>(raw) != 0);
+                break;
+        }
+    }
+
+    if (!bailedOut) return RunResult::Finished;
+    ++loop.bailouts;
+    ++bailouts;
+    return RunResult::Bailout;
+}
+
+QString Jit::stats() {
+    return QString("JIT: %1 loops compiled, %2 rejected, %3 bailouts, %4 bytes of code, %5 evictions")
+        .arg(compiledLoops.load()).arg(rejectedLoops.load()).arg(bailouts.load()).arg(codeCache().usedBytes()).arg(codeCache().evictions);
+}
@@ -1,4 +1,5 @@
 #include "Lexer.h"
+#include "Atoms.h"
 // #include <iostream>
 
 /**
@@ -14,39 +15,38 @@
  */
 QVector<Token> Lexer::tokenize(const QString& code) {
     QVector<Token> tokens;
-    pos = 0; //текущая позиция в коде
-    line = 1;
-    column = 1;
     indentStack.clear();
     indentStack.push_back(0);
 
-    while (pos < code.length()) {
-        QChar ch = code[pos];
-        if (ch == '\n') {
-            tokens.push_back(Token(TOKEN_NEWLINE, "", line));
-            pos++;
-            line++;
-            column = 1;
+    //Отступ первой строки не учитывается; каждая следующая строка начинается после перевода строки,
+    //завершившего предыдущую
+    int begin = 0;
+    int lineNumber = 1;
+    while (true) {
+        int end;
+        tokens.append(tokenizeLine(code, begin, lineNumber, end));
+        if (end >= code.length()) break;
 
-            int spaceCount = 0;
-            int tmpPos = pos;
-            while (tmpPos < code.length() && code[tmpPos] == ' ') {
-                spaceCount++;
-                tmpPos++;
-            }
-            if (spaceCount > indentStack.last()) {
-                indentStack.append(spaceCount);
-                tokens.push_back(Token(TOKEN_INDENT, "", line));
-            } else if (spaceCount < indentStack.last()) {
-                while (spaceCount < indentStack.last()) {
-                    indentStack.pop_back();
-                    tokens.push_back(Token(TOKEN_DEDENT, "", line));
-                }
-            }
-            pos = tmpPos;
-            continue;
-        }
+        begin = end + 1;
+        lineNumber = line + 1;
+        appendLayout(tokens, indentStack, measureIndent(code, begin), lineNumber);
+    }
+
+    appendEnd(tokens, indentStack, line);
+    return tokens;
+}
+
+/**
+ * Лексирует содержимое строки до перевода строки, не входящего в литерал. Пробелы в начале
+ * строки пропускаются: отступ учитывается отдельно (см. measureIndent и appendLayout).
+ */
+QVector<Token> Lexer::tokenizeLine(const QString& code, const int begin, const int firstLine, int& end) {
+    QVector<Token> tokens;
+    pos = begin;
+    line = firstLine;
+    column = 1;
 
+    while (pos < code.length() && code[pos] != '\n') {
         Token token = nextToken(code);
         // std::cout << "Token: " << token.value.toStdString() << " Type: " << convenientDemoTokenTypes[token.type].toStdString() << " Pos: " << pos << '\n';
 
@@ -54,18 +54,51 @@ QVector<Token> Lexer::tokenize(const QString& code) {
             break;
         }
 
-        if (!token.value.isEmpty()) {
+        if (!token.value.isEmpty() || token.type == TOKEN_STRING || token.type == TOKEN_BYTES) {
             tokens.append(token);
         }
     }
 
+    end = pos;
+    return tokens;
+}
+
+Lexer::Indent Lexer::measureIndent(const QString& code, const int begin) {
+    Indent indent;
+    int tmpPos = begin;
+    while (tmpPos < code.length() && code[tmpPos] == ' ') {
+        indent.width++;
+        tmpPos++;
+    }
+    //Пустая строка или строка из одного комментария не меняет уровень отступа
+    indent.blank = tmpPos >= code.length() || code[tmpPos] == '\n' || code[tmpPos] == '\r' || code[tmpPos] == '#';
+    return indent;
+}
+
+void Lexer::appendLayout(QVector<Token>& tokens, QVector<int>& indentStack, const Indent indent, const int lineNumber) {
+    //Несколько переводов строки подряд (пустые строки) дают один токен
+    if (tokens.isEmpty() || tokens.last().type != TOKEN_NEWLINE) {
+        tokens.push_back(Token(TOKEN_NEWLINE, "", lineNumber - 1));
+    }
+    if (indent.blank) return;
+
+    if (indent.width > indentStack.last()) {
+        indentStack.append(indent.width);
+        tokens.push_back(Token(TOKEN_INDENT, "", lineNumber));
+    } else {
+        while (indent.width < indentStack.last()) {
+            indentStack.pop_back();
+            tokens.push_back(Token(TOKEN_DEDENT, "", lineNumber));
+        }
+    }
+}
+
+void Lexer::appendEnd(QVector<Token>& tokens, QVector<int>& indentStack, const int lastLine) {
     while (indentStack.size() > 1) {
         indentStack.pop_back();
-        tokens.push_back(Token(TOKEN_DEDENT, "", line));
+        tokens.push_back(Token(TOKEN_DEDENT, "", lastLine));
     }
-
-    tokens.push_back(Token(TOKEN_EOF, "", line));
-    return tokens;
+    tokens.push_back(Token(TOKEN_EOF, "", lastLine));
 }
 
 /**
@@ -86,6 +119,9 @@ Token Lexer::nextToken(const QString& code) {
     if (pos >= code.length()) {
         return {TOKEN_EOF, "", line};
     }
+    if (code[pos] == '\n') {
+        return {TOKEN_NEWLINE, "", line}; //перевод строки обрабатывает tokenize
+    }
 
     const QChar ch = code[pos];
 
@@ -95,6 +131,9 @@ Token Lexer::nextToken(const QString& code) {
     if (ch == '\"' || ch == '\'') {
         return readString(code);
     }
+    if ((ch == 'b' || ch == 'B') && pos + 1 < code.length() && (code[pos + 1] == '\"' || code[pos + 1] == '\'')) {
+        return readBytes(code);
+    }
     if (ch.isLetter() || ch == '_') {
         return readIdentifierOrBool(code);
     }
@@ -103,7 +142,9 @@ Token Lexer::nextToken(const QString& code) {
 
 /**
  * Читает числовой литерал из исходного кода и возвращает соответствующий токен.
- * Этот метод поддерживает как целые числа, так и числа с плавающей запятой.
+ * Этот метод поддерживает целые числа, числа с плавающей запятой и экспонентой (`1.5e-3`),
+ * литералы с префиксами `0x`, `0o`, `0b` и символы `_` между цифрами. Корректность литерала
+ * проверяет парсер (см. `NumberFormat::parseLiteral`).
  *
  * @param code Строка, представляющая входной исходный код.
  *
@@ -112,8 +153,26 @@ Token Lexer::nextToken(const QString& code) {
  */
 Token Lexer::readNumber(const QString& code) {
     const int start = pos;
-    while (pos < code.length() && (code[pos].isDigit() || code[pos] == '.')) {
-        pos++;
+    const auto at = [&code](const int i) { return i < code.length() ? code[i] : QChar(); };
+
+    const QChar prefix = at(pos + 1).toLower();
+    if (code[pos] == '0' && (prefix == 'x' || prefix == 'o' || prefix == 'b')) {
+        pos += 2;
+        while (pos < code.length() && (code[pos].isLetterOrNumber() || code[pos] == '_')) {
+            pos++;
+        }
+    } else {
+        while (pos < code.length() && (code[pos].isDigit() || code[pos] == '.' || code[pos] == '_')) {
+            pos++;
+        }
+        const QChar sign = at(pos + 1);
+        if ((at(pos) == 'e' || at(pos) == 'E') &&
+            (sign.isDigit() || ((sign == '+' || sign == '-') && at(pos + 2).isDigit()))) {
+            pos += 2;
+            while (pos < code.length() && (code[pos].isDigit() || code[pos] == '_')) {
+                pos++;
+            }
+        }
     }
     QString num = code.mid(start, pos - start);
     return {TOKEN_NUMBER, num, line};
@@ -153,6 +212,72 @@ Token Lexer::readString(const QString& code) {
     return {TOKEN_STRING, str, line};
 }
 
+/**
+ * Считывает байтовый литерал (`b"..."` или `b'...'`) из указанного исходного кода.
+ * Литерал может содержать только ASCII-символы; экранирующие последовательности `\xNN`, `\n`, `\r`,
+ * `\t`, `\0`, `\\` и экранированные кавычки заменяются соответствующими байтами.
+ *
+ * @param code Исходный код, представленный в виде QString, из которого будет считан литерал.
+ *
+ * @return Token типа TOKEN_BYTES, значение которого содержит по одному символу (0..255) на каждый байт.
+ * @throws std::runtime_error Если литерал не закрыт, содержит не-ASCII символ или некорректную
+ *         последовательность `\x`.
+ */
+Token Lexer::readBytes(const QString& code) {
+    pos++; //префикс b
+    column++;
+    const QChar quote = code[pos];
+    pos++;
+    column++;
+
+    QString bytes;
+    while (pos < code.length() && code[pos] != quote) {
+        QChar ch = code[pos];
+        if (ch == '\n') {
+            throw std::runtime_error("Unterminated bytes literal");
+        }
+        if (ch.unicode() >= 0x80) {
+            throw std::runtime_error("bytes can only contain ASCII literal characters");
+        }
+        if (ch == '\\' && pos + 1 < code.length()) {
+            const QChar escaped = code[++pos];
+            if (escaped == 'x') {
+                bool ok = false;
+                const int byte = code.mid(pos + 1, 2).toInt(&ok, 16);
+                if (!ok || code.mid(pos + 1, 2).length() != 2) {
+                    throw std::runtime_error("invalid \\x escape in bytes literal");
+                }
+                ch = QChar(byte);
+                pos += 2;
+            } else if (escaped == 'n') {
+                ch = '\n';
+            } else if (escaped == 'r') {
+                ch = '\r';
+            } else if (escaped == 't') {
+                ch = '\t';
+            } else if (escaped == '0') {
+                ch = QChar(0);
+            } else if (escaped == '\\' || escaped == '\'' || escaped == '\"') {
+                ch = escaped;
+            } else {
+                bytes += '\\';
+                ch = escaped;
+            }
+        }
+        bytes += ch;
+        pos++;
+        column++;
+    }
+
+    if (pos >= code.length()) {
+        throw std::runtime_error("Unterminated bytes literal");
+    }
+
+    pos++;
+    column++;
+    return {TOKEN_BYTES, bytes, line};
+}
+
 /**
  * Читает идентификатор, ключевое слово или значение типа булево из кода.
  * Этот метод анализирует последовательность символов, начиная с текущей позиции,
@@ -163,14 +288,16 @@ Token Lexer::readString(const QString& code) {
  *
  * @return Объект типа Token, содержащий тип токена (TOKEN_ID, TOKEN_KEYWORD или TOKEN_BOOL),
  *         строковое значение токена и номер строки, в которой токен находится.
+ *         Значение интернировано (см. `Atoms`).
  */
 Token Lexer::readIdentifierOrBool(const QString& code) {
     const int start = pos;
-    while (pos < code.length() && (code[pos].isLetter() || code[pos] == '_')) {
+    while (pos < code.length() && (code[pos].isLetterOrNumber() || code[pos] == '_')) {
         pos++;
     }
-    QString id = code.mid(start, pos - start);
-    if (id == "if" || id == "elif" || id == "else" || id == "def") {
+    const QString id = Atoms::intern(QStringView(code).mid(start, pos - start));
+    if (id == "if" || id == "elif" || id == "else" || id == "while" || id == "def" || id == "return" || id == "import" ||
+        id == "async" || id == "await") {
         return {TOKEN_KEYWORD, id, line};
     }
     if (id == "True" || id == "False") {
@@ -223,7 +350,7 @@ void Lexer::skipWhitespace(const QString& code) {
 /**
  * Пропускает комментарии в заданном исходном коде. Этот метод проверяет,
  * начинается ли текущая позиция с символа комментария ('#'), и пропускает
- * весь текст до конца строки. После этого обновляет текущую строку и позицию.
+ * весь текст до конца строки. Сам перевод строки не пропускается: он завершает инструкцию.
  *
  * @param code Исходный код, представленный в виде QString, который будет обработан
  *             для игнорирования комментариев.
@@ -232,9 +359,7 @@ void Lexer::skipComment(const QString& code) {
     if (pos < code.length() && code[pos] == '#') {
         while (pos < code.length() && code[pos] != '\n') {
             pos++;
+            column++;
         }
-        column = 1;
-        line++;
-        pos++;
     }
 }
@@ -0,0 +1,544 @@
+#include "ModuleCache.h"
+#include "Atoms.h"
+#include "ParallelLexer.h"
+#include "Parser.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#ifdef __linux__
+#include <sys/stat.h>
+#endif
+
+namespace {
+    constexpr char cacheMagic[4] = {'M', 'Y', 'P', 'C'};
+
+    enum class Tag : quint8 {
+        Null, Value, Var, BinOp, MethodCall, Call, List, Subscript, Assign, AugAssign, If, While, Block, Import,
+        Function, Return
+    };
+
+    enum class ConstantKind : quint8 { Int, Double, Bool, String, Bytes };
+
+    /**
+     * Заголовок файла кэша. Числа записываются в порядке байтов машины: на машине с другим
+     * порядком байтов не совпадёт версия, и кэш будет перезаписан.
+     */
+    struct Header {
+        char magic[4];
+        quint32 version;
+        quint64 buildId;
+        quint64 sourceHash;
+        quint32 constantCount;
+        quint32 constantBytes;
+    };
+
+    template <typename T>
+    void put(std::string &out, const T value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void putBytes(std::string &out, const char *data, const size_t size) {
+        put(out, static_cast<quint32>(size));
+        out.append(data, size);
+    }
+}
+
+/**
+ * Плоская запись дерева: узлы в прямом порядке обхода и пул констант без повторов.
+ */
+struct ModuleCache::Encoder {
+    std::string nodes;
+    std::string constants;
+    quint32 constantCount = 0;
+    std::unordered_map<std::string, quint32> index;
+
+    void tag(const Tag tag) { put(nodes, static_cast<quint8>(tag)); }
+    void u32(const quint32 value) { put(nodes, value); }
+
+    quint32 constant(const ConstantKind kind, const std::string &payload) {
+        std::string entry(1, static_cast<char>(kind));
+        entry += payload;
+        const auto [it, inserted] = index.emplace(entry, constantCount);
+        if (inserted) {
+            constants += entry;
+            ++constantCount;
+        }
+        return it->second;
+    }
+
+    quint32 name(const QString &text) {
+        const QByteArray utf8 = text.toUtf8();
+        std::string payload;
+        putBytes(payload, utf8.constData(), static_cast<size_t>(utf8.size()));
+        return constant(ConstantKind::String, payload);
+    }
+
+    quint32 value(const Value &value) {
+        std::string payload;
+        if (const auto *i = std::get_if<int>(&value.data)) {
+            put(payload, static_cast<qint32>(*i));
+            return constant(ConstantKind::Int, payload);
+        }
+        if (const auto *d = std::get_if<double>(&value.data)) {
+            put(payload, *d);
+            return constant(ConstantKind::Double, payload);
+        }
+        if (const auto *b = std::get_if<bool>(&value.data)) {
+            put(payload, static_cast<quint8>(*b));
+            return constant(ConstantKind::Bool, payload);
+        }
+        if (std::holds_alternative<Value::StringPtr>(value.data)) {
+            return name(std::get<Value::StringPtr>(value.data)->flatten().toQString());
+        }
+        if (const auto *bytes = std::get_if<Value::BytesPtr>(&value.data); bytes && !(*bytes)->isMutable) {
+            putBytes(payload, (*bytes)->data.data(), (*bytes)->data.size());
+            return constant(ConstantKind::Bytes, payload);
+        }
+        throw std::runtime_error("Constant can't be cached");
+    }
+};
+
+/**
+ * Чтение плоской записи из отображённого в память файла. Любой выход за границы данных
+ * означает повреждённый кэш и приводит к исключению.
+ */
+struct ModuleCache::Decoder {
+    struct Constant {
+        ConstantKind kind;
+        Value scalar;
+        QString text;
+        std::string bytes;
+    };
+
+    const uchar *pos;
+    const uchar *end;
+    std::vector<Constant> constants;
+    std::vector<QString> atoms; //интернированные имена по индексу константы
+
+    template <typename T>
+    T get() {
+        if (static_cast<size_t>(end - pos) < sizeof(T)) throw std::runtime_error("Truncated module cache");
+        T value;
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string bytes() {
+        const auto size = get<quint32>();
+        if (static_cast<size_t>(end - pos) < size) throw std::runtime_error("Truncated module cache");
+        std::string result(reinterpret_cast<const char *>(pos), size);
+        pos += size;
+        return result;
+    }
+
+    Tag tag() { return static_cast<Tag>(get<quint8>()); }
+
+    const Constant &constant(const quint32 index) const {
+        if (index >= constants.size()) throw std::runtime_error("Invalid constant in module cache");
+        return constants[index];
+    }
+
+    const QString &name() {
+        const Constant &c = constant(get<quint32>());
+        if (c.kind != ConstantKind::String) throw std::runtime_error("Invalid name in module cache");
+        return c.text;
+    }
+
+    /**
+     * Имя переменной или функции: строка таблицы констант интернируется один раз за загрузку (см. `Atoms`).
+     */
+    QString atom() {
+        const quint32 index = get<quint32>();
+        const Constant &c = constant(index);
+        if (c.kind != ConstantKind::String) throw std::runtime_error("Invalid name in module cache");
+        if (atoms.size() < constants.size()) atoms.resize(constants.size());
+        if (atoms[index].isNull()) atoms[index] = Atoms::intern(c.text);
+        return atoms[index];
+    }
+
+    /**
+     * Каждый литерал получает собственное значение, как при разборе исходного текста.
+     */
+    Value value() {
+        const Constant &c = constant(get<quint32>());
+        switch (c.kind) {
+            case ConstantKind::String: return Value(c.text);
+            case ConstantKind::Bytes: return Value(std::make_shared<Bytes>(c.bytes, false));
+            default: return c.scalar;
+        }
+    }
+};
+
+std::shared_ptr<ASTNode> ModuleCache::load(const QString &path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("can't open file '" + path.toStdString() + "': " + file.errorString().toStdString());
+    }
+    const qint64 size = file.size();
+    const char *data = "";
+    QByteArray contents;
+    if (size > 0) {
+        if (const uchar *mapped = file.map(0, size)) {
+            data = reinterpret_cast<const char *>(mapped);
+        } else {
+            contents = file.readAll();
+            data = contents.constData();
+        }
+    }
+
+    const quint64 sourceHash = hash(data, static_cast<qsizetype>(size));
+    const QString cacheFile = cachePath(path);
+    if (auto module = read(cacheFile, sourceHash)) return module;
+
+    auto module = Parser(ParallelLexer::tokenize(QString::fromUtf8(data, static_cast<qsizetype>(size)))).parseModule();
+    if (writeCache) write(cacheFile, sourceHash, *module);
+    return module;
+}
+
+/**
+ * Модуль отмечается импортированным до выполнения, чтобы циклический import не выполнял его повторно.
+ * Если загрузка или выполнение модуля завершились ошибкой, отметка снимается и следующий import
+ * выполнит модуль заново.
+ */
+void ModuleCache::import(const QString &name, Environment &env) {
+    for (const QString &directory : searchPath) {
+        const QFileInfo source(QDir(directory).filePath(name + ".py"));
+        if (!source.exists()) continue;
+        const QString path = source.absoluteFilePath();
+        auto &imported = env.globals().imported;
+        if (!imported.insert(path).second) return;
+
+        try {
+            auto module = load(path);
+            if (prepare) prepare(module, env);
+            module->eval(env);
+        } catch (...) {
+            imported.erase(path);
+            throw;
+        }
+        return;
+    }
+    throw std::runtime_error("No module named '" + name.toStdString() + "'");
+}
+
+bool ModuleCache::parseFlag(const QString &flag) {
+    if (flag != "-B") return false;
+    writeCache = false;
+    return true;
+}
+
+QString ModuleCache::cachePath(const QString &sourcePath) {
+    const QFileInfo source(sourcePath);
+    return QDir(source.absolutePath()).filePath("__pycache__/" + source.completeBaseName() + ".myc");
+}
+
+/**
+ * Идентификатор сборки интерпретатора: размер и время изменения исполняемого файла. Любая пересборка
+ * меняет его, поэтому кэш, записанный сборкой с другим лексером, парсером или разбором литералов,
+ * не используется даже при неизменной версии формата. Если исполняемый файл определить нельзя,
+ * используется время компиляции этого файла.
+ */
+quint64 ModuleCache::buildId() {
+    static const quint64 id = [] {
+#ifdef __linux__
+        struct stat info {};
+        if (stat("/proc/self/exe", &info) == 0) {
+            return static_cast<quint64>(info.st_size) * 1000000007ull ^
+                   (static_cast<quint64>(info.st_mtim.tv_sec) * 1000000000ull + static_cast<quint64>(info.st_mtim.tv_nsec));
+        }
+#endif
+        constexpr char compiled[] = __DATE__ " " __TIME__;
+        return hash(compiled, sizeof(compiled) - 1);
+    }();
+    return id;
+}
+
+/**
+ * 64-битный FNV-1a от содержимого исходного файла.
+ */
+quint64 ModuleCache::hash(const char *data, const qsizetype size) {
+    quint64 result = 14695981039346656037ull;
+    for (qsizetype i = 0; i < size; ++i) {
+        result ^= static_cast<uchar>(data[i]);
+        result *= 1099511628211ull;
+    }
+    return result;
+}
+
+/**
+ * Восстанавливает дерево из файла кэша.
+ *
+ * @return Дерево модуля или nullptr, если кэша нет, он повреждён, записан другой версией
+ *         формата или для другого содержимого исходного файла.
+ */
+std::shared_ptr<ASTNode> ModuleCache::read(const QString &cacheFile, const quint64 sourceHash) {
+    QFile file(cacheFile);
+    if (!file.open(QIODevice::ReadOnly) || file.size() < static_cast<qint64>(sizeof(Header))) return nullptr;
+    const uchar *data = file.map(0, file.size());
+    if (!data) return nullptr;
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != formatVersion ||
+        header.buildId != buildId() || header.sourceHash != sourceHash) {
+        return nullptr;
+    }
+
+    try {
+        Decoder in{data + sizeof(Header), data + file.size(), {}, {}};
+        in.constants.reserve(std::min<size_t>(header.constantCount, header.constantBytes));
+        for (quint32 i = 0; i < header.constantCount; ++i) {
+            Decoder::Constant constant{static_cast<ConstantKind>(in.get<quint8>()), Value(), QString(), std::string()};
+            switch (constant.kind) {
+                case ConstantKind::Int: constant.scalar = Value(static_cast<int>(in.get<qint32>())); break;
+                case ConstantKind::Double: constant.scalar = Value(in.get<double>()); break;
+                case ConstantKind::Bool: constant.scalar = Value(in.get<quint8>() != 0); break;
+                case ConstantKind::String: {
+                    const std::string utf8 = in.bytes();
+                    constant.text = QString::fromUtf8(utf8.data(), static_cast<qsizetype>(utf8.size()));
+                    break;
+                }
+                case ConstantKind::Bytes: constant.bytes = in.bytes(); break;
+                default: return nullptr;
+            }
+            in.constants.push_back(std::move(constant));
+        }
+
+        auto module = decode(in);
+        if (!module || in.pos != in.end) return nullptr;
+        return module;
+    } catch (const std::runtime_error &) {
+        return nullptr;
+    }
+}
+
+/**
+ * Записывает кэш атомарно (через временный файл). Ошибки записи не прерывают выполнение:
+ * например, каталог исходного файла может быть доступен только для чтения.
+ */
+void ModuleCache::write(const QString &cacheFile, const quint64 sourceHash, const ASTNode &module) {
+    Encoder out;
+    try {
+        encode(out, &module);
+    } catch (const std::runtime_error &) {
+        return;
+    }
+
+    const QFileInfo info(cacheFile);
+    if (!QDir(info.absolutePath()).mkpath(".")) return;
+
+    Header header{};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = formatVersion;
+    header.buildId = buildId();
+    header.sourceHash = sourceHash;
+    header.constantCount = out.constantCount;
+    header.constantBytes = static_cast<quint32>(out.constants.size());
+
+    QSaveFile file(cacheFile);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+    file.write(out.constants.data(), static_cast<qint64>(out.constants.size()));
+    file.write(out.nodes.data(), static_cast<qint64>(out.nodes.size()));
+    file.commit();
+}
+
+void ModuleCache::encode(Encoder &out, const ASTNode *node) {
+    const auto block = [&out](const std::vector<std::shared_ptr<ASTNode>> &statements) {
+        out.u32(static_cast<quint32>(statements.size()));
+        for (const auto &stmt : statements) encode(out, stmt.get());
+    };
+
+    if (!node) {
+        out.tag(Tag::Null);
+    } else if (const auto *value = dynamic_cast<const ValueNode *>(node)) {
+        out.tag(Tag::Value);
+        out.u32(out.value(value->value));
+    } else if (const auto *var = dynamic_cast<const VarNode *>(node)) {
+        out.tag(Tag::Var);
+        out.u32(out.name(var->name));
+    } else if (const auto *bin = dynamic_cast<const BinOpNode *>(node)) {
+        out.tag(Tag::BinOp);
+        put(out.nodes, static_cast<quint8>(bin->operation));
+        encode(out, bin->left.get());
+        encode(out, bin->right.get());
+    } else if (const auto *method = dynamic_cast<const MethodCallNode *>(node)) {
+        out.tag(Tag::MethodCall);
+        encode(out, method->object.get());
+        out.u32(out.name(method->name));
+        block(method->args);
+    } else if (const auto *call = dynamic_cast<const CallNode *>(node)) {
+        out.tag(Tag::Call);
+        out.u32(out.name(call->name));
+        block(call->args);
+    } else if (const auto *list = dynamic_cast<const ListNode *>(node)) {
+        out.tag(Tag::List);
+        block(list->elements);
+    } else if (const auto *subscript = dynamic_cast<const SubscriptNode *>(node)) {
+        out.tag(Tag::Subscript);
+        put(out.nodes, static_cast<quint8>(subscript->isSlice));
+        encode(out, subscript->object.get());
+        encode(out, subscript->start.get());
+        encode(out, subscript->stop.get());
+        encode(out, subscript->step.get());
+    } else if (const auto *assign = dynamic_cast<const AssignNode *>(node)) {
+        out.tag(Tag::Assign);
+        out.u32(out.name(assign->varName));
+        encode(out, assign->valueExpr.get());
+    } else if (const auto *aug = dynamic_cast<const AugAssignNode *>(node)) {
+        out.tag(Tag::AugAssign);
+        out.u32(out.name(aug->varName));
+        out.u32(out.name(aug->op));
+        encode(out, aug->valueExpr.get());
+    } else if (const auto *branch = dynamic_cast<const IfNode *>(node)) {
+        out.tag(Tag::If);
+        encode(out, branch->condition.get());
+        block(branch->body);
+        out.u32(static_cast<quint32>(branch->elifs.size()));
+        for (const auto &[condition, body] : branch->elifs) {
+            encode(out, condition.get());
+            block(body);
+        }
+        block(branch->elseBody);
+    } else if (const auto *loop = dynamic_cast<const WhileNode *>(node)) {
+        out.tag(Tag::While);
+        encode(out, loop->condition.get());
+        block(loop->body);
+    } else if (const auto *statements = dynamic_cast<const BlockNode *>(node)) {
+        out.tag(Tag::Block);
+        block(statements->statements);
+    } else if (const auto *import = dynamic_cast<const ImportNode *>(node)) {
+        out.tag(Tag::Import);
+        out.u32(out.name(import->module));
+    } else if (const auto *function = dynamic_cast<const FunctionNode *>(node)) {
+        //Тело функции записывается токенами: оно разбирается только при первом вызове
+        out.tag(Tag::Function);
+        out.u32(out.name(function->name));
+        put(out.nodes, static_cast<quint8>(function->isAsync));
+        out.u32(static_cast<quint32>(function->params.size()));
+        for (const QString &param : function->params) out.u32(out.name(param));
+        const QVector<Token> &tokens = function->bodyTokens();
+        out.u32(static_cast<quint32>(tokens.size()));
+        for (const Token &token : tokens) {
+            put(out.nodes, static_cast<quint8>(token.type));
+            out.u32(out.name(token.value));
+            put(out.nodes, static_cast<qint32>(token.line));
+        }
+    } else if (const auto *ret = dynamic_cast<const ReturnNode *>(node)) {
+        out.tag(Tag::Return);
+        encode(out, ret->value.get());
+    } else {
+        throw std::runtime_error("Node can't be cached");
+    }
+}
+
+std::shared_ptr<ASTNode> ModuleCache::decode(Decoder &in) {
+    const auto node = [&in] {
+        auto result = decode(in);
+        if (!result) throw std::runtime_error("Missing node in module cache");
+        return result;
+    };
+    const auto block = [&in, &node] {
+        const auto count = in.get<quint32>();
+        if (count > static_cast<size_t>(in.end - in.pos)) throw std::runtime_error("Truncated module cache");
+        std::vector<std::shared_ptr<ASTNode>> statements;
+        statements.reserve(count);
+        for (quint32 i = 0; i < count; ++i) statements.push_back(node());
+        return statements;
+    };
+
+    switch (in.tag()) {
+        case Tag::Null:
+            return nullptr;
+        case Tag::Value:
+            return std::make_shared<ValueNode>(in.value());
+        case Tag::Var:
+            return std::make_shared<VarNode>(in.atom());
+        case Tag::BinOp: {
+            const auto op = in.get<quint8>();
+            if (op >= BinaryDispatch::opCount) throw std::runtime_error("Invalid operation in module cache");
+            auto left = node();
+            auto right = node();
+            return std::make_shared<BinOpNode>(std::move(left), BinaryDispatch::symbol(static_cast<BinaryOp>(op)), std::move(right));
+        }
+        case Tag::MethodCall: {
+            auto object = node();
+            const QString name = in.name();
+            return std::make_shared<MethodCallNode>(std::move(object), name, block());
+        }
+        case Tag::Call: {
+            const QString name = in.atom();
+            return std::make_shared<CallNode>(name, block());
+        }
+        case Tag::List:
+            return std::make_shared<ListNode>(block());
+        case Tag::Subscript: {
+            const bool isSlice = in.get<quint8>() != 0;
+            auto object = node();
+            auto start = decode(in);
+            auto stop = decode(in);
+            auto step = decode(in);
+            if (!isSlice) return std::make_shared<SubscriptNode>(std::move(object), std::move(start));
+            return std::make_shared<SubscriptNode>(std::move(object), std::move(start), std::move(stop), std::move(step));
+        }
+        case Tag::Assign: {
+            const QString name = in.atom();
+            return std::make_shared<AssignNode>(name, node());
+        }
+        case Tag::AugAssign: {
+            const QString name = in.atom();
+            const QString op = in.name();
+            return std::make_shared<AugAssignNode>(name, op, node());
+        }
+        case Tag::If: {
+            auto condition = node();
+            auto body = block();
+            const auto count = in.get<quint32>();
+            if (count > static_cast<size_t>(in.end - in.pos)) throw std::runtime_error("Truncated module cache");
+            std::vector<std::pair<std::shared_ptr<ASTNode>, std::vector<std::shared_ptr<ASTNode>>>> elifs;
+            for (quint32 i = 0; i < count; ++i) {
+                auto elifCondition = node();
+                elifs.emplace_back(std::move(elifCondition), block());
+            }
+            auto elseBody = block();
+            return std::make_shared<IfNode>(std::move(condition), std::move(body), std::move(elifs), std::move(elseBody));
+        }
+        case Tag::While: {
+            auto condition = node();
+            return std::make_shared<WhileNode>(std::move(condition), block());
+        }
+        case Tag::Block:
+            return std::make_shared<BlockNode>(block());
+        case Tag::Import:
+            return std::make_shared<ImportNode>(in.name());
+        case Tag::Function: {
+            const QString name = in.atom();
+            const bool isAsync = in.get<quint8>() != 0;
+            const auto paramCount = in.get<quint32>();
+            if (paramCount > static_cast<size_t>(in.end - in.pos)) throw std::runtime_error("Truncated module cache");
+            std::vector<QString> params;
+            for (quint32 i = 0; i < paramCount; ++i) params.push_back(in.atom());
+            const auto tokenCount = in.get<quint32>();
+            if (tokenCount > static_cast<size_t>(in.end - in.pos)) throw std::runtime_error("Truncated module cache");
+            QVector<Token> tokens;
+            tokens.reserve(tokenCount);
+            for (quint32 i = 0; i < tokenCount; ++i) {
+                const auto type = in.get<quint8>();
+                if (type > TOKEN_EOF) throw std::runtime_error("Invalid token in module cache");
+                QString value = type == TOKEN_ID || type == TOKEN_KEYWORD ? in.atom() : in.name();
+                const auto line = in.get<qint32>();
+                tokens.append(Token(static_cast<LexTokenType>(type), std::move(value), line));
+            }
+            return std::make_shared<FunctionNode>(name, std::move(params), std::move(tokens), isAsync);
+        }
+        case Tag::Return:
+            return std::make_shared<ReturnNode>(decode(in));
+        default:
+            throw std::runtime_error("Invalid node in module cache");
+    }
+}
@@ -0,0 +1,135 @@
+#include "NumberFormat.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <string>
+
+namespace {
+    [[noreturn]] void invalidLiteral(const QString &literal) {
+        throw std::runtime_error("Invalid number format: " + literal.toStdString());
+    }
+
+    /**
+     * Копирует литерал в ASCII-буфер без символов `_`, проверяя, что каждый `_` стоит между двумя цифрами.
+     */
+    std::string stripUnderscores(const QString &literal, const int base) {
+        const auto isDigit = [base](const QChar ch) {
+            const char16_t c = ch.unicode();
+            if (base == 16) return (c >= u'0' && c <= u'9') || (c >= u'a' && c <= u'f') || (c >= u'A' && c <= u'F');
+            return c >= u'0' && c < u'0' + base;
+        };
+
+        std::string result;
+        result.reserve(static_cast<size_t>(literal.size()));
+        for (qsizetype i = 0; i < literal.size(); ++i) {
+            const QChar ch = literal[i];
+            if (ch == '_') {
+                if (i == 0 || i + 1 >= literal.size() || !isDigit(literal[i - 1]) || !isDigit(literal[i + 1])) {
+                    invalidLiteral(literal);
+                }
+                continue;
+            }
+            if (ch.unicode() >= 0x80) invalidLiteral(literal);
+            result += static_cast<char>(ch.unicode());
+        }
+        return result;
+    }
+}
+
+/**
+ * Цифры и десятичный порядок берутся из кратчайшей экспоненциальной записи `std::to_chars`.
+ * Как и Python, экспоненциальная запись используется при порядке меньше -4 или не меньше 16;
+ * у целых значений в обычной записи добавляется `.0`.
+ */
+void NumberFormat::append(std::string &out, const double value) {
+    if (std::isnan(value)) {
+        out += "nan";
+        return;
+    }
+    if (std::isinf(value)) {
+        out += value > 0 ? "inf" : "-inf";
+        return;
+    }
+
+    char buffer[32];
+    const auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific);
+    if (ec != std::errc()) {
+        out += QString::number(value, 'g', 17).toStdString();
+        return;
+    }
+
+    //buffer: [-]d[.ddd]e±XX
+    const char *p = buffer;
+    const bool negative = *p == '-';
+    if (negative) ++p;
+    const char *exponentMark = std::find(p, static_cast<const char *>(end), 'e');
+    std::string digits;
+    for (const char *q = p; q < exponentMark; ++q) {
+        if (*q != '.') digits += *q;
+    }
+    int exponent = 0;
+    std::from_chars(exponentMark + (exponentMark[1] == '+' ? 2 : 1), end, exponent);
+
+    if (negative) out += '-';
+    if (exponent < -4 || exponent >= 16) {
+        out += digits[0];
+        if (digits.size() > 1) out.append(".").append(digits, 1);
+        out += exponent < 0 ? "e-" : "e+";
+        const int magnitude = std::abs(exponent);
+        if (magnitude < 10) out += '0';
+        out += std::to_string(magnitude);
+    } else if (exponent < 0) {
+        out.append("0.").append(static_cast<size_t>(-exponent - 1), '0').append(digits);
+    } else if (static_cast<size_t>(exponent) + 1 >= digits.size()) {
+        out.append(digits).append(static_cast<size_t>(exponent) + 1 - digits.size(), '0').append(".0");
+    } else {
+        out.append(digits, 0, static_cast<size_t>(exponent) + 1).append(".").append(digits, static_cast<size_t>(exponent) + 1);
+    }
+}
+
+QString NumberFormat::toString(const double value) {
+    std::string result;
+    append(result, value);
+    return QString::fromLatin1(result.data(), static_cast<qsizetype>(result.size()));
+}
+
+Value NumberFormat::parseLiteral(const QString &literal) {
+    int base = 10;
+    if (literal.size() > 2 && literal[0] == '0') {
+        const QChar prefix = literal[1].toLower();
+        if (prefix == 'x') base = 16;
+        else if (prefix == 'o') base = 8;
+        else if (prefix == 'b') base = 2;
+    }
+
+    if (base != 10) {
+        //Как в Python, `_` допускается и сразу после префикса: 0x_FF
+        const QString body = literal.mid(literal.size() > 3 && literal[2] == '_' ? 3 : 2);
+        const std::string digits = stripUnderscores(body, base);
+        int value = 0;
+        const auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value, base);
+        if (ec == std::errc::result_out_of_range) throw std::runtime_error("Integer literal is too large: " + literal.toStdString());
+        if (ec != std::errc() || ptr != digits.data() + digits.size() || digits.empty()) invalidLiteral(literal);
+        return Value(value);
+    }
+
+    const std::string text = stripUnderscores(literal, 10);
+    const char *first = text.data();
+    const char *last = first + text.size();
+    if (text.find_first_of(".eE") == std::string::npos) {
+        int value = 0;
+        const auto [ptr, ec] = std::from_chars(first, last, value);
+        if (ec == std::errc::result_out_of_range) throw std::runtime_error("Integer literal is too large: " + literal.toStdString());
+        if (ec != std::errc() || ptr != last) invalidLiteral(literal);
+        return Value(value);
+    }
+
+    double value = 0;
+    const auto [ptr, ec] = std::from_chars(first, last, value);
+    if (ec == std::errc::result_out_of_range && ptr == last) {
+        //Переполнение даёт бесконечность, исчезновение порядка — ноль (toDouble выбирает по знаку порядка)
+        return Value(QString::fromLatin1(first, static_cast<qsizetype>(text.size())).toDouble());
+    }
+    if (ec != std::errc() || ptr != last) invalidLiteral(literal);
+    return Value(value);
+}
@@ -0,0 +1,91 @@
+#include "Output.h"
+#include "Repr.h"
+#include <cstdio>
+#include <utility>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+    bool isTerminal(FILE *file) {
+#ifdef _WIN32
+        return _isatty(_fileno(file));
+#else
+        return isatty(fileno(file));
+#endif
+    }
+
+    /**
+     * Буфер вывода; при уничтожении (завершении процесса) недописанный текст записывается в stdout.
+     */
+    struct Stream {
+        std::string buffer;
+        bool lineBuffered = isTerminal(stdout);
+
+        Stream() { buffer.reserve(Output::capacity); }
+        ~Stream() { writeOut(); }
+
+        void writeOut() {
+            if (buffer.empty()) return;
+            std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+            std::fflush(stdout);
+            buffer.clear();
+        }
+    };
+
+    Stream &stream() {
+        static Stream instance;
+        return instance;
+    }
+
+    thread_local std::string *capture = nullptr;
+}
+
+Output::Capture::Capture(std::string &target) : previous(redirect(&target)) {}
+
+Output::Capture::~Capture() {
+    redirect(previous);
+}
+
+std::string *Output::redirect(std::string *target) {
+    return std::exchange(capture, target);
+}
+
+void Output::write(const std::string_view text) {
+    target().append(text);
+    afterWrite();
+}
+
+void Output::writeRepr(const Value &value) {
+    Repr(target()).repr(value);
+    afterWrite();
+}
+
+void Output::print(const std::vector<Value> &values) {
+    std::string &buffer = target();
+    Repr repr(buffer);
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) buffer += ' ';
+        repr.str(values[i]);
+    }
+    buffer += '\n';
+    afterWrite();
+}
+
+void Output::flush() {
+    stream().writeOut();
+}
+
+std::string &Output::target() {
+    return capture ? *capture : stream().buffer;
+}
+
+void Output::afterWrite() {
+    if (capture) return;
+    Stream &out = stream();
+    if (out.buffer.size() >= capacity || (out.lineBuffered && !out.buffer.empty() && out.buffer.back() == '\n')) {
+        out.writeOut();
+    }
+}
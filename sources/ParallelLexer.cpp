@@ -0,0 +1,94 @@
+#include "ParallelLexer.h"
+#include <QThread>
+#include <QThreadPool>
+#include <algorithm>
+
+QVector<Token> ParallelLexer::tokenize(const QString &code) {
+    const int threads = QThread::idealThreadCount();
+    if (code.length() < minParallelSize || threads < 2) return Lexer().tokenize(code);
+
+    //Границы фрагментов сдвигаются к началу следующей физической строки
+    std::vector<Chunk> chunks;
+    const int length = static_cast<int>(code.length());
+    const int step = length / threads + 1;
+    int begin = 0;
+    int firstLine = 1;
+    while (begin <= length) {
+        int limit = std::min(begin + step, length);
+        while (limit < length && code[limit - 1] != '\n') ++limit;
+        if (limit == length) limit = length + 1; //последняя строка может быть пустой и начинаться в конце кода
+        chunks.push_back({begin, limit, firstLine, {}});
+        firstLine += static_cast<int>(std::count(code.begin() + begin, code.begin() + std::min(limit, length), QChar('\n')));
+        begin = limit;
+    }
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (Chunk &chunk : chunks) {
+        pool.start([&code, &chunk] { lexChunk(code, chunk, false); });
+    }
+    pool.waitForDone();
+
+    QVector<Token> tokens;
+    QVector<int> indentStack = {0};
+    int expected = 0; //позиция, с которой начинается следующая строка
+    int lastLine = 1;
+    for (Chunk &chunk : chunks) {
+        if (expected >= chunk.limit) continue; //фрагмент целиком внутри литерала предыдущего
+
+        auto first = std::find_if(chunk.lines.begin(), chunk.lines.end(),
+                                  [expected](const Line &line) { return line.begin == expected; });
+        if (first == chunk.lines.end()) {
+            //Литерал пересёк границу фрагмента, и строки фрагмента не совпали с настоящими
+            chunk.begin = expected;
+            chunk.firstLine = lastLine + 1;
+            lexChunk(code, chunk, true);
+            first = chunk.lines.begin();
+        }
+
+        for (auto line = first; line != chunk.lines.end(); ++line) {
+            if (!line->error.empty()) throw std::runtime_error(line->error);
+            if (line->begin > 0) Lexer::appendLayout(tokens, indentStack, line->indent, line->firstLine);
+            tokens.append(line->tokens);
+            expected = line->end + 1;
+            lastLine = line->lastLine;
+        }
+    }
+
+    Lexer::appendEnd(tokens, indentStack, lastLine);
+    return tokens;
+}
+
+/**
+ * Лексирует строки, начинающиеся в [chunk.begin, chunk.limit). Последняя строка может
+ * закончиться за границей фрагмента, если в ней начинается многострочный литерал.
+ *
+ * @param throwErrors Выбрасывать ошибку сразу (фрагмент начинается с настоящего начала строки)
+ *                    или сохранить её в строке и прекратить лексирование фрагмента.
+ */
+void ParallelLexer::lexChunk(const QString &code, Chunk &chunk, const bool throwErrors) {
+    Lexer lexer;
+    chunk.lines.clear();
+    int begin = chunk.begin;
+    int lineNumber = chunk.firstLine;
+    while (begin < chunk.limit) {
+        Line line;
+        line.begin = begin;
+        line.firstLine = lineNumber;
+        line.indent = Lexer::measureIndent(code, begin);
+        try {
+            line.tokens = lexer.tokenizeLine(code, begin, lineNumber, line.end);
+        } catch (const std::runtime_error &e) {
+            if (throwErrors) throw;
+            line.error = e.what();
+            chunk.lines.push_back(std::move(line));
+            return;
+        }
+        line.lastLine = lexer.currentLine();
+        chunk.lines.push_back(std::move(line));
+
+        if (chunk.lines.back().end >= code.length()) return;
+        begin = chunk.lines.back().end + 1;
+        lineNumber = chunk.lines.back().lastLine + 1;
+    }
+}
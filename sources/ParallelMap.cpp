@@ -0,0 +1,233 @@
+#include "ParallelMap.h"
+#include "AstTraversal.h"
+#include "Coroutine.h"
+#include "File.h"
+#include "Frozen.h"
+#include "Output.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+    std::shared_ptr<FunctionNode> functionOf(const Value &value) {
+        const auto *function = std::get_if<Value::FunctionPtr>(&value.data);
+        return function ? std::dynamic_pointer_cast<FunctionNode>(**function) : nullptr;
+    }
+
+    /**
+     * Копирует значения для одного рабочего потока. Списки, словари и bytearray копируются глубоко
+     * с сохранением разделяемых подграфов и циклов, функции заменяются изолированными копиями
+     * (см. `AstTraversal::clone`). Числа, замороженные значения, строки и bytes разделяются:
+     * их никто не изменяет на месте, пока на них есть другие ссылки.
+     */
+    class Isolator {
+    public:
+        /**
+         * @throws std::runtime_error Если граф содержит файл, memoryview или сопрограмму
+         */
+        Value copy(const Value &value) {
+            if (Frozen::isFrozen(value)) return value;
+            if (const auto function = functionOf(value)) return remember(function.get(), [&] {
+                return Value(Value::Function(AstTraversal::clone(function, true)));
+            });
+            if (const auto *bytes = std::get_if<Value::BytesPtr>(&value.data)) {
+                if (!(*bytes)->isMutable) return value;
+                return remember(bytes->get(), [&] { return Value(std::make_shared<Bytes>((*bytes)->data, true)); });
+            }
+            if (const auto *list = std::get_if<Value::ListPtr>(&value.data)) {
+                if (const auto it = memo.find(list->get()); it != memo.end()) return it->second;
+                auto copied = std::make_shared<Value::List>();
+                Value result;
+                result.data = copied;
+                memo.emplace(list->get(), result);
+                copied->reserve((*list)->size());
+                for (const Value &item : **list) copied->push_back(copy(item));
+                return result;
+            }
+            if (const auto *dict = std::get_if<Value::DictPtr>(&value.data)) {
+                if (const auto it = memo.find(dict->get()); it != memo.end()) return it->second;
+                auto copied = std::make_shared<Value::Dict>();
+                Value result;
+                result.data = copied;
+                memo.emplace(dict->get(), result);
+                copied->reserve((*dict)->size());
+                for (auto it = (*dict)->cbegin(); it != (*dict)->cend(); ++it) copied->insert(it.key(), copy(it.value()));
+                return result;
+            }
+            if (std::holds_alternative<Value::StringPtr>(value.data)) return value; //выровнена заранее
+            const char *type = "memoryview";
+            if (const auto *awaitable = std::get_if<Value::AwaitablePtr>(&value.data)) type = (*awaitable)->typeName();
+            if (const auto *file = std::get_if<Value::FilePtr>(&value.data)) type = (*file)->typeName();
+            throw std::runtime_error(std::string("parallel_map() cannot pass ") + type + " to a worker thread");
+        }
+
+    private:
+        template <typename F>
+        Value remember(const void *original, F &&create) {
+            if (const auto it = memo.find(original); it != memo.end()) return it->second;
+            return memo.emplace(original, create()).first->second;
+        }
+
+        std::unordered_map<const void *, Value> memo;
+    };
+
+    /**
+     * Выравнивает отложенные конкатенации и срезы строк, достижимых из value, и вычисляет их хеш,
+     * чтобы рабочие потоки только читали их. Замороженные значения уже выровнены и не обходятся.
+     */
+    void flattenStrings(const Value &value, std::unordered_set<const void *> &visited) {
+        if (Frozen::isFrozen(value)) return;
+        if (const auto *str = std::get_if<Value::StringPtr>(&value.data)) {
+            (void)(*str)->flatten().hash();
+        } else if (const auto *list = std::get_if<Value::ListPtr>(&value.data)) {
+            if (!visited.insert(list->get()).second) return;
+            for (const Value &item : **list) flattenStrings(item, visited);
+        } else if (const auto *dict = std::get_if<Value::DictPtr>(&value.data)) {
+            if (!visited.insert(dict->get()).second) return;
+            for (auto it = (*dict)->cbegin(); it != (*dict)->cend(); ++it) flattenStrings(it.value(), visited);
+        }
+    }
+
+    /**
+     * Проверяет, что результат функции можно вернуть из рабочего потока. Сопрограмма ссылается
+     * на окружение потока, которое уничтожается по завершении вызова, поэтому ожидаемые значения
+     * не возвращаются (как и в `process_map`).
+     */
+    void checkResult(const Value &value, std::unordered_set<const void *> &visited) {
+        if (Frozen::isFrozen(value)) return;
+        if (const auto *awaitable = std::get_if<Value::AwaitablePtr>(&value.data)) {
+            throw std::runtime_error(std::string("parallel_map() cannot return ") + (*awaitable)->typeName() +
+                                     " from a worker thread");
+        }
+        if (const auto *list = std::get_if<Value::ListPtr>(&value.data)) {
+            if (!visited.insert(list->get()).second) return;
+            for (const Value &item : **list) checkResult(item, visited);
+        } else if (const auto *dict = std::get_if<Value::DictPtr>(&value.data)) {
+            if (!visited.insert(dict->get()).second) return;
+            for (auto it = (*dict)->cbegin(); it != (*dict)->cend(); ++it) checkResult(it.value(), visited);
+        }
+    }
+
+    struct Worker {
+        Environment globals;
+        std::shared_ptr<FunctionNode> function;
+        Isolator isolator; //копирует также элементы списка, обрабатываемые потоком
+        LoopStates loops; //состояние циклов общих функций (см. AstTraversal::share)
+    };
+
+    /**
+     * Общее состояние одного вызова parallel_map.
+     */
+    struct Call {
+        Call(Environment &caller, const Value &function, const Value::List &items, const size_t chunkCount) :
+        caller(caller), function(function), items(items), results(items.size()), outputs(chunkCount) {}
+
+        Environment &caller;
+        const Value &function;
+        const Value::List &items;
+        Value::List results;
+        std::vector<std::string> outputs; //вывод каждой части
+        std::atomic<size_t> finished{0};
+        std::atomic<bool> failed{false};
+
+        std::mutex mutex;
+        std::unordered_map<std::thread::id, std::unique_ptr<Worker>> workers;
+        size_t errorChunk = std::numeric_limits<size_t>::max();
+        std::string error;
+
+        /**
+         * Окружение текущего потока; создаётся при первой части, выполняемой этим потоком.
+         * Глобальные переменные, которые нельзя скопировать в поток (файлы, memoryview, сопрограммы),
+         * в окружение не попадают.
+         */
+        Worker &worker() {
+            const auto id = std::this_thread::get_id();
+            {
+                std::lock_guard lock(mutex);
+                if (const auto it = workers.find(id); it != workers.end()) return *it->second;
+            }
+            auto created = std::make_unique<Worker>();
+            for (const auto &[name, value] : caller.globals().locals()) {
+                try {
+                    created->globals.set(name, created->isolator.copy(value));
+                } catch (const std::runtime_error &) {
+                    //значение недоступно в рабочем потоке
+                }
+            }
+            created->function = functionOf(created->isolator.copy(function));
+            std::lock_guard lock(mutex);
+            return *workers.emplace(id, std::move(created)).first->second;
+        }
+
+        void fail(const size_t chunk, const char *message) {
+            std::lock_guard lock(mutex);
+            failed = true;
+            if (chunk < errorChunk) {
+                errorChunk = chunk;
+                error = message;
+            }
+        }
+
+        void run(const size_t chunk, const size_t begin, const size_t end) {
+            if (!failed) {
+                const Output::Capture capture(outputs[chunk]);
+                try {
+                    Worker &current = worker();
+                    const LoopStates::Scope loopScope(current.loops);
+                    std::unordered_set<const void *> checked;
+                    for (size_t i = begin; i < end && !failed; ++i) {
+                        results[i] = current.function->call({current.isolator.copy(items[i])}, current.globals);
+                        checkResult(results[i], checked);
+                    }
+                } catch (const std::exception &e) {
+                    fail(chunk, e.what());
+                }
+            }
+            ++finished; //последнее обращение задачи к состоянию вызова
+        }
+    };
+}
+
+/**
+ * По умолчанию список делится на четыре части на каждый поток пула: частей достаточно
+ * для выравнивания нагрузки, а накладные расходы на часть невелики.
+ */
+Value ParallelMap::call(const std::vector<Value> &args, Environment &env) {
+    if (args.size() < 2 || args.size() > 3) {
+        throw std::runtime_error("parallel_map() takes 2 or 3 arguments (" + std::to_string(args.size()) + " given)");
+    }
+    if (!functionOf(args[0])) throw std::runtime_error("parallel_map() argument 1 must be a function");
+    const auto *list = std::get_if<Value::ListPtr>(&args[1].data);
+    if (!list) throw std::runtime_error("parallel_map() argument 2 must be a list");
+    const Value::List &items = **list;
+
+    WorkStealingPool &pool = WorkStealingPool::global();
+    size_t chunkSize = std::max<size_t>(1, (items.size() + pool.threadCount() * 4 - 1) / (pool.threadCount() * 4));
+    if (args.size() == 3) {
+        const auto *requested = std::get_if<int>(&args[2].data);
+        if (!requested || *requested <= 0) throw std::runtime_error("parallel_map() chunksize must be a positive integer");
+        chunkSize = static_cast<size_t>(*requested);
+    }
+    if (items.empty()) return Value(Value::List());
+
+    std::unordered_set<const void *> visited;
+    for (const auto &[name, value] : env.globals().locals()) flattenStrings(value, visited);
+    flattenStrings(args[1], visited);
+
+    const size_t chunkCount = (items.size() + chunkSize - 1) / chunkSize;
+    Call call(env, args[0], items, chunkCount);
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(items.size(), begin + chunkSize);
+        pool.submit([&call, chunk, begin, end] { call.run(chunk, begin, end); });
+    }
+    pool.helpUntil([&call, chunkCount] { return call.finished == chunkCount; });
+
+    for (const std::string &output : call.outputs) Output::write(output);
+    if (call.failed) throw std::runtime_error(call.error);
+    return Value(std::move(call.results));
+}
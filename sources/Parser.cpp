@@ -1,4 +1,9 @@
 #include "Parser.h"
+#include "AstTraversal.h"
+#include "Coroutine.h"
+#include "NumberFormat.h"
+#include <algorithm>
+#include <cstdint>
 
 
 /**
@@ -14,6 +19,9 @@
 Parser::Parser(const QVector<Token> &tokens) : tokens(tokens) {
 }
 
+Parser::Parser(const QVector<Token> &tokens, StatementCache *cache) : tokens(tokens), cache(cache) {
+}
+
 /**
  * Разбирает исходное выражение, начиная с наивысшего по приоритету уровня анализа.
  *
@@ -31,10 +39,32 @@ std::shared_ptr<ASTNode> Parser::parse() {
     return parseAssignment();
 }
 
+/**
+ * Разбирает инструкции до конца потока токенов. Пустые строки пропускаются; каждая инструкция
+ * верхнего уровня должна завершаться переводом строки, концом своего блока или концом файла.
+ *
+ * @return Узел BlockNode, выполняющий инструкции модуля по порядку.
+ */
+std::shared_ptr<ASTNode> Parser::parseModule() {
+    std::vector<std::shared_ptr<ASTNode>> statements;
+    while (true) {
+        while (peek().type == TOKEN_NEWLINE) advance();
+        if (peek().type == TOKEN_EOF) break;
+
+        statements.push_back(parseStatement());
+        //Составная инструкция завершается концом своего блока (DEDENT), простая — переводом строки
+        const bool blockEnded = current > 0 && tokens[current - 1].type == TOKEN_DEDENT;
+        if (peek().type == TOKEN_NEWLINE) advance();
+        else if (peek().type != TOKEN_EOF && !blockEnded) throwUnexpectedTokenError(peek());
+    }
+    return std::make_shared<BlockNode>(std::move(statements));
+}
+
 /**
  * Разбирает выражение присваивания.
  *
- * Метод обрабатывает выражения с операцией присваивания "=". Если текущий
+ * Метод обрабатывает выражения с операцией присваивания "=", а также составные
+ * присваивания "+=" и "-=" (узел AugAssignNode). Если текущий
  * токен соответствует операции присваивания, производится разбор левой
  * и правой части оператора. Левая часть должна быть валидной переменной
  * (VarNode), иначе выбрасывается исключение. Для корректного выражения
@@ -56,6 +86,13 @@ std::shared_ptr<ASTNode> Parser::parseAssignment() {
         if (!var) throw std::runtime_error("Invalid assignment target");
         return std::make_shared<AssignNode>(var->name, right);
     }
+    if (peek().type == TOKEN_OP && (peek().value == "+=" || peek().value == "-=")) {
+        const QString op = advance().value;
+        std::shared_ptr<ASTNode> right = parseAssignment();
+        const std::shared_ptr<VarNode> var = std::dynamic_pointer_cast<VarNode>(left);
+        if (!var) throw std::runtime_error("Invalid assignment target");
+        return std::make_shared<AugAssignNode>(var->name, op, right);
+    }
     return left;
 }
 
@@ -76,8 +113,8 @@ std::shared_ptr<ASTNode> Parser::parseComparison() {
     std::shared_ptr<ASTNode> left = parseAdditionAndSubtraction();
     while (peek().type == TOKEN_OP &&
            (peek().value == "==" || peek().value == "!=" ||
-            peek().value == "<" || peek().value == "<=") ||
-           peek().value == ">" || peek().value == ">=") {
+            peek().value == "<" || peek().value == "<=" ||
+            peek().value == ">" || peek().value == ">=")) {
         QString op = advance().value;
         std::shared_ptr<ASTNode> right = parseAdditionAndSubtraction();
         left = std::make_shared<BinOpNode>(left, op, right);
@@ -126,9 +163,9 @@ std::shared_ptr<ASTNode> Parser::parseTerm() {
     std::shared_ptr<ASTNode> left = parseUnaryMinus();
     while (peek().type == TOKEN_OP &&
            (peek().value == "*" ||
-            peek().value == "/") ||
-           peek().value == "//" ||
-           peek().value == "%") {
+            peek().value == "/" ||
+            peek().value == "//" ||
+            peek().value == "%")) {
         QString op = advance().value;
         std::shared_ptr<ASTNode> right = parseUnaryMinus();
         left = std::make_shared<BinOpNode>(left, op, right);
@@ -167,7 +204,7 @@ std::shared_ptr<ASTNode> Parser::parseUnaryMinus() {
  *
  * Метод обрабатывает операции возведения в степень (**), используя рекурсивный подход
  * из-за правой ассоциативности данной операции. Сначала разбирается левый операнд
- * как первичное выражение, а затем проверяется наличие оператора "**".
+ * как постфиксное выражение, а затем проверяется наличие оператора "**".
  * Если оператор найден, рекурсивно анализируется правый операнд, после чего создается
  * узел BinOpNode для представления операции возведения в степень.
  *
@@ -176,7 +213,7 @@ std::shared_ptr<ASTNode> Parser::parseUnaryMinus() {
  *         Исключения могут быть выброшены, если встречен некорректный синтаксис.
  */
 std::shared_ptr<ASTNode> Parser::parsePower() {
-    std::shared_ptr<ASTNode> left = parsePrimary();
+    std::shared_ptr<ASTNode> left = parsePostfix();
     if (peek().type == TOKEN_OP && peek().value == "**") {
         QString op = advance().value;
         std::shared_ptr<ASTNode> right = parsePower();
@@ -185,6 +222,115 @@ std::shared_ptr<ASTNode> Parser::parsePower() {
     return left;
 }
 
+/**
+ * Разбирает постфиксное выражение: первичное выражение, за которым может следовать
+ * цепочка вызовов методов вида `.name(args)` и индексирований вида `[i]` или `[i:j:k]`.
+ *
+ * @return Умный указатель на узел AST: узел MethodCallNode или SubscriptNode для каждого элемента
+ *         цепочки или первичное выражение, если цепочки нет.
+ * @throws std::runtime_error Если после точки отсутствует имя метода или список аргументов.
+ */
+std::shared_ptr<ASTNode> Parser::parsePostfix() {
+    std::shared_ptr<ASTNode> expr = parsePrimary();
+    while (expr && peek().type == TOKEN_OP && (peek().value == "." || peek().value == "[")) {
+        if (advance().value == "[") {
+            expr = parseSubscript(expr);
+            continue;
+        }
+        if (peek().type != TOKEN_ID) throw std::runtime_error("Expected method name after '.'");
+        QString name = advance().value;
+        expr = std::make_shared<MethodCallNode>(expr, name, parseArguments());
+    }
+    return expr;
+}
+
+/**
+ * Разбирает содержимое квадратных скобок после выражения (открывающая скобка уже прочитана).
+ *
+ * Если внутри скобок встречается ':', строится срез, каждая часть которого (начало, конец, шаг)
+ * может быть опущена; иначе строится обычное индексирование.
+ *
+ * @param object Выражение, к которому применяется индексирование.
+ * @return Узел SubscriptNode.
+ * @throws std::runtime_error Если индекс отсутствует или скобка не закрыта.
+ */
+std::shared_ptr<ASTNode> Parser::parseSubscript(std::shared_ptr<ASTNode> object) {
+    auto isOp = [this](const char *op) { return peek().type == TOKEN_OP && peek().value == op; };
+
+    std::shared_ptr<ASTNode> start;
+    if (!isOp(":")) start = parseComparison();
+
+    if (isOp("]")) {
+        advance();
+        if (!start) throw std::runtime_error("Expected index");
+        return std::make_shared<SubscriptNode>(object, start);
+    }
+    if (!isOp(":")) throw std::runtime_error("Expected ']'");
+    advance();
+
+    std::shared_ptr<ASTNode> stop;
+    std::shared_ptr<ASTNode> step;
+    if (!isOp(":") && !isOp("]")) stop = parseComparison();
+    if (isOp(":")) {
+        advance();
+        if (!isOp("]")) step = parseComparison();
+    }
+    if (!isOp("]")) throw std::runtime_error("Expected ']'");
+    advance();
+    return std::make_shared<SubscriptNode>(object, start, stop, step);
+}
+
+/**
+ * Разбирает литерал списка: выражения, разделённые запятыми, в квадратных скобках.
+ *
+ * @return Узел ListNode.
+ * @throws std::runtime_error Если список не закрыт ']'.
+ */
+std::shared_ptr<ASTNode> Parser::parseListLiteral() {
+    advance(); // пропускаем открывающую скобку
+
+    std::vector<std::shared_ptr<ASTNode>> elements;
+    while (!(peek().type == TOKEN_OP && peek().value == "]")) {
+        elements.push_back(parseComparison());
+        if (peek().type == TOKEN_OP && peek().value == ",") {
+            advance();
+            continue;
+        }
+        if (!(peek().type == TOKEN_OP && peek().value == "]")) throw std::runtime_error("Expected ']'");
+    }
+    advance();
+    return std::make_shared<ListNode>(elements);
+}
+
+/**
+ * Разбирает список аргументов вызова: выражения, разделённые запятыми, в круглых скобках.
+ *
+ * @return Вектор узлов AST аргументов (возможно, пустой).
+ * @throws std::runtime_error Если список не начинается с '(' или не закрыт ')'.
+ */
+std::vector<std::shared_ptr<ASTNode>> Parser::parseArguments() {
+    if (peek().type != TOKEN_OP || peek().value != "(") throw std::runtime_error("Expected '('");
+    advance();
+
+    std::vector<std::shared_ptr<ASTNode>> args;
+    if (peek().type == TOKEN_OP && peek().value == ")") {
+        advance();
+        return args;
+    }
+    while (true) {
+        args.push_back(parseComparison());
+        if (peek().type == TOKEN_OP && peek().value == ",") {
+            advance();
+            continue;
+        }
+        if (peek().type == TOKEN_OP && peek().value == ")") {
+            advance();
+            return args;
+        }
+        throw std::runtime_error("Expected ',' or ')' in argument list");
+    }
+}
+
 /**
  * Разбирает следующее первичное выражение из потока токенов.
  * Первичные выражения включают литералы (числа, строки, логические значения),
@@ -208,6 +354,8 @@ std::shared_ptr<ASTNode> Parser::parsePrimary() {
             return parseNumberToken();
         case TOKEN_STRING:
             return parseStringToken();
+        case TOKEN_BYTES:
+            return parseBytesToken();
         case TOKEN_BOOL:
             return parseBoolToken();
         case TOKEN_ID:
@@ -216,11 +364,36 @@ std::shared_ptr<ASTNode> Parser::parsePrimary() {
             if (token.value == "(") {
                 return parseParenthesizedExpression();
             }
+            if (token.value == "[") {
+                return parseListLiteral();
+            }
             break;
         case TOKEN_KEYWORD:
             if (token.value == "if") {
                 return parseIfStatement();
             }
+            if (token.value == "while") {
+                return parseWhileStatement();
+            }
+            if (token.value == "import") {
+                return parseImportStatement();
+            }
+            if (token.value == "def") {
+                return parseFunctionDefinition();
+            }
+            if (token.value == "async") {
+                advance();
+                if (peek().type != TOKEN_KEYWORD || peek().value != "def") {
+                    throw std::runtime_error("Expected 'def' after 'async'");
+                }
+                return parseFunctionDefinition(true);
+            }
+            if (token.value == "await") {
+                return parseAwaitExpression();
+            }
+            if (token.value == "return") {
+                return parseReturnStatement();
+            }
             break;
         case TOKEN_EOF:
             return nullptr;
@@ -233,24 +406,15 @@ std::shared_ptr<ASTNode> Parser::parsePrimary() {
 /**
  * Парсит токен числа и преобразует его в узел AST, представляющий числовое значение.
  *
- * Метод анализирует текущий токен, ожидая, что это числовое значение. Если в значении
- * токена есть одна десятичная точка, оно интерпретируется как число с плавающей точкой.
- * Если точек нет, значение интерпретируется как целое число. В случае некорректного формата
- * выбрасывается исключение.
+ * Литерал без точки и экспоненты (в том числе с префиксом `0x`, `0o`, `0b`) становится целым числом,
+ * остальные — числом с плавающей точкой (см. `NumberFormat::parseLiteral`).
  *
  * @return Умный указатель на узел AST, представляющий числовое значение.
  *         Узел может содержать либо целое число, либо число с плавающей точкой.
  * @throws std::runtime_error В случае некорректного формата числа.
  */
 std::shared_ptr<ASTNode> Parser::parseNumberToken() {
-    switch (const Token token = advance(); token.value.count('.')) {
-        case 0:
-            return std::make_shared<ValueNode>(Value(token.value.toInt()));
-        case 1:
-            return std::make_shared<ValueNode>(Value(token.value.toDouble()));
-        default:
-            throw std::runtime_error("Invalid number format");
-    }
+    return std::make_shared<ValueNode>(NumberFormat::parseLiteral(advance().value));
 }
 
 /**
@@ -263,6 +427,17 @@ std::shared_ptr<ASTNode> Parser::parseNumberToken() {
  */
 std::shared_ptr<ASTNode> Parser::parseStringToken() { return std::make_shared<ValueNode>(Value(advance().value)); }
 
+/**
+ * Парсит байтовый токен в узел синтаксического дерева. Лексер уже заменил экранирующие
+ * последовательности, поэтому каждый символ значения токена соответствует одному байту.
+ *
+ * @return Узел AST (ValueNode), содержащий значение типа `bytes`.
+ */
+std::shared_ptr<ASTNode> Parser::parseBytesToken() {
+    const QByteArray bytes = advance().value.toLatin1();
+    return std::make_shared<ValueNode>(Value(std::make_shared<Bytes>(std::string(bytes.data(), bytes.size()), false)));
+}
+
 /**
  * Парсит логический токен в узел синтаксического дерева.
  *
@@ -281,11 +456,18 @@ std::shared_ptr<ASTNode> Parser::parseBoolToken() { return std::make_shared<Valu
  * Парсит токен идентификатора и создает узел абстрактного синтаксического дерева (AST) для переменной.
  *
  * Метод интерпретирует текущий токен как идентификатор переменной, создает соответствующий объект
- * VarNode и перемещает указатель чтения на следующий токен.
+ * VarNode и перемещает указатель чтения на следующий токен. Если за идентификатором следует
+ * открывающая скобка, создаётся узел вызова функции CallNode.
  *
- * @return Умный указатель на вновь созданный узел VarNode, представляющий переменную.
+ * @return Умный указатель на вновь созданный узел VarNode или CallNode.
  */
-std::shared_ptr<ASTNode> Parser::parseIdentifierToken() { return std::make_shared<VarNode>(advance().value); }
+std::shared_ptr<ASTNode> Parser::parseIdentifierToken() {
+    QString name = advance().value;
+    if (peek().type == TOKEN_OP && peek().value == "(") {
+        return std::make_shared<CallNode>(name, parseArguments());
+    }
+    return std::make_shared<VarNode>(name);
+}
 
 /**
  * Разбирает выражение, заключенное в круглые скобки, и возвращает узел AST,
@@ -360,6 +542,142 @@ std::shared_ptr<ASTNode> Parser::parseIfStatement() {
     return std::make_shared<IfNode>(condition, body, elifs, elseBody);
 }
 
+std::shared_ptr<ASTNode> Parser::parseWhileStatement() {
+    advance();
+
+    auto condition = parseAssignment();
+
+    if (peek().type != TOKEN_OP || peek().value != ":") {
+        throw std::runtime_error("Expected ':' after while condition");
+    }
+    advance();
+
+    return std::make_shared<WhileNode>(condition, parseBlock());
+}
+
+std::shared_ptr<ASTNode> Parser::parseImportStatement() {
+    advance();
+
+    if (peek().type != TOKEN_ID) {
+        throw std::runtime_error("Expected module name after import");
+    }
+    return std::make_shared<ImportNode>(advance().value);
+}
+
+/**
+ * Разбирает заголовок `def name(a, b):` (для `async def` — начиная с `def`). Тело не разбирается:
+ * после предварительной проверки его токены (от перевода строки после ':' до завершающего DEDENT)
+ * сохраняются в узле FunctionNode.
+ */
+std::shared_ptr<ASTNode> Parser::parseFunctionDefinition(const bool isAsync) {
+    advance();
+
+    if (peek().type != TOKEN_ID) {
+        throw std::runtime_error("Expected function name after def");
+    }
+    QString name = advance().value;
+
+    if (peek().type != TOKEN_OP || peek().value != "(") {
+        throw std::runtime_error("Expected '(' after function name");
+    }
+    advance();
+
+    std::vector<QString> params;
+    while (peek().type != TOKEN_OP || peek().value != ")") {
+        if (peek().type != TOKEN_ID) throwUnexpectedTokenError(peek());
+        QString param = advance().value;
+        if (std::find(params.begin(), params.end(), param) != params.end()) {
+            throw std::runtime_error("Duplicate argument '" + param.toStdString() + "' in function definition");
+        }
+        params.push_back(std::move(param));
+        if (peek().type == TOKEN_OP && peek().value == ",") advance();
+        else if (peek().type != TOKEN_OP || peek().value != ")") throwUnexpectedTokenError(peek());
+    }
+    advance();
+
+    if (peek().type != TOKEN_OP || peek().value != ":") {
+        throw std::runtime_error("Expected ':' after function signature");
+    }
+    advance();
+
+    const int begin = current;
+    current = skipFunctionBody();
+    return std::make_shared<FunctionNode>(std::move(name), std::move(params), tokens.mid(begin, current - begin), isAsync);
+}
+
+/**
+ * Проходит тело функции, начиная с текущего токена, считая только отступы и скобки.
+ * Тело должно начинаться переводом строки и INDENT и заканчиваться парным ему DEDENT;
+ * скобки внутри тела должны быть сбалансированы.
+ *
+ * @throws std::runtime_error Если структура тела нарушена.
+ */
+int Parser::skipFunctionBody() const {
+    int position = current;
+    if (position >= tokens.size() || tokens[position].type != TOKEN_NEWLINE)
+        throw std::runtime_error("Expected newline after statement");
+    ++position;
+    if (position >= tokens.size() || tokens[position].type != TOKEN_INDENT)
+        throw std::runtime_error("Expected indent after statement");
+    ++position;
+
+    int depth = 1;
+    int brackets = 0;
+    for (; position < tokens.size(); ++position) {
+        const Token &token = tokens[position];
+        if (token.type == TOKEN_INDENT) {
+            ++depth;
+        } else if (token.type == TOKEN_DEDENT) {
+            if (--depth == 0) {
+                if (brackets != 0) throw std::runtime_error("Unbalanced brackets in function body");
+                return position + 1;
+            }
+        } else if (token.type == TOKEN_OP) {
+            if (token.value == "(" || token.value == "[" || token.value == "{") {
+                ++brackets;
+            } else if (token.value == ")" || token.value == "]" || token.value == "}") {
+                if (--brackets < 0) throwUnexpectedTokenError(token);
+            }
+        }
+    }
+    throw std::runtime_error("Expected dedent after block");
+}
+
+std::vector<std::shared_ptr<ASTNode>> Parser::parseFunctionBody(const bool isAsync) {
+    inFunction = true;
+    inAsyncFunction = isAsync;
+    auto body = parseBlock();
+    if (peek().type != TOKEN_EOF) throwUnexpectedTokenError(peek());
+    return body;
+}
+
+/**
+ * Разбирает `await operand`. Операнд связывается сильнее бинарных операций, как в Python;
+ * допустимость положения `await` в инструкции проверяется после разбора тела
+ * (см. `AstTraversal::awaitingStatements`).
+ */
+std::shared_ptr<ASTNode> Parser::parseAwaitExpression() {
+    advance();
+
+    if (!inAsyncFunction) {
+        throw std::runtime_error("'await' outside async function");
+    }
+    return std::make_shared<AwaitNode>(parseUnaryMinus());
+}
+
+std::shared_ptr<ASTNode> Parser::parseReturnStatement() {
+    advance();
+
+    if (!inFunction) {
+        throw std::runtime_error("'return' outside function");
+    }
+    const LexTokenType next = peek().type;
+    if (next == TOKEN_NEWLINE || next == TOKEN_DEDENT || next == TOKEN_EOF) {
+        return std::make_shared<ReturnNode>(nullptr);
+    }
+    return std::make_shared<ReturnNode>(parseAssignment());
+}
+
 std::vector<std::shared_ptr<ASTNode>> Parser::parseBlock() {
     if (peek().type != TOKEN_NEWLINE)
         throw std::runtime_error("Expected newline after statement");
@@ -371,7 +689,7 @@ std::vector<std::shared_ptr<ASTNode>> Parser::parseBlock() {
 
     std::vector<std::shared_ptr<ASTNode>> statements;
     while (peek().type != TOKEN_DEDENT && peek().type != TOKEN_EOF) {
-        statements.push_back(parseAssignment());
+        statements.push_back(parseStatement());
         if (peek().type == TOKEN_NEWLINE)
             advance();
     }
@@ -385,6 +703,25 @@ std::vector<std::shared_ptr<ASTNode>> Parser::parseBlock() {
     return statements;
 }
 
+/**
+ * Разбирает очередную инструкцию. С кэшем инструкций сначала вычисляется протяжённость инструкции:
+ * если такая последовательность токенов уже разбиралась, берётся готовое дерево. Новое дерево
+ * сохраняется, только если парсер остановился ровно на вычисленной границе.
+ */
+std::shared_ptr<ASTNode> Parser::parseStatement() {
+    if (!cache) return parseAssignment();
+
+    const int start = current;
+    int end;
+    const QString key = StatementCache::key(tokens, start, end);
+    if (auto statement = cache->find(key)) {
+        current = end;
+        return statement;
+    }
+    auto statement = parseAssignment();
+    if (current == end && statement) cache->store(key, statement);
+    return statement;
+}
 
 /**
  * Возвращает текущий токен из потока, не изменяя указываемую позицию токена.
@@ -407,3 +744,71 @@ Token Parser::peek() const { return (current < tokens.size()) ? tokens[current]
  *         файла (TOKEN_EOF).
  */
 Token Parser::advance() { return (current < tokens.size()) ? tokens[current++] : Token(TOKEN_EOF, "", 0); }
+
+/**
+ * Вызывает функцию, определённую инструкцией `def`. Тело разбирается при первом вызове.
+ * Глубина вложенных вызовов ограничена maxRecursionDepth, а в задаче `GreenScheduler` — ещё
+ * и размером её стека (stackLimit), чтобы бесконечная рекурсия завершалась ошибкой, а не
+ * переполнением стека интерпретатора. Каждый вызов — шаг задачи
+ * (см. `GreenScheduler::step`).
+ *
+ * @param args Вычисленные аргументы.
+ * @param caller Окружение вызывающего кода; родителем окружения функции становится окружение модуля.
+ * @return Значение `return` или 0.
+ */
+Value FunctionNode::call(const std::vector<Value> &args, Environment &caller) const {
+    if (args.size() != params.size()) {
+        throw std::runtime_error(QString("%1() takes %2 positional arguments but %3 were given")
+            .arg(name).arg(params.size()).arg(args.size()).toStdString());
+    }
+    parse();
+    if (isAsync) {
+        return Value(Value::AwaitablePtr(std::make_shared<Coroutine>(shared_from_this(), args, caller.globals())));
+    }
+
+    const char marker = 0;
+    if (depth >= maxRecursionDepth ||
+        reinterpret_cast<std::uintptr_t>(&marker) < reinterpret_cast<std::uintptr_t>(stackLimit)) {
+        throw std::runtime_error("maximum recursion depth exceeded");
+    }
+    GreenScheduler::step();
+    struct DepthGuard {
+        DepthGuard() { ++depth; }
+        ~DepthGuard() { --depth; }
+    } guard;
+
+    Environment local(&caller.globals());
+    for (size_t i = 0; i < params.size(); ++i) {
+        local.set(params[i], args[i]);
+    }
+    for (const auto &stmt : body) {
+        stmt->eval(local);
+        if (local.returning) return local.returnValue;
+    }
+    return Value();
+}
+
+void FunctionNode::parse() const {
+    if (parsed) return;
+    body = Parser(tokens).parseFunctionBody(isAsync);
+    if (isAsync) awaiting = AstTraversal::awaitingStatements(body);
+    parsed = true;
+}
+
+/**
+ * Вызывает функцию пользователя, связанную с именем name.
+ *
+ * @throws std::runtime_error Если имя не определено или его значение не является функцией.
+ */
+Value CallNode::callUserFunction(const std::vector<Value> &argValues, Environment &env) const {
+    const Value *callee = env.find(name);
+    if (!callee) {
+        throw std::runtime_error("name '" + name.toStdString() + "' is not defined");
+    }
+    const auto *function = std::get_if<Value::FunctionPtr>(&callee->data);
+    const auto definition = function ? std::dynamic_pointer_cast<FunctionNode>(**function) : nullptr;
+    if (!definition) {
+        throw std::runtime_error("'" + name.toStdString() + "' object is not callable");
+    }
+    return definition->call(argValues, env);
+}
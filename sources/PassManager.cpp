@@ -0,0 +1,54 @@
+#include "PassManager.h"
+#include "Passes.h"
+#include "TypeInference.h"
+
+PassManager PassManager::forLevel(const int level) {
+    PassManager manager;
+    if (level < 1) return manager;
+
+    //Удаление присваиваний, CSE и вынос инвариантов опираются на типы выражений;
+    //созданные ими узлы размечаются заново последним проходом
+    manager.add(std::make_unique<UnreachableBranchPass>());
+    manager.add(std::make_unique<TypeInferencePass>(false));
+    manager.add(std::make_unique<DeadStorePass>());
+    if (level >= 2) {
+        manager.add(std::make_unique<LoopInvariantPass>());
+        manager.add(std::make_unique<CommonSubexpressionPass>());
+    }
+    manager.add(std::make_unique<TypeInferencePass>(TypeInference::reportRegions));
+    return manager;
+}
+
+void PassManager::add(std::unique_ptr<Pass> pass) {
+    passes.push_back({std::move(pass)});
+}
+
+void PassManager::run(std::shared_ptr<ASTNode> &root, Environment &env) {
+    for (Entry &entry : passes) {
+        const auto start = std::chrono::steady_clock::now();
+        entry.pass->run(root, env);
+        entry.total += std::chrono::steady_clock::now() - start;
+        ++entry.runs;
+    }
+}
+
+QString PassManager::timingReport() const {
+    QString result;
+    for (const Entry &entry : passes) {
+        const double ms = std::chrono::duration<double, std::milli>(entry.total).count();
+        result += QString("pass %1: %2 ms in %3 runs\n").arg(entry.pass->name()).arg(ms).arg(entry.runs);
+    }
+    return result;
+}
+
+bool PassManager::parseFlag(const QString &flag) {
+    if (flag == "-O0" || flag == "-O1" || flag == "-O2") {
+        optimizationLevel = flag.mid(2).toInt();
+        return true;
+    }
+    if (flag == "--time-passes") {
+        timePasses = true;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,296 @@
+#include "Passes.h"
+#include "TypeInference.h"
+#include <algorithm>
+#include <iostream>
+#include <unordered_set>
+
+namespace {
+
+bool isStatement(const ASTNode *node) {
+    return dynamic_cast<const AssignNode *>(node) || dynamic_cast<const AugAssignNode *>(node) ||
+           dynamic_cast<const IfNode *>(node) || dynamic_cast<const WhileNode *>(node) ||
+           dynamic_cast<const BlockNode *>(node) || dynamic_cast<const FunctionNode *>(node) ||
+           dynamic_cast<const ReturnNode *>(node);
+}
+
+/**
+ * Выражение, результат которого можно использовать повторно: чистая бинарная операция
+ * с доказанным числовым или логическим типом (значение неизменяемо).
+ */
+bool isReusable(const ASTNode *node) {
+    return dynamic_cast<const BinOpNode *>(node) && node->staticType != StaticType::Unknown &&
+           AstTraversal::isPure(node);
+}
+
+std::vector<QString> readVariables(ASTNode *node) {
+    std::vector<QString> result;
+    if (const auto *var = dynamic_cast<VarNode *>(node)) result.push_back(var->name);
+    for (ASTNode *child : AstTraversal::children(node)) {
+        const auto nested = readVariables(child);
+        result.insert(result.end(), nested.begin(), nested.end());
+    }
+    return result;
+}
+
+void forEachLoop(ASTNode *node, const std::function<void(WhileNode &)> &visit) {
+    if (auto *loop = dynamic_cast<WhileNode *>(node)) visit(*loop);
+    for (AstTraversal::Block *block : AstTraversal::blocks(node)) {
+        for (const auto &stmt : *block) forEachLoop(stmt.get(), visit);
+    }
+}
+
+}
+
+void TypeInferencePass::run(std::shared_ptr<ASTNode> &root, Environment &env) {
+    TypeInference inference(env);
+    inference.run(*root);
+    if (report) std::cerr << inference.report().toStdString();
+}
+
+void UnreachableBranchPass::run(std::shared_ptr<ASTNode> &root, Environment &) {
+    AstTraversal::Block top = {root};
+    simplifyBlock(top);
+    root = top.size() == 1 ? top.front() : std::make_shared<BlockNode>(std::move(top));
+}
+
+/**
+ * Вычисляет условие, состоящее только из литералов и бинарных операций.
+ *
+ * @return Значение условия или std::nullopt, если условие зависит от переменных или вычисляется с ошибкой.
+ */
+std::optional<bool> UnreachableBranchPass::constantCondition(const ASTNode *condition) {
+    std::function<bool(const ASTNode *)> isConstant = [&isConstant](const ASTNode *node) {
+        if (dynamic_cast<const ValueNode *>(node)) return true;
+        const auto *bin = dynamic_cast<const BinOpNode *>(node);
+        return bin && isConstant(bin->left.get()) && isConstant(bin->right.get());
+    };
+    if (!isConstant(condition)) return std::nullopt;
+    try {
+        Environment scratch;
+        return condition->eval(scratch).toBool();
+    } catch (const std::runtime_error &) {
+        return std::nullopt;
+    }
+}
+
+void UnreachableBranchPass::simplifyBlock(AstTraversal::Block &block) {
+    AstTraversal::Block result;
+    for (const auto &stmt : block) {
+        for (AstTraversal::Block *nested : AstTraversal::blocks(stmt.get())) simplifyBlock(*nested);
+
+        auto *branch = dynamic_cast<IfNode *>(stmt.get());
+        if (!branch) {
+            result.push_back(stmt);
+            continue;
+        }
+
+        //Ветви в порядке проверки; ветвь с истинным постоянным условием становится else
+        std::vector<std::pair<std::shared_ptr<ASTNode>, AstTraversal::Block>> arms = {{branch->condition, branch->body}};
+        arms.insert(arms.end(), branch->elifs.begin(), branch->elifs.end());
+        std::vector<std::pair<std::shared_ptr<ASTNode>, AstTraversal::Block>> kept;
+        AstTraversal::Block elseBody = branch->elseBody;
+        bool changed = false;
+        for (auto &arm : arms) {
+            const auto constant = constantCondition(arm.first.get());
+            if (!constant) {
+                kept.push_back(std::move(arm));
+                continue;
+            }
+            changed = true;
+            if (*constant) {
+                elseBody = std::move(arm.second);
+                break;
+            }
+        }
+
+        if (!changed) {
+            result.push_back(stmt);
+        } else if (kept.empty()) {
+            result.insert(result.end(), elseBody.begin(), elseBody.end());
+        } else {
+            auto condition = kept.front().first;
+            auto body = std::move(kept.front().second);
+            kept.erase(kept.begin());
+            result.push_back(std::make_shared<IfNode>(std::move(condition), std::move(body), std::move(kept), std::move(elseBody)));
+        }
+    }
+    block = std::move(result);
+}
+
+void DeadStorePass::run(std::shared_ptr<ASTNode> &root, Environment &env) {
+    //Инструкция верхнего уровня не удаляется: её значение выводится в REPL
+    this->env = &env;
+    for (AstTraversal::Block *block : AstTraversal::blocks(root.get())) eliminate(*block);
+}
+
+/**
+ * Проверяет, что вычисление выражения не может завершиться ошибкой: операнды — литералы и
+ * определённые переменные, типы доказаны, деление возможно только на ненулевую константу.
+ */
+bool DeadStorePass::cannotFail(const ASTNode *node, const std::unordered_set<QString> &assigned) const {
+    if (dynamic_cast<const ValueNode *>(node)) return true;
+    if (const auto *var = dynamic_cast<const VarNode *>(node)) return assigned.count(var->name) || env->find(var->name);
+    if (const auto *temp = dynamic_cast<const TempNode *>(node)) return cannotFail(temp->expr.get(), assigned);
+
+    const auto *bin = dynamic_cast<const BinOpNode *>(node);
+    if (!bin || bin->staticType == StaticType::Unknown) return false;
+    if (bin->op == "/" || bin->op == "//" || bin->op == "%") {
+        const auto *divisor = dynamic_cast<const ValueNode *>(bin->right.get());
+        if (!divisor || !divisor->value.toBool()) return false;
+    }
+    return cannotFail(bin->left.get(), assigned) && cannotFail(bin->right.get(), assigned);
+}
+
+/**
+ * Проверяет, что значение, присвоенное переменной name инструкцией block[index], перезаписывается
+ * до первого чтения. Промежуточные инструкции не должны завершаться ошибкой: иначе после ошибки
+ * в окружении осталось бы видимое значение удалённого присваивания.
+ */
+bool DeadStorePass::isOverwritten(const AstTraversal::Block &block, const size_t index, const QString &name) const {
+    std::unordered_set<QString> assigned;
+    for (size_t j = 0; j <= index; ++j) {
+        for (const QString &var : AstTraversal::assignedVariables(block[j].get())) assigned.insert(var);
+    }
+
+    for (size_t j = index + 1; j < block.size(); ++j) {
+        ASTNode *stmt = block[j].get();
+        if (AstTraversal::reads(stmt, name)) return false;
+        if (const auto *assign = dynamic_cast<AssignNode *>(stmt)) {
+            if (!cannotFail(assign->valueExpr.get(), assigned)) return false;
+            if (assign->varName == name) return true;
+            assigned.insert(assign->varName);
+        } else if (const auto *aug = dynamic_cast<AugAssignNode *>(stmt)) {
+            if (aug->staticType == StaticType::Unknown || !cannotFail(aug->valueExpr.get(), assigned)) return false;
+        } else if (isStatement(stmt) || !cannotFail(stmt, assigned)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+void DeadStorePass::eliminate(AstTraversal::Block &block) {
+    for (const auto &stmt : block) {
+        for (AstTraversal::Block *nested : AstTraversal::blocks(stmt.get())) eliminate(*nested);
+    }
+
+    AstTraversal::Block result;
+    for (size_t i = 0; i < block.size(); ++i) {
+        ASTNode *stmt = block[i].get();
+        if (const auto *assign = dynamic_cast<AssignNode *>(stmt); assign && isOverwritten(block, i, assign->varName)) {
+            //вычисление правой части сохраняется, если оно может завершиться ошибкой
+            if (!cannotFail(assign->valueExpr.get(), {})) result.push_back(assign->valueExpr);
+            continue;
+        }
+        if (!isStatement(stmt) && AstTraversal::isPure(stmt) && cannotFail(stmt, {})) continue;
+        result.push_back(block[i]);
+    }
+    block = std::move(result);
+}
+
+void CommonSubexpressionPass::run(std::shared_ptr<ASTNode> &root, Environment &) {
+    AstTraversal::Block top = {root};
+    eliminate(top);
+    root = top.front();
+}
+
+/**
+ * Ключ структурного сравнения выражений. В отличие от toString() различает литералы
+ * разных типов (`1` и `1.0`).
+ */
+QString CommonSubexpressionPass::expressionKey(const ASTNode *node) {
+    if (const auto *temp = dynamic_cast<const TempNode *>(node)) return expressionKey(temp->expr.get());
+    if (const auto *var = dynamic_cast<const VarNode *>(node)) return "v:" + var->name;
+    if (const auto *value = dynamic_cast<const ValueNode *>(node)) {
+        return QString::number(static_cast<int>(value->staticType)) + ":" + value->toString();
+    }
+    const auto *bin = static_cast<const BinOpNode *>(node);
+    return "(" + expressionKey(bin->left.get()) + " " + bin->op + " " + expressionKey(bin->right.get()) + ")";
+}
+
+void CommonSubexpressionPass::eliminate(AstTraversal::Block &block) {
+    struct Available {
+        std::shared_ptr<ASTNode> *first; //место первого вхождения в дереве
+        ASTNode *statement; //инструкция, содержащая первое вхождение
+        std::shared_ptr<TempNode::Slot> slot; //создаётся при первом повторе
+        std::vector<QString> variables;
+    };
+    std::unordered_map<QString, Available> available;
+    ASTNode *current = nullptr;
+
+    //Обход в прямом порядке: узел, найденный раньше, вычисляется раньше любого найденного позже
+    std::function<void(std::shared_ptr<ASTNode> &)> visit = [&](std::shared_ptr<ASTNode> &slot) {
+        ASTNode *node = slot.get();
+        const bool reusable = isReusable(node);
+        if (reusable) {
+            if (const auto it = available.find(expressionKey(node)); it != available.end()) {
+                Available &first = it->second;
+                if (!first.slot) {
+                    first.slot = std::make_shared<TempNode::Slot>();
+                    *first.first = std::make_shared<TempNode>(TempNode::Mode::Store, *first.first, first.slot);
+                    AstTraversal::refresh(first.statement);
+                }
+                slot = std::make_shared<TempNode>(TempNode::Mode::Load, slot, first.slot);
+                return;
+            }
+        }
+        AstTraversal::forEachExpression(node, visit);
+        if (reusable) available.emplace(expressionKey(node), Available{&slot, current, nullptr, readVariables(node)});
+    };
+
+    for (auto &stmt : block) {
+        for (AstTraversal::Block *nested : AstTraversal::blocks(stmt.get())) eliminate(*nested);
+
+        const bool straightLine = dynamic_cast<AssignNode *>(stmt.get()) || dynamic_cast<AugAssignNode *>(stmt.get()) ||
+                                  !isStatement(stmt.get());
+        if (!straightLine || AstTraversal::callsUserCode(stmt.get())) {
+            available.clear();
+            continue;
+        }
+
+        current = stmt.get();
+        if (isStatement(stmt.get())) AstTraversal::forEachExpression(stmt.get(), visit);
+        else visit(stmt);
+
+        for (const QString &name : AstTraversal::assignedVariables(stmt.get())) {
+            for (auto it = available.begin(); it != available.end();) {
+                const auto &vars = it->second.variables;
+                if (std::find(vars.begin(), vars.end(), name) != vars.end()) it = available.erase(it);
+                else ++it;
+            }
+        }
+    }
+}
+
+void LoopInvariantPass::run(std::shared_ptr<ASTNode> &root, Environment &) {
+    forEachLoop(root.get(), [this](WhileNode &loop) { hoist(loop); });
+}
+
+void LoopInvariantPass::hoist(WhileNode &loop) {
+    if (AstTraversal::callsUserCode(&loop)) return;
+    const auto assignedList = AstTraversal::assignedVariables(&loop);
+    const std::unordered_set<QString> assigned(assignedList.begin(), assignedList.end());
+
+    std::function<void(std::shared_ptr<ASTNode> &)> visit = [&](std::shared_ptr<ASTNode> &slot) {
+        if (isReusable(slot.get())) {
+            const auto vars = readVariables(slot.get());
+            if (std::none_of(vars.begin(), vars.end(), [&assigned](const QString &name) { return assigned.count(name); })) {
+                auto value = std::make_shared<TempNode::Slot>();
+                loop.invariants.push_back(value);
+                slot = std::make_shared<TempNode>(TempNode::Mode::Cached, slot, value);
+                return;
+            }
+        }
+        AstTraversal::forEachExpression(slot.get(), visit);
+    };
+
+    std::function<void(ASTNode *)> walk = [&](ASTNode *stmt) {
+        AstTraversal::forEachExpression(stmt, visit);
+        for (AstTraversal::Block *block : AstTraversal::blocks(stmt)) {
+            for (auto &nested : *block) {
+                if (isStatement(nested.get())) walk(nested.get());
+                else visit(nested);
+            }
+        }
+    };
+    walk(&loop);
+}
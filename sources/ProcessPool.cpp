@@ -0,0 +1,493 @@
+#include "ProcessPool.h"
+#include "Bytes.h"
+#include "GreenScheduler.h"
+#include "Output.h"
+#include "Parser.h"
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <unordered_set>
+#ifdef __linux__
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <ctime>
+#include <dirent.h>
+#include <new>
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#endif
+
+namespace {
+    enum class Kind : quint8 { Int, Double, Bool, String, Bytes, ByteArray, List, Dict };
+
+    template <typename T>
+    void put(std::string &out, const T value) {
+        out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    void putBytes(std::string &out, const char *data, const size_t size) {
+        put(out, static_cast<quint32>(size));
+        out.append(data, size);
+    }
+
+    void putText(std::string &out, const QString &text) {
+        const QByteArray utf8 = text.toUtf8();
+        putBytes(out, utf8.constData(), static_cast<size_t>(utf8.size()));
+    }
+
+    template <typename T>
+    T get(const std::string &in, size_t &pos) {
+        if (in.size() - pos < sizeof(T)) throw std::runtime_error("Corrupted process_map() result");
+        T value;
+        std::memcpy(&value, in.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    std::string getBytes(const std::string &in, size_t &pos) {
+        const auto size = get<quint32>(in, pos);
+        if (in.size() - pos < size) throw std::runtime_error("Corrupted process_map() result");
+        std::string result = in.substr(pos, size);
+        pos += size;
+        return result;
+    }
+
+    QString getText(const std::string &in, size_t &pos) {
+        const std::string utf8 = getBytes(in, pos);
+        return QString::fromUtf8(utf8.data(), static_cast<qsizetype>(utf8.size()));
+    }
+
+    /**
+     * Контейнеры, которые кодируются сейчас: контейнер, содержащий себя, записать нельзя.
+     */
+    void encodeValue(const Value &value, std::string &out, std::unordered_set<const void *> &active) {
+        if (const auto *i = std::get_if<int>(&value.data)) {
+            put(out, Kind::Int);
+            put(out, static_cast<qint32>(*i));
+        } else if (const auto *d = std::get_if<double>(&value.data)) {
+            put(out, Kind::Double);
+            put(out, *d);
+        } else if (const auto *b = std::get_if<bool>(&value.data)) {
+            put(out, Kind::Bool);
+            put(out, static_cast<quint8>(*b));
+        } else if (const auto *str = std::get_if<Value::StringPtr>(&value.data)) {
+            put(out, Kind::String);
+            putText(out, (*str)->flatten().toQString());
+        } else if (const auto *bytes = std::get_if<Value::BytesPtr>(&value.data)) {
+            put(out, (*bytes)->isMutable ? Kind::ByteArray : Kind::Bytes);
+            putBytes(out, (*bytes)->data.data(), (*bytes)->data.size());
+        } else if (const auto *list = std::get_if<Value::ListPtr>(&value.data)) {
+            if (!active.insert(list->get()).second) throw std::runtime_error("process_map() cannot transfer a recursive list");
+            put(out, Kind::List);
+            put(out, static_cast<quint32>((*list)->size()));
+            for (const Value &item : **list) encodeValue(item, out, active);
+            active.erase(list->get());
+        } else if (const auto *dict = std::get_if<Value::DictPtr>(&value.data)) {
+            if (!active.insert(dict->get()).second) throw std::runtime_error("process_map() cannot transfer a recursive dict");
+            put(out, Kind::Dict);
+            put(out, static_cast<quint32>((*dict)->size()));
+            for (auto it = (*dict)->cbegin(); it != (*dict)->cend(); ++it) {
+                putText(out, it.key());
+                encodeValue(it.value(), out, active);
+            }
+            active.erase(dict->get());
+        } else {
+            throw std::runtime_error("process_map() cannot transfer a function, memoryview, coroutine or file");
+        }
+    }
+}
+
+void ProcessPool::encode(const Value &value, std::string &out) {
+    std::unordered_set<const void *> active;
+    encodeValue(value, out, active);
+}
+
+Value ProcessPool::decode(const std::string &in, size_t &pos) {
+    switch (get<Kind>(in, pos)) {
+        case Kind::Int: return Value(static_cast<int>(get<qint32>(in, pos)));
+        case Kind::Double: return Value(get<double>(in, pos));
+        case Kind::Bool: return Value(get<quint8>(in, pos) != 0);
+        case Kind::String: return Value(getText(in, pos));
+        case Kind::Bytes: return Value(std::make_shared<Bytes>(getBytes(in, pos), false));
+        case Kind::ByteArray: return Value(std::make_shared<Bytes>(getBytes(in, pos), true));
+        case Kind::List: {
+            const auto count = get<quint32>(in, pos);
+            Value::List list;
+            list.reserve(std::min<size_t>(count, in.size() - pos));
+            for (quint32 i = 0; i < count; ++i) list.push_back(decode(in, pos));
+            return Value(std::move(list));
+        }
+        case Kind::Dict: {
+            const auto count = get<quint32>(in, pos);
+            Value::Dict dict;
+            for (quint32 i = 0; i < count; ++i) {
+                const QString key = getText(in, pos);
+                dict.insert(key, decode(in, pos));
+            }
+            return Value(std::move(dict));
+        }
+    }
+    throw std::runtime_error("Corrupted process_map() result");
+}
+
+#ifdef __linux__
+
+namespace {
+    constexpr size_t ringCapacity = 1 << 20;
+
+    static_assert(std::atomic<quint64>::is_always_lock_free, "process_map() needs lock-free 64-bit atomics in shared memory");
+
+    /**
+     * Общее состояние вызова в памяти, разделяемой с рабочими процессами.
+     */
+    struct Shared {
+        std::atomic<quint64> nextChunk{0};
+        std::atomic<bool> failed{false};
+        sem_t ready; //рабочий процесс записал данные в свой буфер
+    };
+
+    /**
+     * Кольцевой буфер одного рабочего процесса: поток байтов от процесса к родителю. Счётчики
+     * записанных и прочитанных байтов только растут; позиция в буфере — остаток от деления на ёмкость.
+     */
+    struct Ring {
+        std::atomic<quint64> written{0};
+        std::atomic<quint64> consumed{0};
+        sem_t space; //родитель освободил место
+        char data[ringCapacity];
+
+        /**
+         * Записывает size байт, ожидая освобождения места, если буфер заполнен.
+         */
+        void write(const char *bytes, size_t size, Shared &shared) {
+            while (size != 0) {
+                const quint64 head = written.load(std::memory_order_relaxed);
+                const size_t free = ringCapacity - static_cast<size_t>(head - consumed.load(std::memory_order_acquire));
+                if (free == 0) {
+                    while (sem_wait(&space) < 0 && errno == EINTR) {}
+                    continue;
+                }
+                const size_t count = std::min(size, free);
+                const size_t offset = static_cast<size_t>(head % ringCapacity);
+                const size_t first = std::min(count, ringCapacity - offset);
+                std::memcpy(data + offset, bytes, first);
+                std::memcpy(data, bytes + first, count - first);
+                written.store(head + count, std::memory_order_release);
+                sem_post(&shared.ready);
+                bytes += count;
+                size -= count;
+            }
+        }
+
+        /**
+         * Дописывает в out все записанные байты и освобождает их место.
+         */
+        void read(std::string &out) {
+            const quint64 tail = consumed.load(std::memory_order_relaxed);
+            const quint64 head = written.load(std::memory_order_acquire);
+            if (head == tail) return;
+            const size_t count = static_cast<size_t>(head - tail);
+            const size_t offset = static_cast<size_t>(tail % ringCapacity);
+            const size_t first = std::min(count, ringCapacity - offset);
+            out.append(data + offset, first);
+            out.append(data, count - first);
+            consumed.store(head, std::memory_order_release);
+            sem_post(&space);
+        }
+    };
+
+    /**
+     * Общая память вызова и рабочие процессы. Процессы, не завершившиеся к моменту уничтожения
+     * (родитель прервался ошибкой), завершаются принудительно.
+     */
+    struct Workers {
+        explicit Workers(const size_t count) : count(count) {
+            size = sizeof(Shared) + (sizeof(Shared) % alignof(Ring) ? alignof(Ring) - sizeof(Shared) % alignof(Ring) : 0);
+            const size_t ringsOffset = size;
+            size += count * sizeof(Ring);
+            int flags = MAP_SHARED | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+            flags |= MAP_NORESERVE; //страницы буферов выделяются по мере записи
+#endif
+            memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (memory == MAP_FAILED) throw std::runtime_error(std::string("process_map(): ") + std::strerror(errno));
+            shared = new (memory) Shared;
+            sem_init(&shared->ready, 1, 0);
+            rings = reinterpret_cast<Ring *>(static_cast<char *>(memory) + ringsOffset);
+            for (size_t i = 0; i < count; ++i) {
+                new (&rings[i]) Ring;
+                sem_init(&rings[i].space, 1, 0);
+            }
+        }
+
+        ~Workers() {
+            for (const pid_t pid : pids) {
+                if (pid <= 0) continue;
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+            }
+            for (size_t i = 0; i < count; ++i) sem_destroy(&rings[i].space);
+            sem_destroy(&shared->ready);
+            munmap(memory, size);
+        }
+
+        Workers(const Workers &) = delete;
+        Workers &operator=(const Workers &) = delete;
+
+        size_t count;
+        size_t size = 0;
+        void *memory = nullptr;
+        Shared *shared = nullptr;
+        Ring *rings = nullptr;
+        std::vector<pid_t> pids; //0 — процесс завершён и ожидание выполнено
+    };
+
+    struct Job {
+        std::shared_ptr<FunctionNode> function;
+        const Value::List &items;
+        size_t chunkSize;
+        size_t chunkCount;
+    };
+
+    /**
+     * Тело рабочего процесса: берёт части из общего счётчика и записывает в буфер запись
+     * `[длина][часть][успех][вывод][результаты или текст ошибки]`.
+     */
+    [[noreturn]] void work(const Job &job, Environment &env, Shared &shared, Ring &ring) {
+        int status = 0;
+        try {
+            while (!shared.failed.load(std::memory_order_relaxed)) {
+                const auto chunk = static_cast<size_t>(shared.nextChunk.fetch_add(1));
+                if (chunk >= job.chunkCount) break;
+                const size_t begin = chunk * job.chunkSize;
+                const size_t end = std::min(job.items.size(), begin + job.chunkSize);
+
+                std::string output;
+                std::string body;
+                bool ok = true;
+                {
+                    const Output::Capture capture(output);
+                    try {
+                        for (size_t i = begin; i < end; ++i) ProcessPool::encode(job.function->call({job.items[i]}, env), body);
+                    } catch (const std::exception &e) {
+                        ok = false;
+                        body.clear();
+                        putText(body, QString::fromUtf8(e.what()));
+                        shared.failed = true;
+                    }
+                }
+
+                std::string record;
+                put(record, quint32{0});
+                put(record, static_cast<quint32>(chunk));
+                put(record, static_cast<quint8>(ok));
+                putBytes(record, output.data(), output.size());
+                record += body;
+                const auto length = static_cast<quint32>(record.size() - sizeof(quint32));
+                std::memcpy(record.data(), &length, sizeof(length));
+                ring.write(record.data(), record.size(), shared);
+            }
+        } catch (...) {
+            status = 1;
+        }
+        sem_post(&shared.ready);
+        _exit(status); //без обработчиков atexit и сброса буферов, унаследованных от родителя
+    }
+
+    /**
+     * Результаты вызова, собираемые родителем.
+     */
+    struct Results {
+        explicit Results(const Job &job) : job(job), values(job.items.size()), outputs(job.chunkCount) {}
+
+        const Job &job;
+        Value::List values;
+        std::vector<std::string> outputs;
+        size_t received = 0;
+        size_t errorChunk = std::numeric_limits<size_t>::max();
+        std::string error;
+
+        [[nodiscard]] bool failed() const { return errorChunk != std::numeric_limits<size_t>::max(); }
+
+        void fail(const size_t chunk, std::string message) {
+            if (chunk < errorChunk) {
+                errorChunk = chunk;
+                error = std::move(message);
+            }
+        }
+
+        /**
+         * Разбирает завершённые записи из начала pending.
+         */
+        void parse(std::string &pending) {
+            size_t pos = 0;
+            while (pending.size() - pos >= sizeof(quint32)) {
+                quint32 length;
+                std::memcpy(&length, pending.data() + pos, sizeof(length));
+                if (pending.size() - pos - sizeof(quint32) < length) break;
+                const std::string record = pending.substr(pos + sizeof(quint32), length);
+                pos += sizeof(quint32) + length;
+
+                size_t at = 0;
+                const auto chunk = static_cast<size_t>(get<quint32>(record, at));
+                if (chunk >= job.chunkCount) throw std::runtime_error("Corrupted process_map() result");
+                const bool ok = get<quint8>(record, at) != 0;
+                outputs[chunk] = getBytes(record, at);
+                if (ok) {
+                    const size_t end = std::min(job.items.size(), (chunk + 1) * job.chunkSize);
+                    for (size_t i = chunk * job.chunkSize; i < end; ++i) values[i] = ProcessPool::decode(record, at);
+                } else {
+                    fail(chunk, getText(record, at).toStdString());
+                }
+                ++received;
+            }
+            pending.erase(0, pos);
+        }
+    };
+
+    std::shared_ptr<FunctionNode> functionOf(const Value &value) {
+        const auto *function = std::get_if<Value::FunctionPtr>(&value.data);
+        return function ? std::dynamic_pointer_cast<FunctionNode>(**function) : nullptr;
+    }
+
+    /**
+     * Число потоков процесса (записи /proc/self/task).
+     */
+    size_t threadCount() {
+        DIR *tasks = opendir("/proc/self/task");
+        if (!tasks) return 1;
+        size_t count = 0;
+        while (const dirent *entry = readdir(tasks)) {
+            if (entry->d_name[0] != '.') ++count;
+        }
+        closedir(tasks);
+        return count;
+    }
+
+    /**
+     * Завершает простаивающие потоки общего пула (следующая задача пула запустит их снова) и проверяет,
+     * что других потоков нет. Присоединённый поток исчезает из /proc/self/task не мгновенно,
+     * поэтому проверка повторяется в течение 100 мс.
+     */
+    bool singleThreaded() {
+        WorkStealingPool::global().quiesce();
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            if (threadCount() <= 1) return true;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return false;
+    }
+
+    /**
+     * Разбирает тела глобальных функций до fork, чтобы процессы не разбирали их каждый заново.
+     * Синтаксическая ошибка в теле функции, отличной от function, сообщается при её первом вызове,
+     * как и без `process_map`.
+     */
+    void parseFunctions(const FunctionNode &function, const Environment &globals) {
+        function.parse();
+        for (const auto &[name, value] : globals.locals()) {
+            const auto global = functionOf(value);
+            if (!global) continue;
+            try {
+                global->parse();
+            } catch (const std::exception &) {
+                //тело будет разобрано и ошибка сообщена при вызове
+            }
+        }
+    }
+}
+
+/**
+ * По умолчанию список делится на четыре части на каждый процесс, как в `parallel_map`. Процессов
+ * столько же, сколько ядер, но не больше, чем частей. Если часть процессов создать не удалось,
+ * части выполняют остальные.
+ */
+Value ProcessPool::call(const std::vector<Value> &args, Environment &env) {
+    if (args.size() < 2 || args.size() > 3) {
+        throw std::runtime_error("process_map() takes 2 or 3 arguments (" + std::to_string(args.size()) + " given)");
+    }
+    const auto function = functionOf(args[0]);
+    if (!function) throw std::runtime_error("process_map() argument 1 must be a function");
+    const auto *list = std::get_if<Value::ListPtr>(&args[1].data);
+    if (!list) throw std::runtime_error("process_map() argument 2 must be a list");
+    if (GreenScheduler::inTask()) throw std::runtime_error("process_map() cannot be called from a green thread");
+    if (!singleThreaded()) { //дочерний процесс унаследовал бы мьютексы, захваченные другими потоками
+        throw std::runtime_error("process_map() cannot fork while other threads are running");
+    }
+    const Value::List &items = **list;
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    size_t chunkSize = std::max<size_t>(1, (items.size() + cores * 4 - 1) / (cores * 4));
+    if (args.size() == 3) {
+        const auto *requested = std::get_if<int>(&args[2].data);
+        if (!requested || *requested <= 0) throw std::runtime_error("process_map() chunksize must be a positive integer");
+        chunkSize = static_cast<size_t>(*requested);
+    }
+    if (items.empty()) return Value(Value::List());
+    parseFunctions(*function, env.globals());
+
+    const Job job{function, items, chunkSize, (items.size() + chunkSize - 1) / chunkSize};
+    Workers workers(std::min(cores, job.chunkCount));
+    for (size_t i = 0; i < workers.count; ++i) {
+        const pid_t pid = fork();
+        if (pid == 0) work(job, env, *workers.shared, workers.rings[i]);
+        if (pid < 0) {
+            if (i == 0) throw std::runtime_error(std::string("process_map(): ") + std::strerror(errno));
+            break;
+        }
+        workers.pids.push_back(pid);
+    }
+
+    Results results(job);
+    std::vector<std::string> pending(workers.pids.size());
+    size_t alive = workers.pids.size();
+    std::string crash;
+    while (results.received < job.chunkCount && alive != 0) {
+        timespec deadline{};
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100'000'000; //проверка аварийно завершившихся процессов
+        if (deadline.tv_nsec >= 1'000'000'000) {
+            ++deadline.tv_sec;
+            deadline.tv_nsec -= 1'000'000'000;
+        }
+        sem_timedwait(&workers.shared->ready, &deadline);
+
+        for (pid_t &pid : workers.pids) {
+            int status = 0;
+            if (pid == 0 || waitpid(pid, &status, WNOHANG) != pid) continue;
+            pid = 0;
+            --alive;
+            if (WIFSIGNALED(status)) crash = "process_map() worker terminated by signal " + std::to_string(WTERMSIG(status));
+            else if (WEXITSTATUS(status) != 0) crash = "process_map() worker failed";
+        }
+        for (size_t i = 0; i < pending.size(); ++i) { //после проверки процессов: записи завершившихся уже в буфере
+            workers.rings[i].read(pending[i]);
+            results.parse(pending[i]);
+        }
+        if (results.failed()) workers.shared->failed = true;
+    }
+    for (pid_t &pid : workers.pids) { //части закончились: процессы завершаются сами
+        if (pid != 0) waitpid(pid, nullptr, 0);
+        pid = 0;
+    }
+
+    for (const std::string &output : results.outputs) Output::write(output);
+    if (results.failed()) throw std::runtime_error(results.error);
+    if (results.received < job.chunkCount) throw std::runtime_error(crash.empty() ? "process_map() worker failed" : crash);
+    return Value(std::move(results.values));
+}
+
+#else
+
+Value ProcessPool::call(const std::vector<Value> &, Environment &) {
+    throw std::runtime_error("process_map() is only supported on Linux");
+}
+
+#endif
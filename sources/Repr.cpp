@@ -0,0 +1,190 @@
+#include "Repr.h"
+#include "Coroutine.h"
+#include "File.h"
+#include "NumberFormat.h"
+#include <algorithm>
+#include <charconv>
+#include <type_traits>
+
+namespace {
+    void appendPoint(std::string &out, const char32_t point) {
+        if (point < 0x80) {
+            out += static_cast<char>(point);
+        } else if (point < 0x800) {
+            out += static_cast<char>(0xC0 | point >> 6);
+            out += static_cast<char>(0x80 | (point & 0x3F));
+        } else if (point < 0x10000) {
+            out += static_cast<char>(0xE0 | point >> 12);
+            out += static_cast<char>(0x80 | (point >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (point & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | point >> 18);
+            out += static_cast<char>(0x80 | (point >> 12 & 0x3F));
+            out += static_cast<char>(0x80 | (point >> 6 & 0x3F));
+            out += static_cast<char>(0x80 | (point & 0x3F));
+        }
+    }
+
+    /**
+     * Применяет f к каждой кодовой точке строки str.
+     */
+    template <typename F>
+    void forEachPoint(const CompactString &str, F &&f) {
+        str.visit([&f](const auto &data) {
+            using Char = typename std::decay_t<decltype(data)>::value_type;
+            for (const Char ch : data) f(static_cast<char32_t>(static_cast<std::make_unsigned_t<Char>>(ch)));
+        });
+    }
+
+    void appendHex(std::string &out, const char prefix, const char32_t point, const int digits) {
+        static const char hex[] = "0123456789abcdef";
+        out += '\\';
+        out += prefix;
+        for (int shift = (digits - 1) * 4; shift >= 0; shift -= 4) out += hex[point >> shift & 0xF];
+    }
+}
+
+Repr::Repr(std::string &out, const size_t maxSize) : out(out), start(out.size()), maxSize(maxSize) {}
+
+Repr &Repr::repr(const Value &value) {
+    if (cut) return *this;
+    if (const auto *number = std::get_if<int>(&value.data)) {
+        char digits[16];
+        const auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), *number);
+        out.append(digits, end);
+    } else if (const auto *real = std::get_if<double>(&value.data)) {
+        NumberFormat::append(out, *real);
+    } else if (const auto *flag = std::get_if<bool>(&value.data)) {
+        out += *flag ? "True" : "False";
+    } else if (const auto *str = std::get_if<Value::StringPtr>(&value.data)) {
+        writeString((*str)->flatten());
+    } else if (const auto *list = std::get_if<Value::ListPtr>(&value.data)) {
+        writeList(**list);
+    } else if (const auto *dict = std::get_if<Value::DictPtr>(&value.data)) {
+        writeDict(**dict);
+    } else if (std::holds_alternative<Value::FunctionPtr>(value.data)) {
+        out += "<function>";
+    } else if (std::holds_alternative<Value::MemoryViewPtr>(value.data)) {
+        out += "<memory>";
+    } else if (const auto *bytes = std::get_if<Value::BytesPtr>(&value.data)) {
+        out += (*bytes)->repr().toStdString();
+    } else if (const auto *awaitable = std::get_if<Value::AwaitablePtr>(&value.data)) {
+        (*awaitable)->repr(out);
+    } else if (const auto *file = std::get_if<Value::FilePtr>(&value.data)) {
+        out += (*file)->repr().toStdString();
+    }
+    full();
+    return *this;
+}
+
+Repr &Repr::str(const Value &value) {
+    if (cut) return *this;
+    if (const auto *str = std::get_if<Value::StringPtr>(&value.data)) {
+        appendUtf8(out, (*str)->flatten());
+        full();
+        return *this;
+    }
+    return repr(value);
+}
+
+/**
+ * Строка Latin-1 из символов ASCII копируется целиком, остальные строки перекодируются по кодовым точкам.
+ */
+void Repr::appendUtf8(std::string &out, const CompactString &str) {
+    str.visit([&out, &str](const auto &data) {
+        using Char = typename std::decay_t<decltype(data)>::value_type;
+        if constexpr (std::is_same_v<Char, char>) {
+            if (str.isAscii()) {
+                out += data;
+                return;
+            }
+        }
+        for (const Char ch : data) appendPoint(out, static_cast<char32_t>(static_cast<std::make_unsigned_t<Char>>(ch)));
+    });
+}
+
+/**
+ * Строка записывается в одинарных кавычках, если она не содержит одинарную кавычку без двойной,
+ * иначе — в двойных. Обратная косая черта, выбранная кавычка и непечатаемые символы экранируются.
+ */
+void Repr::writeString(const CompactString &str) {
+    bool hasSingle = false;
+    bool hasDouble = false;
+    forEachPoint(str, [&](const char32_t point) {
+        hasSingle |= point == U'\'';
+        hasDouble |= point == U'"';
+    });
+    const char quote = hasSingle && !hasDouble ? '"' : '\'';
+
+    out += quote;
+    forEachPoint(str, [this, quote](const char32_t point) {
+        if (point == static_cast<char32_t>(quote) || point == U'\\') {
+            out += '\\';
+            out += static_cast<char>(point);
+        } else if (point == U'\n') {
+            out += "\\n";
+        } else if (point == U'\r') {
+            out += "\\r";
+        } else if (point == U'\t') {
+            out += "\\t";
+        } else if (point < 0x20 || (point >= 0x7F && point < 0xA0)) {
+            appendHex(out, 'x', point, 2);
+        } else if (point >= 0xD800 && point < 0xE000) {
+            appendHex(out, 'u', point, 4);
+        } else {
+            appendPoint(out, point);
+        }
+    });
+    out += quote;
+}
+
+void Repr::writeList(const Value::List &list) {
+    if (!enter(&list)) {
+        out += "[...]";
+        return;
+    }
+    out += '[';
+    for (size_t i = 0; i < list.size() && !cut; ++i) {
+        if (i > 0) out += ", ";
+        repr(list[i]);
+    }
+    if (!cut) out += ']';
+    active.pop_back();
+}
+
+void Repr::writeDict(const Value::Dict &dict) {
+    if (!enter(&dict)) {
+        out += "{...}";
+        return;
+    }
+    out += '{';
+    bool first = true;
+    for (auto it = dict.cbegin(); it != dict.cend() && !cut; ++it) {
+        if (!first) out += ", ";
+        first = false;
+        writeString(CompactString(it.key()));
+        out += ": ";
+        repr(it.value());
+    }
+    if (!cut) out += '}';
+    active.pop_back();
+}
+
+bool Repr::enter(const void *container) {
+    if (std::find(active.begin(), active.end(), container) != active.end()) return false;
+    active.push_back(container);
+    return true;
+}
+
+/**
+ * Текст обрезается по границе символа UTF-8, чтобы результат оставался корректной строкой.
+ */
+bool Repr::full() {
+    if (cut || maxSize == unlimited || out.size() - start <= maxSize) return cut;
+    size_t end = start + maxSize;
+    while (end > start && (static_cast<unsigned char>(out[end]) & 0xC0) == 0x80) --end;
+    out.resize(end);
+    out += "...";
+    cut = true;
+    return true;
+}
@@ -0,0 +1,185 @@
+#include "Rope.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * Создаёт плоскую строку с заданным содержимым.
+ *
+ * @param str Содержимое строки.
+ */
+Rope::Rope(CompactString str) : flat(std::move(str)), len(flat.length()) {
+}
+
+/**
+ * Создаёт узел отложенной конкатенации. Длина результата вычисляется сразу,
+ * а сами символы копируются только при первом вызове flatten().
+ *
+ * @param left Левая часть строки.
+ * @param right Правая часть строки.
+ */
+Rope::Rope(Ptr left, Ptr right) : left(std::move(left)), right(std::move(right)) {
+    len = this->left->len + this->right->len;
+}
+
+/**
+ * Создаёт срез плоской строки base без копирования символов.
+ *
+ * @param base Строка-источник (плоская).
+ * @param offset Начало среза.
+ * @param count Длина среза.
+ */
+Rope::Rope(Ptr base, const qsizetype offset, const qsizetype count) : base(std::move(base)), offset(offset) {
+    len = count;
+}
+
+/**
+ * Разрушает строку, итеративно освобождая узлы конкатенации, которыми больше никто не владеет.
+ *
+ * Рекурсивное разрушение цепочки из миллионов узлов `((a + b) + c) + ...` переполнило бы стек,
+ * поэтому дочерние узлы, у которых текущий узел — последний владелец, переносятся в явный стек
+ * и освобождаются уже без потомков.
+ */
+Rope::~Rope() {
+    std::vector<Ptr> pending;
+    if (left) pending.push_back(std::move(left));
+    if (right) pending.push_back(std::move(right));
+    if (base) pending.push_back(std::move(base));
+
+    while (!pending.empty()) {
+        Ptr node = std::move(pending.back());
+        pending.pop_back();
+        if (node.use_count() == 1) {
+            if (node->left) pending.push_back(std::move(node->left));
+            if (node->right) pending.push_back(std::move(node->right));
+            if (node->base) pending.push_back(std::move(node->base));
+        }
+    }
+}
+
+/**
+ * Создаёт строку, равную конкатенации двух строк, за O(1).
+ *
+ * Если один из операндов пуст, возвращается второй операнд без создания нового узла.
+ *
+ * @param left Левая часть результата.
+ * @param right Правая часть результата.
+ * @return Указатель на строку-результат.
+ */
+Rope::Ptr Rope::concat(const Ptr& left, const Ptr& right) {
+    if (left->isEmpty()) return right;
+    if (right->isEmpty()) return left;
+    return Ptr(new Rope(left, right));
+}
+
+/**
+ * Возвращает подстроку source длиной count, начиная с позиции start (шаг 1).
+ *
+ * Короткие подстроки копируются сразу. Подстроки длиной от MIN_SHARED_SLICE символов
+ * оформляются как узлы-срезы, ссылающиеся на буфер источника; срез среза ссылается
+ * непосредственно на исходный буфер.
+ *
+ * @param source Строка-источник.
+ * @param start Начало подстроки (0 <= start <= source->length()).
+ * @param count Длина подстроки (start + count <= source->length()).
+ * @return Указатель на подстроку.
+ */
+Rope::Ptr Rope::slice(const Ptr& source, const qsizetype start, const qsizetype count) {
+    if (start == 0 && count == source->len) return source;
+    if (count < MIN_SHARED_SLICE) {
+        if (source->base) return std::make_shared<Rope>(source->base->flat.mid(source->offset + start, count));
+        return std::make_shared<Rope>(source->flatten().mid(start, count));
+    }
+    if (source->base) return Ptr(new Rope(source->base, source->offset + start, count));
+    source->flatten();
+    return Ptr(new Rope(source, start, count));
+}
+
+/**
+ * Возвращает кодовую точку по индексу.
+ *
+ * Для срезов чтение выполняется из буфера источника без копирования. Если срез остался
+ * единственным владельцем источника, который более чем вчетверо длиннее среза, срез
+ * сначала копирует свой диапазон, чтобы освободить память источника.
+ *
+ * @param index Индекс символа (0 <= index < length()).
+ * @return Кодовая точка символа.
+ */
+char32_t Rope::at(const qsizetype index) const {
+    if (base) {
+        if (base.use_count() != 1 || len * 4 >= base->len) { //источник разделяется или заморожен (см. Frozen)
+            return base->flat.at(offset + index);
+        }
+    }
+    return flatten().at(index);
+}
+
+/**
+ * Дописывает содержимое piece в конец строки на месте.
+ *
+ * Строка сначала выравнивается (однократно), после чего данные дописываются в её буфер,
+ * рост которого амортизирован, так что серия вызовов append работает за линейное время.
+ * Метод изменяет строку, поэтому вызывающая сторона обязана убедиться, что на неё
+ * нет других ссылок.
+ *
+ * @param piece Дописываемая строка.
+ */
+void Rope::append(const Rope& piece) {
+    if (piece.isEmpty()) return;
+    flatten();
+    flat.append(piece.flatten());
+    len += piece.len;
+}
+
+/**
+ * Возвращает содержимое строки.
+ *
+ * Срез копирует свой диапазон из буфера источника и отпускает его.
+ * Если строка является узлом отложенной конкатенации, её листья собираются обходом слева направо
+ * с помощью явного стека. Буфер результата выделяется один раз — под итоговую длину и ширину
+ * самого широкого листа, — после чего листья копируются в него. Узел становится плоским
+ * и отпускает ссылки на операнды.
+ *
+ * @return Ссылка на содержимое строки.
+ */
+const CompactString& Rope::flatten() const {
+    if (isFlat()) return flat;
+    if (base) {
+        flat = base->flat.mid(offset, len);
+        base.reset();
+        return flat;
+    }
+
+    std::vector<const Rope*> leaves;
+    std::vector<const Rope*> stack;
+    CompactString::Kind kind = CompactString::Kind::Latin1;
+    stack.push_back(this);
+    while (!stack.empty()) {
+        const Rope* node = stack.back();
+        stack.pop_back();
+        if (!node->left) {
+            leaves.push_back(node);
+            kind = std::max(kind, node->base ? node->base->flat.kind() : node->flat.kind());
+            continue;
+        }
+        stack.push_back(node->right.get());
+        stack.push_back(node->left.get());
+    }
+
+    CompactString result;
+    result.reserve(len, kind);
+    bool hasSlices = false;
+    for (const Rope* leaf : leaves) {
+        if (leaf->base) {
+            result.append(leaf->base->flat, leaf->offset, leaf->len);
+            hasSlices = true;
+        } else {
+            result.append(leaf->flat);
+        }
+    }
+    if (hasSlices) result.normalize();
+
+    flat = std::move(result);
+    left.reset();
+    right.reset();
+    return flat;
+}
@@ -0,0 +1,103 @@
+#include "SimdScan.h"
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MYPYTHON_SSE2 1
+#endif
+
+/**
+ * Ищет needle в haystack начиная с позиции from.
+ *
+ * За один шаг SSE2 проверяются 16 возможных позиций начала: сравниваются первый и последний
+ * байты образца, и только для позиций, где совпали оба, выполняется полное сравнение.
+ * Хвост, не кратный 16, обрабатывается скалярно.
+ *
+ * @param haystack Данные, в которых выполняется поиск.
+ * @param size Размер haystack в байтах.
+ * @param needle Искомая последовательность.
+ * @param needleSize Размер needle в байтах.
+ * @param from Позиция, с которой начинается поиск.
+ * @return Индекс первого вхождения или -1, если вхождений нет.
+ */
+qsizetype SimdScan::find(const char *haystack, const qsizetype size, const char *needle, const qsizetype needleSize,
+                         const qsizetype from) {
+    if (needleSize == 0) return from <= size ? from : -1;
+    const qsizetype last = size - needleSize; // последняя допустимая позиция начала
+    qsizetype i = from;
+
+#ifdef MYPYTHON_SSE2
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i lastChar = _mm_set1_epi8(needle[needleSize - 1]);
+    for (; i + 15 <= last; i += 16) {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(haystack + i + needleSize - 1));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, lastChar))));
+        while (mask) {
+            const qsizetype pos = i + qCountTrailingZeroBits(mask);
+            if (std::memcmp(haystack + pos, needle, needleSize) == 0) return pos;
+            mask &= mask - 1;
+        }
+    }
+#endif
+    for (; i <= last; ++i) {
+        if (haystack[i] == needle[0] && std::memcmp(haystack + i, needle, needleSize) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * Подсчитывает количество байтов c в data (по 16 байтов за шаг SSE2).
+ *
+ * @param data Данные для подсчёта.
+ * @param size Размер data в байтах.
+ * @param c Искомый байт.
+ * @return Количество вхождений.
+ */
+qsizetype SimdScan::count(const char *data, const qsizetype size, const char c) {
+    const char *p = data;
+    const char *end = data + size;
+    qsizetype total = 0;
+
+#ifdef MYPYTHON_SSE2
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; end - p >= 16; p += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        total += qPopulationCount(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle))));
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == c) ++total;
+    }
+    return total;
+}
+
+/**
+ * Меняет регистр ASCII-букв на месте. SSE2-вариант выделяет маской байты диапазона
+ * 'a'..'z' (или 'A'..'Z') и переключает у них бит 0x20; остальные байты не изменяются.
+ *
+ * @param data Изменяемые данные.
+ * @param size Размер data в байтах.
+ * @param toUpper true — перевод в верхний регистр, false — в нижний.
+ */
+void SimdScan::asciiCaseMap(char *data, const qsizetype size, const bool toUpper) {
+    const char from = toUpper ? 'a' : 'A';
+    char *p = data;
+    char *end = data + size;
+
+#ifdef MYPYTHON_SSE2
+    const __m128i lower = _mm_set1_epi8(static_cast<char>(from - 1));
+    const __m128i upper = _mm_set1_epi8(static_cast<char>(from + 26));
+    const __m128i flip = _mm_set1_epi8(0x20);
+    for (; end - p >= 16; p += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        const __m128i inRange = _mm_and_si128(_mm_cmpgt_epi8(chunk, lower), _mm_cmplt_epi8(chunk, upper));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), _mm_xor_si128(chunk, _mm_and_si128(inRange, flip)));
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p >= from && *p < from + 26) *p = static_cast<char>(*p ^ 0x20);
+    }
+}
@@ -0,0 +1,305 @@
+#include "StringMethods.h"
+#include "SimdScan.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * Возвращает элементы строки str в хранилище типа S (str не шире элемента S).
+     */
+    template<typename S>
+    S unitsOf(const CompactString &str) {
+        S units;
+        units.resize(static_cast<size_t>(str.length()));
+        for (qsizetype i = 0; i < str.length(); ++i) {
+            units[i] = static_cast<typename S::value_type>(str.at(i));
+        }
+        return units;
+    }
+
+    const CompactString &stringArg(const std::vector<Value> &args, const size_t index, const char *method) {
+        if (index >= args.size() || !std::holds_alternative<Value::StringPtr>(args[index].data)) {
+            throw std::runtime_error(std::string(method) + "() argument " + std::to_string(index + 1) + " must be str");
+        }
+        return std::get<Value::StringPtr>(args[index].data)->flatten();
+    }
+
+    int intArg(const std::vector<Value> &args, const size_t index, const int defaultValue, const char *method) {
+        if (index >= args.size()) return defaultValue;
+        if (!std::holds_alternative<int>(args[index].data)) {
+            throw std::runtime_error(std::string(method) + "() argument " + std::to_string(index + 1) + " must be int");
+        }
+        return std::get<int>(args[index].data);
+    }
+
+    void checkArgCount(const std::vector<Value> &args, const size_t min, const size_t max, const char *method) {
+        if (args.size() < min || args.size() > max) {
+            throw std::runtime_error(std::string(method) + "() takes from " + std::to_string(min) + " to " +
+                                     std::to_string(max) + " arguments (" + std::to_string(args.size()) + " given)");
+        }
+    }
+
+    bool isStripped(const char32_t cp, const CompactString *chars) {
+        if (!chars) return QChar::isSpace(cp);
+        for (qsizetype i = 0; i < chars->length(); ++i) {
+            if (chars->at(i) == cp) return true;
+        }
+        return false;
+    }
+
+    Value strip(const CompactString &self, const std::vector<Value> &args, const bool left, const bool right,
+                const char *method) {
+        checkArgCount(args, 0, 1, method);
+        const CompactString *chars = args.empty() ? nullptr : &stringArg(args, 0, method);
+        qsizetype begin = 0;
+        qsizetype end = self.length();
+        while (left && begin < end && isStripped(self.at(begin), chars)) ++begin;
+        while (right && end > begin && isStripped(self.at(end - 1), chars)) --end;
+        if (begin == 0 && end == self.length()) return Value(self);
+        return Value(self.mid(begin, end - begin));
+    }
+
+    Value caseMap(const CompactString &self, const std::vector<Value> &args, const bool toUpper, const char *method) {
+        checkArgCount(args, 0, 0, method);
+        if (self.isAscii()) {
+            std::string bytes = self.visit([](const auto &s) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(s)>, std::string>) return s;
+                else return std::string();
+            });
+            SimdScan::asciiCaseMap(bytes.data(), static_cast<qsizetype>(bytes.size()), toUpper);
+            return Value(CompactString::fromLatin1(bytes.data(), static_cast<qsizetype>(bytes.size())));
+        }
+        std::u32string points;
+        points.reserve(self.length());
+        for (qsizetype i = 0; i < self.length(); ++i) {
+            points.push_back(toUpper ? QChar::toUpper(self.at(i)) : QChar::toLower(self.at(i)));
+        }
+        return Value(CompactString::fromCodePoints(points));
+    }
+
+    Value methodFind(const CompactString &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 2, "find");
+        const CompactString &sub = stringArg(args, 0, "find");
+        qsizetype start = intArg(args, 1, 0, "find");
+        if (start < 0) start += self.length(); //как в Python: отрицательная позиция отсчитывается от конца
+        return Value(static_cast<int>(StringMethods::find(self, sub, start)));
+    }
+
+    Value methodCount(const CompactString &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "count");
+        const CompactString &sub = stringArg(args, 0, "count");
+        if (sub.isEmpty()) return Value(static_cast<int>(self.length() + 1));
+        if (sub.length() == 1 && self.kind() == CompactString::Kind::Latin1 && sub.kind() == self.kind()) {
+            return Value(static_cast<int>(self.visit([&](const auto &s) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(s)>, std::string>) {
+                    return SimdScan::count(s.data(), static_cast<qsizetype>(s.size()), static_cast<char>(sub.at(0)));
+                }
+                return qsizetype(0);
+            })));
+        }
+
+        qsizetype total = 0;
+        for (qsizetype pos = StringMethods::find(self, sub); pos >= 0; pos = StringMethods::find(self, sub, pos + sub.length())) {
+            ++total;
+        }
+        return Value(static_cast<int>(total));
+    }
+
+    Value methodReplace(const CompactString &self, const std::vector<Value> &args) {
+        checkArgCount(args, 2, 3, "replace");
+        const CompactString &oldSub = stringArg(args, 0, "replace");
+        const CompactString &newSub = stringArg(args, 1, "replace");
+        const int limit = intArg(args, 2, -1, "replace");
+        if (oldSub.isEmpty()) throw std::runtime_error("replace() with an empty pattern is not supported");
+
+        std::vector<qsizetype> positions;
+        for (qsizetype pos = StringMethods::find(self, oldSub);
+             pos >= 0 && (limit < 0 || static_cast<int>(positions.size()) < limit);
+             pos = StringMethods::find(self, oldSub, pos + oldSub.length())) {
+            positions.push_back(pos);
+        }
+        if (positions.empty()) return Value(self);
+
+        const auto count = static_cast<qsizetype>(positions.size());
+        CompactString result;
+        result.reserve(self.length() + count * (newSub.length() - oldSub.length()), std::max(self.kind(), newSub.kind()));
+        qsizetype copied = 0;
+        for (const qsizetype pos : positions) {
+            result.append(self, copied, pos - copied);
+            result.append(newSub);
+            copied = pos + oldSub.length();
+        }
+        result.append(self, copied, self.length() - copied);
+        result.normalize();
+        return Value(std::move(result));
+    }
+
+    Value methodSplit(const CompactString &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 2, "split");
+        const int maxSplit = intArg(args, 1, -1, "split");
+        Value::List parts;
+
+        if (args.empty()) {
+            qsizetype i = 0;
+            const qsizetype len = self.length();
+            while (true) {
+                while (i < len && QChar::isSpace(self.at(i))) ++i;
+                if (i >= len) break;
+                if (maxSplit >= 0 && static_cast<int>(parts.size()) == maxSplit) {
+                    qsizetype end = len;
+                    while (end > i && QChar::isSpace(self.at(end - 1))) --end;
+                    parts.emplace_back(self.mid(i, end - i));
+                    break;
+                }
+                const qsizetype start = i;
+                while (i < len && !QChar::isSpace(self.at(i))) ++i;
+                parts.emplace_back(self.mid(start, i - start));
+            }
+            return Value(std::move(parts));
+        }
+
+        const CompactString &sep = stringArg(args, 0, "split");
+        if (sep.isEmpty()) throw std::runtime_error("empty separator");
+        qsizetype start = 0;
+        for (qsizetype pos = StringMethods::find(self, sep);
+             pos >= 0 && (maxSplit < 0 || static_cast<int>(parts.size()) < maxSplit);
+             pos = StringMethods::find(self, sep, start)) {
+            parts.emplace_back(self.mid(start, pos - start));
+            start = pos + sep.length();
+        }
+        parts.emplace_back(self.mid(start, self.length() - start));
+        return Value(std::move(parts));
+    }
+
+    /**
+     * Объединяет строки списка через разделитель self. Сначала за один проход вычисляются
+     * итоговая длина и ширина элемента, затем результат собирается в заранее выделенном буфере.
+     */
+    Value methodJoin(const CompactString &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "join");
+        if (!std::holds_alternative<Value::ListPtr>(args[0].data)) {
+            throw std::runtime_error("join() argument must be a list of str");
+        }
+        const Value::List &items = *std::get<Value::ListPtr>(args[0].data);
+
+        std::vector<const CompactString *> pieces;
+        pieces.reserve(items.size());
+        qsizetype total = 0;
+        CompactString::Kind kind = self.kind();
+        for (const Value &item : items) {
+            if (!std::holds_alternative<Value::StringPtr>(item.data)) {
+                throw std::runtime_error("sequence item " + std::to_string(pieces.size()) + ": expected str instance");
+            }
+            const CompactString &piece = std::get<Value::StringPtr>(item.data)->flatten();
+            pieces.push_back(&piece);
+            total += piece.length();
+            kind = std::max(kind, piece.kind());
+        }
+        if (!pieces.empty()) total += self.length() * static_cast<qsizetype>(pieces.size() - 1);
+
+        CompactString result;
+        result.reserve(total, kind);
+        for (size_t i = 0; i < pieces.size(); ++i) {
+            if (i > 0) result.append(self);
+            result.append(*pieces[i]);
+        }
+        if (pieces.empty() || kind != self.kind()) result.normalize();
+        return Value(std::move(result));
+    }
+
+    Value methodStartsWith(const CompactString &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "startswith");
+        const CompactString &prefix = stringArg(args, 0, "startswith");
+        if (prefix.length() > self.length()) return Value(false);
+        for (qsizetype i = 0; i < prefix.length(); ++i) {
+            if (self.at(i) != prefix.at(i)) return Value(false);
+        }
+        return Value(true);
+    }
+
+    Value methodEndsWith(const CompactString &self, const std::vector<Value> &args) {
+        checkArgCount(args, 1, 1, "endswith");
+        const CompactString &suffix = stringArg(args, 0, "endswith");
+        const qsizetype offset = self.length() - suffix.length();
+        if (offset < 0) return Value(false);
+        for (qsizetype i = 0; i < suffix.length(); ++i) {
+            if (self.at(offset + i) != suffix.at(i)) return Value(false);
+        }
+        return Value(true);
+    }
+
+    Value methodEncode(const CompactString &self, const std::vector<Value> &args) {
+        checkArgCount(args, 0, 1, "encode");
+        const QString encoding = args.empty() ? QString("utf-8") : stringArg(args, 0, "encode").toQString();
+        return Value(std::make_shared<Bytes>(Bytes::encode(self, encoding), false));
+    }
+}
+
+/**
+ * Ищет подстроку needle в строке haystack.
+ *
+ * Для строк шириной 1 байт используется SIMD-поиск; для более широких строк образец приводится
+ * к ширине haystack и ищется стандартным алгоритмом. Образец шире haystack заведомо не может
+ * в ней содержаться, так как строки хранятся в минимальной ширине.
+ *
+ * @param haystack Строка, в которой выполняется поиск.
+ * @param needle Искомая подстрока.
+ * @param from Позиция, с которой начинается поиск (отрицательная трактуется как 0).
+ * @return Индекс первого вхождения или -1, если подстрока не найдена.
+ */
+qsizetype StringMethods::find(const CompactString &haystack, const CompactString &needle, qsizetype from) {
+    from = std::max<qsizetype>(from, 0);
+    if (needle.isEmpty()) return from <= haystack.length() ? from : -1;
+    if (needle.kind() > haystack.kind() || needle.length() > haystack.length() - from) return -1;
+
+    return haystack.visit([&](const auto &hay) -> qsizetype {
+        using Storage = std::decay_t<decltype(hay)>;
+        const Storage units = unitsOf<Storage>(needle);
+        if constexpr (std::is_same_v<Storage, std::string>) {
+            return SimdScan::find(hay.data(), static_cast<qsizetype>(hay.size()),
+                                  units.data(), static_cast<qsizetype>(units.size()), from);
+        } else {
+            const size_t pos = hay.find(units, static_cast<size_t>(from));
+            return pos == Storage::npos ? -1 : static_cast<qsizetype>(pos);
+        }
+    });
+}
+
+/**
+ * Вызывает встроенный метод строки.
+ *
+ * @param self Строка, для которой вызывается метод.
+ * @param name Имя метода.
+ * @param args Вычисленные аргументы вызова.
+ * @return Результат метода.
+ * @throws std::runtime_error Если у строки нет метода с таким именем или аргументы некорректны.
+ */
+Value StringMethods::call(const CompactString &self, const QString &name, const std::vector<Value> &args) {
+    const auto &table = methods();
+    const auto it = table.find(name);
+    if (it == table.end()) {
+        throw std::runtime_error("'str' object has no attribute '" + name.toStdString() + "'");
+    }
+    return it->second(self, args);
+}
+
+/**
+ * Возвращает таблицу встроенных методов строки, индексированную по имени метода.
+ */
+const std::unordered_map<QString, StringMethods::Method> &StringMethods::methods() {
+    static const std::unordered_map<QString, Method> table = {
+        {"find", methodFind},
+        {"count", methodCount},
+        {"replace", methodReplace},
+        {"split", methodSplit},
+        {"join", methodJoin},
+        {"strip", [](const CompactString &self, const std::vector<Value> &args) { return strip(self, args, true, true, "strip"); }},
+        {"lstrip", [](const CompactString &self, const std::vector<Value> &args) { return strip(self, args, true, false, "lstrip"); }},
+        {"rstrip", [](const CompactString &self, const std::vector<Value> &args) { return strip(self, args, false, true, "rstrip"); }},
+        {"startswith", methodStartsWith},
+        {"endswith", methodEndsWith},
+        {"lower", [](const CompactString &self, const std::vector<Value> &args) { return caseMap(self, args, false, "lower"); }},
+        {"upper", [](const CompactString &self, const std::vector<Value> &args) { return caseMap(self, args, true, "upper"); }},
+        {"encode", methodEncode},
+    };
+    return table;
+}
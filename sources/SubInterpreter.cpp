@@ -0,0 +1,69 @@
+#include "SubInterpreter.h"
+#include "AstTraversal.h"
+#include "Frozen.h"
+#include "ModuleCache.h"
+#include "Output.h"
+#include "PassManager.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+    /**
+     * Значения не замораживаются здесь: каждая заморозка копирует граф в область, которая не освобождается,
+     * и повторные запуски с одной таблицей копировали бы её снова.
+     */
+    void requireFrozen(const SubInterpreter::Bindings &inputs) {
+        for (const auto &[name, value] : inputs) {
+            if (!Frozen::isFrozen(value)) {
+                throw std::runtime_error("sub-interpreter input '" + name.toStdString() + "' is not frozen");
+            }
+        }
+    }
+}
+
+SubInterpreter::Program SubInterpreter::compile(const QString &path) {
+    auto program = ModuleCache::load(path);
+    AstTraversal::share(program.get());
+    return program;
+}
+
+/**
+ * Модули, подключаемые скриптом через `import`, оптимизируются проходами этого же экземпляра;
+ * обработчик `ModuleCache::prepare` у каждого потока свой и восстанавливается после выполнения.
+ */
+SubInterpreter::Result SubInterpreter::run(const Program &program, const Bindings &inputs) {
+    Result result;
+    Environment env;
+    LoopStates loops;
+    const LoopStates::Scope loopScope(loops);
+    PassManager passes = PassManager::forLevel(PassManager::optimizationLevel);
+    const Output::Capture capture(result.output);
+    auto previousPrepare = std::exchange(ModuleCache::prepare, [&passes](std::shared_ptr<ASTNode> &ast, Environment &moduleEnv) {
+        passes.run(ast, moduleEnv);
+    });
+
+    try {
+        requireFrozen(inputs);
+        for (const auto &[name, value] : inputs) env.set(name, value);
+        auto ast = AstTraversal::clone(std::const_pointer_cast<ASTNode>(program), true);
+        passes.run(ast, env);
+        ast->eval(env);
+    } catch (const std::exception &e) { //исключение не должно завершить рабочий поток пула
+        result.status = 1;
+        result.error = QString::fromUtf8(e.what());
+    }
+
+    ModuleCache::prepare = std::move(previousPrepare);
+    return result;
+}
+
+std::future<SubInterpreter::Result> SubInterpreter::start(Program program, Bindings inputs, WorkStealingPool &pool) {
+    requireFrozen(inputs);
+    auto promise = std::make_shared<std::promise<Result>>();
+    auto future = promise->get_future();
+    pool.submit([promise, program = std::move(program), inputs = std::move(inputs)] {
+        promise->set_value(run(program, inputs));
+    });
+    return future;
+}
@@ -0,0 +1,213 @@
+#include "TypeInference.h"
+
+/**
+ * Выводит типы выражений дерева root и сохраняет список регионов для отчёта.
+ *
+ * @param root Корень дерева, которое будет выполнено в окружении env.
+ */
+void TypeInference::run(ASTNode &root) {
+    State state;
+    infer(&root, state);
+    found.clear();
+    collectRegions(&root, true);
+}
+
+bool TypeInference::parseFlag(const QString &flag) {
+    if (flag != "--report-types") return false;
+    reportRegions = true;
+    return true;
+}
+
+const char *TypeInference::typeName(const StaticType type) {
+    switch (type) {
+        case StaticType::Int: return "int";
+        case StaticType::Double: return "float";
+        case StaticType::Bool: return "bool";
+        default: return "?";
+    }
+}
+
+/**
+ * Возвращает тип переменной в точке программы: записанный в state или, если в анализируемом
+ * коде переменной ещё не присваивали значение, тип её текущего значения в окружении (до первого `import`).
+ *
+ * @return Тип переменной или std::nullopt, если переменная не определена.
+ */
+std::optional<StaticType> TypeInference::lookup(const State &state, const QString &name) const {
+    if (const auto it = state.find(name); it != state.end()) return it->second;
+    if (importSeen) return StaticType::Unknown;
+    const Value *value = env.find(name);
+    if (!value) return std::nullopt;
+    if (std::holds_alternative<int>(value->data)) return StaticType::Int;
+    if (std::holds_alternative<double>(value->data)) return StaticType::Double;
+    if (std::holds_alternative<bool>(value->data)) return StaticType::Bool;
+    return StaticType::Unknown;
+}
+
+/**
+ * Объединяет состояния двух путей выполнения. Переменная, не определённая на одном из путей,
+ * получает тип с другого пути; разные типы дают Unknown.
+ */
+TypeInference::State TypeInference::join(const State &a, const State &b) const {
+    State result;
+    auto merge = [&](const QString &name) {
+        if (result.count(name)) return;
+        const auto ta = lookup(a, name);
+        const auto tb = lookup(b, name);
+        if (!ta || !tb) result[name] = ta ? *ta : *tb;
+        else result[name] = *ta == *tb ? *ta : StaticType::Unknown;
+    };
+    for (const auto &entry : a) merge(entry.first);
+    for (const auto &entry : b) merge(entry.first);
+    return result;
+}
+
+/**
+ * Тип результата числовых обработчиков `BinaryDispatch` для операндов известных числовых типов.
+ */
+StaticType TypeInference::binaryType(const BinOpNode::Operation op, const StaticType left, const StaticType right) {
+    using Op = BinOpNode::Operation;
+    const auto isNumber = [](const StaticType t) { return t == StaticType::Int || t == StaticType::Double; };
+    if (!isNumber(left) || !isNumber(right)) return StaticType::Unknown;
+
+    switch (op) {
+        case Op::Add:
+        case Op::Subtract:
+        case Op::Multiply:
+        case Op::Modulo:
+        case Op::IntDivide:
+            return left == StaticType::Int && right == StaticType::Int ? StaticType::Int : StaticType::Double;
+        case Op::Divide:
+        case Op::Power:
+            return StaticType::Double;
+        default:
+            return StaticType::Bool;
+    }
+}
+
+void TypeInference::inferBlock(const std::vector<std::shared_ptr<ASTNode>> &statements, State &state) {
+    for (const auto &stmt : statements) infer(stmt.get(), state);
+}
+
+/**
+ * Выводит тип узла в состоянии state, обновляя состояние присваиваниями внутри узла.
+ *
+ * @return Доказанный тип результата узла.
+ */
+StaticType TypeInference::infer(ASTNode *node, State &state) {
+    StaticType type = StaticType::Unknown;
+
+    if (const auto *value = dynamic_cast<ValueNode *>(node)) {
+        if (std::holds_alternative<int>(value->value.data)) type = StaticType::Int;
+        else if (std::holds_alternative<double>(value->value.data)) type = StaticType::Double;
+        else if (std::holds_alternative<bool>(value->value.data)) type = StaticType::Bool;
+    } else if (const auto *var = dynamic_cast<VarNode *>(node)) {
+        type = lookup(state, var->name).value_or(StaticType::Unknown);
+    } else if (auto *bin = dynamic_cast<BinOpNode *>(node)) {
+        const StaticType left = infer(bin->left.get(), state);
+        const StaticType right = infer(bin->right.get(), state);
+        if (left != StaticType::Unknown && right != StaticType::Unknown) {
+            type = binaryType(bin->operation, left, right);
+        }
+    } else if (const auto *assign = dynamic_cast<AssignNode *>(node)) {
+        type = infer(assign->valueExpr.get(), state);
+        state[assign->varName] = type;
+    } else if (auto *aug = dynamic_cast<AugAssignNode *>(node)) {
+        type = infer(&aug->binOp, state);
+        state[aug->varName] = type;
+    } else if (const auto *function = dynamic_cast<FunctionNode *>(node)) {
+        //Тело функции не анализируется: оно разбирается только при первом вызове
+        state[function->name] = StaticType::Unknown;
+    } else if (dynamic_cast<ImportNode *>(node)) {
+        //Модуль может присвоить любой переменной значение любого типа
+        for (auto &entry : state) entry.second = StaticType::Unknown;
+        importSeen = true;
+    } else if (const auto *temp = dynamic_cast<TempNode *>(node)) {
+        type = infer(temp->expr.get(), state);
+    } else if (const auto *branch = dynamic_cast<IfNode *>(node)) {
+        infer(branch->condition.get(), state);
+        State merged = state;
+        inferBlock(branch->body, merged);
+        for (const auto &[condition, body] : branch->elifs) {
+            infer(condition.get(), state);
+            State taken = state;
+            inferBlock(body, taken);
+            merged = join(merged, taken);
+        }
+        State otherwise = state;
+        inferBlock(branch->elseBody, otherwise);
+        state = join(merged, otherwise);
+    } else if (const auto *loop = dynamic_cast<WhileNode *>(node)) {
+        //Состояние в начале итерации — объединение состояния до цикла и состояний после каждой итерации.
+        //Последний проход выполняется с неподвижной точкой, поэтому разметка узлов верна для любой итерации.
+        State head = state;
+        while (true) {
+            State iteration = head;
+            infer(loop->condition.get(), iteration);
+            const State exit = iteration;
+            inferBlock(loop->body, iteration);
+            State next = join(state, iteration);
+            if (next == head) {
+                state = exit;
+                break;
+            }
+            head = std::move(next);
+        }
+    } else {
+        for (ASTNode *child : AstTraversal::children(node)) infer(child, state);
+    }
+
+    node->staticType = type;
+    return type;
+}
+
+void TypeInference::measure(ASTNode *node, Region &region) {
+    const bool isStatement = dynamic_cast<AssignNode *>(node) || dynamic_cast<AugAssignNode *>(node) ||
+                             dynamic_cast<IfNode *>(node) || dynamic_cast<WhileNode *>(node) ||
+                             dynamic_cast<BlockNode *>(node) || dynamic_cast<FunctionNode *>(node) ||
+                             dynamic_cast<ReturnNode *>(node);
+    if (!isStatement) {
+        ++region.expressions;
+        if (node->staticType != StaticType::Unknown) ++region.typedExpressions;
+    }
+
+    const QString *target = nullptr;
+    if (const auto *assign = dynamic_cast<AssignNode *>(node)) target = &assign->varName;
+    if (const auto *aug = dynamic_cast<AugAssignNode *>(node)) target = &aug->varName;
+    if (target) {
+        const auto [it, inserted] = region.variables.emplace(*target, node->staticType);
+        if (!inserted && it->second != node->staticType) it->second = StaticType::Unknown;
+    }
+
+    for (ASTNode *child : AstTraversal::children(node)) measure(child, region);
+}
+
+/**
+ * Добавляет регион для корня дерева и для каждой вложенной конструкции `if`/`while`.
+ */
+void TypeInference::collectRegions(ASTNode *node, const bool isRoot) {
+    const bool isBlock = dynamic_cast<IfNode *>(node) || dynamic_cast<WhileNode *>(node);
+    if (isRoot || isBlock) {
+        Region region;
+        region.description = node->toString().section('\n', 0, 0);
+        measure(node, region);
+        found.push_back(std::move(region));
+    }
+    for (ASTNode *child : AstTraversal::children(node)) collectRegions(child, false);
+}
+
+QString TypeInference::report() const {
+    QString result;
+    for (const Region &region : found) {
+        result += "types: " + region.description + " -- ";
+        result += region.isMonomorphic() ? QString("monomorphic") :
+            QString("%1/%2 expressions typed").arg(region.typedExpressions).arg(region.expressions);
+        QString variables;
+        for (const auto &[name, type] : region.variables) {
+            variables += (variables.isEmpty() ? "" : ", ") + name + ": " + typeName(type);
+        }
+        if (!variables.isEmpty()) result += " [" + variables + "]";
+        result += "\n";
+    }
+    return result;
+}
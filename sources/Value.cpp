@@ -1,54 +1,28 @@
 #include "Value.h"
+#include "Repr.h"
 
 /**
- * Преобразует экземпляр `Value` в его строковое представление в зависимости от его типа.
- *
- * Этот метод обрабатывает следующие типы: `int`, `double`, `bool`, `QString`,
- * `ListPtr`, `DictPtr` и `FunctionPtr`. Для неподдерживаемых или неизвестных типов
- * возвращает "Unknown unsupported type".
+ * Преобразует экземпляр `Value` в его строковое представление (`repr` в Python), см. `Repr`.
  *
  * - Для `int`: возвращает целое число в виде строки.
- * - Для `double`: возвращает число с плавающей точкой в виде строки.
+ * - Для `double`: возвращает кратчайшую запись числа, читаемую обратно без потерь (см. `NumberFormat`).
  * - Для `bool`: возвращает "True" или "False".
- * - Для `QString`: возвращает строку, заключенную в одинарные кавычки.
- * - Для `ListPtr`: возвращает "[...]".
- * - Для `DictPtr`: возвращает "{...}".
+ * - Для `StringPtr`: возвращает строку в кавычках с экранированными специальными символами.
+ * - Для `ListPtr`: возвращает элементы в квадратных скобках (`[1, 'a']`); циклическая ссылка выводится как `[...]`.
+ * - Для `DictPtr`: возвращает пары в фигурных скобках (`{'a': 1}`); циклическая ссылка выводится как `{...}`.
  * - Для `FunctionPtr`: возвращает "<function>".
+ * - Для `MemoryViewPtr`: возвращает "<memory>".
+ * - Для `BytesPtr`: возвращает литерал вида `b'...'` (для bytearray — `bytearray(b'...')`).
+ * - Для `AwaitablePtr`: возвращает "<coroutine имя>", "<Task pending>" и т. п.
+ * - Для `FilePtr`: возвращает "<_io.TextIOWrapper name='...' mode='r'>" и т. п.
  *
  * @return Строковое представление экземпляра `Value`.
  */
 QString Value::toString() const
 {
-    if (std::holds_alternative<int>(data))
-    {
-        return QString::number(std::get<int>(data));
-    }
-    if (std::holds_alternative<double>(data))
-    {
-        return QString::number(std::get<double>(data));
-    }
-    if (std::holds_alternative<bool>(data))
-    {
-        return std::get<bool>(data) ? "True" : "False";
-    }
-    if (std::holds_alternative<QString>(data))
-    {
-        return QString("\'" + std::get<QString>(data) + "\'");
-    }
-    if (std::holds_alternative<ListPtr>(data))
-    {
-        return "[...]";
-    }
-    if (std::holds_alternative<DictPtr>(data))
-    {
-        return "{...}";
-    }
-    if (std::holds_alternative<FunctionPtr>(data))
-    {
-        return "<function>";
-    }
-
-    return "Unknown unsupported type";
+    std::string result;
+    Repr(result).repr(*this);
+    return QString::fromUtf8(result.data(), static_cast<qsizetype>(result.size()));
 }
 
 bool Value::toBool() const {
@@ -64,9 +38,9 @@ bool Value::toBool() const {
     {
         return std::get<bool>(data);
     }
-    if (std::holds_alternative<QString>(data))
+    if (std::holds_alternative<StringPtr>(data))
     {
-        return !std::get<QString>(data).isEmpty();
+        return !std::get<StringPtr>(data)->isEmpty();
     }
     if (std::holds_alternative<ListPtr>(data))
     {
@@ -80,6 +54,18 @@ bool Value::toBool() const {
     {
         return std::get<FunctionPtr>(data) != nullptr;
     }
+    if (std::holds_alternative<MemoryViewPtr>(data))
+    {
+        return std::get<MemoryViewPtr>(data)->buffer.length != 0;
+    }
+    if (std::holds_alternative<BytesPtr>(data))
+    {
+        return !std::get<BytesPtr>(data)->data.empty();
+    }
+    if (std::holds_alternative<AwaitablePtr>(data) || std::holds_alternative<FilePtr>(data))
+    {
+        return true;
+    }
 
     throw std::runtime_error("Unsupported type");
 }
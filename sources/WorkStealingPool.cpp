@@ -0,0 +1,137 @@
+#include "WorkStealingPool.h"
+#include <QThread>
+#include <algorithm>
+
+namespace {
+    thread_local const WorkStealingPool *currentPool = nullptr;
+    thread_local size_t currentIndex = 0;
+}
+
+WorkStealingPool::WorkStealingPool(const int threadCount) {
+    const size_t count = static_cast<size_t>(std::max(threadCount, 1));
+    for (size_t i = 0; i < count; ++i) queues.push_back(std::make_unique<Queue>());
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    quiesce();
+}
+
+void WorkStealingPool::start() {
+    std::lock_guard lock(lifecycle);
+    if (!running) launch();
+}
+
+void WorkStealingPool::launch() {
+    threads.reserve(queues.size());
+    for (size_t i = 0; i < queues.size(); ++i) threads.emplace_back(&WorkStealingPool::work, this, i);
+    running = true;
+}
+
+/**
+ * Поток завершается, когда задач не осталось, поэтому задачи, отправленные выполняющимися
+ * задачами, тоже выполняются до завершения последнего потока. Задача, отправленная другим
+ * потоком после завершения последнего рабочего, не должна остаться невыполненной: потоки запускаются снова.
+ */
+bool WorkStealingPool::quiesce() {
+    if (currentPool == this) return false;
+    std::lock_guard lock(lifecycle);
+    if (!running) return true;
+    {
+        std::lock_guard sleepLock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) thread.join();
+    threads.clear();
+    stopping = false;
+    running = false;
+    if (queued == 0) return true;
+    launch();
+    return false;
+}
+
+/**
+ * Счётчик задач увеличивается под sleepMutex до постановки задачи в очередь: поток, забравший
+ * задачу, уменьшает уже учтённый счётчик, а поток, проверивший счётчик перед сном, либо увидит
+ * задачу, либо получит уведомление.
+ */
+void WorkStealingPool::submit(Task task) {
+    if (!running) start();
+    Queue &queue = *queues[homeQueue()];
+    {
+        std::lock_guard lock(sleepMutex);
+        ++queued;
+    }
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+    if (helpers > 0) progress.notify_all();
+}
+
+/**
+ * Когда задач нет, поток засыпает до завершения очередной задачи или появления новой.
+ * Ожидающий поток учитывается в helpers до проверки условия, а задача проверяет helpers после
+ * своего последнего изменения состояния: при последовательно согласованных атомарных операциях
+ * либо условие увидит это изменение, либо задача пришлёт уведомление.
+ */
+void WorkStealingPool::helpUntil(const std::function<bool()> &done) {
+    const size_t home = homeQueue();
+    while (!done()) {
+        if (runOne(home)) continue;
+        std::unique_lock lock(sleepMutex);
+        ++helpers;
+        progress.wait(lock, [this, &done] { return queued > 0 || done(); });
+        --helpers;
+    }
+}
+
+WorkStealingPool &WorkStealingPool::global() {
+    static WorkStealingPool pool(QThread::idealThreadCount());
+    return pool;
+}
+
+void WorkStealingPool::work(const size_t index) {
+    currentPool = this;
+    currentIndex = index;
+    while (true) {
+        if (runOne(index)) continue;
+        std::unique_lock lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
+
+/**
+ * Своя очередь разбирается с конца (последняя отправленная задача), чужие — с начала
+ * (самые старые задачи, обычно самые крупные).
+ */
+bool WorkStealingPool::runOne(const size_t home) {
+    Task task;
+    for (size_t i = 0; i < queues.size() && !task; ++i) {
+        Queue &queue = *queues[(home + i) % queues.size()];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+    --queued;
+    task();
+    if (helpers > 0) {
+        std::lock_guard lock(sleepMutex);
+        progress.notify_all();
+    }
+    return true;
+}
+
+size_t WorkStealingPool::homeQueue() {
+    if (currentPool == this) return currentIndex;
+    return nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+}
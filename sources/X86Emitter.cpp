@@ -0,0 +1,221 @@
+#include "X86Emitter.h"
+#include <stdexcept>
+
+void X86Emitter::emit32(const std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) emit(static_cast<std::uint8_t>(value >> (8 * i)));
+}
+
+/**
+ * Записывает префикс REX, если он нужен: для 64-битного операнда, для регистров r8–r15
+ * или (force) для обращения к младшим байтам rsp/rbp/rsi/rdi.
+ *
+ * @param wide Признак 64-битного операнда (REX.W).
+ * @param reg Регистр из поля reg байта ModRM (расширяется битом REX.R).
+ * @param rm Регистр из поля rm байта ModRM (расширяется битом REX.B).
+ * @param force Записать префикс, даже если все биты равны нулю.
+ */
+void X86Emitter::rex(const bool wide, const int reg, const int rm, const bool force) {
+    const std::uint8_t prefix = 0x40 | (wide ? 0x08 : 0) | (reg & 8 ? 0x04 : 0) | (rm & 8 ? 0x01 : 0);
+    if (prefix != 0x40 || force) emit(prefix);
+}
+
+void X86Emitter::modRegReg(const int reg, const int rm) {
+    emit(static_cast<std::uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+}
+
+/**
+ * Записывает байт ModRM (и при необходимости SIB) для операнда `[base + disp32]`.
+ * Смещение всегда кодируется 32 битами, что упрощает эмиттер ценой нескольких байтов кода.
+ */
+void X86Emitter::modRegMem(const int reg, const Reg base, const std::int32_t disp) {
+    emit(static_cast<std::uint8_t>(0x80 | ((reg & 7) << 3) | (base & 7)));
+    if ((base & 7) == RSP) emit(0x24);
+    emit32(static_cast<std::uint32_t>(disp));
+}
+
+void X86Emitter::aluRegReg(const std::uint8_t opcode, const Reg dst, const Reg src) {
+    rex(false, dst, src);
+    emit(opcode);
+    modRegReg(dst, src);
+}
+
+void X86Emitter::sse(const std::uint8_t prefix, const std::uint8_t opcode, const int reg, const int rm) {
+    emit(prefix);
+    rex(false, reg, rm);
+    emit(0x0F);
+    emit(opcode);
+    modRegReg(reg, rm);
+}
+
+void X86Emitter::sseMem(const std::uint8_t prefix, const std::uint8_t opcode, const int reg, const Reg base,
+                        const std::int32_t disp) {
+    emit(prefix);
+    rex(false, reg, base);
+    emit(0x0F);
+    emit(opcode);
+    modRegMem(reg, base, disp);
+}
+
+void X86Emitter::movRegImm32(const Reg dst, const std::int32_t imm) {
+    rex(false, 0, dst);
+    emit(static_cast<std::uint8_t>(0xB8 + (dst & 7)));
+    emit32(static_cast<std::uint32_t>(imm));
+}
+
+void X86Emitter::movRegImm64(const Reg dst, const std::uint64_t imm) {
+    rex(true, 0, dst);
+    emit(static_cast<std::uint8_t>(0xB8 + (dst & 7)));
+    emit32(static_cast<std::uint32_t>(imm));
+    emit32(static_cast<std::uint32_t>(imm >> 32));
+}
+
+void X86Emitter::movRegReg(const Reg dst, const Reg src) { aluRegReg(0x8B, dst, src); }
+
+void X86Emitter::movRegReg64(const Reg dst, const Reg src) {
+    rex(true, dst, src);
+    emit(0x8B);
+    modRegReg(dst, src);
+}
+
+void X86Emitter::movRegMem(const Reg dst, const Reg base, const std::int32_t disp) {
+    rex(false, dst, base);
+    emit(0x8B);
+    modRegMem(dst, base, disp);
+}
+
+void X86Emitter::movMemReg(const Reg base, const std::int32_t disp, const Reg src) {
+    rex(false, src, base);
+    emit(0x89);
+    modRegMem(src, base, disp);
+}
+
+void X86Emitter::movRegMem64(const Reg dst, const Reg base, const std::int32_t disp) {
+    rex(true, dst, base);
+    emit(0x8B);
+    modRegMem(dst, base, disp);
+}
+
+void X86Emitter::movMemReg64(const Reg base, const std::int32_t disp, const Reg src) {
+    rex(true, src, base);
+    emit(0x89);
+    modRegMem(src, base, disp);
+}
+
+void X86Emitter::addRegReg(const Reg dst, const Reg src) { aluRegReg(0x03, dst, src); }
+void X86Emitter::subRegReg(const Reg dst, const Reg src) { aluRegReg(0x2B, dst, src); }
+void X86Emitter::cmpRegReg(const Reg left, const Reg right) { aluRegReg(0x3B, left, right); }
+void X86Emitter::testRegReg(const Reg left, const Reg right) { aluRegReg(0x85, left, right); }
+void X86Emitter::andRegReg(const Reg dst, const Reg src) { aluRegReg(0x23, dst, src); }
+void X86Emitter::orRegReg(const Reg dst, const Reg src) { aluRegReg(0x0B, dst, src); }
+
+void X86Emitter::imulRegReg(const Reg dst, const Reg src) {
+    rex(false, dst, src);
+    emit(0x0F);
+    emit(0xAF);
+    modRegReg(dst, src);
+}
+
+void X86Emitter::cmpRegImm8(const Reg left, const std::int8_t imm) {
+    rex(false, 0, left);
+    emit(0x83);
+    modRegReg(7, left);
+    emit(static_cast<std::uint8_t>(imm));
+}
+
+void X86Emitter::cdq() { emit(0x99); }
+
+void X86Emitter::idiv(const Reg divisor) {
+    rex(false, 0, divisor);
+    emit(0xF7);
+    modRegReg(7, divisor);
+}
+
+void X86Emitter::setcc(const Condition condition, const Reg dst) {
+    rex(false, 0, dst, dst >= RSP && dst <= RDI);
+    emit(0x0F);
+    emit(static_cast<std::uint8_t>(0x90 + condition));
+    modRegReg(0, dst);
+}
+
+void X86Emitter::movzxRegReg8(const Reg dst, const Reg src) {
+    rex(false, dst, src, src >= RSP && src <= RDI);
+    emit(0x0F);
+    emit(0xB6);
+    modRegReg(dst, src);
+}
+
+void X86Emitter::push(const Reg reg) {
+    rex(false, 0, reg);
+    emit(static_cast<std::uint8_t>(0x50 + (reg & 7)));
+}
+
+void X86Emitter::pop(const Reg reg) {
+    rex(false, 0, reg);
+    emit(static_cast<std::uint8_t>(0x58 + (reg & 7)));
+}
+
+void X86Emitter::ret() { emit(0xC3); }
+
+void X86Emitter::movsdRegReg(const int dst, const int src) { sse(0xF2, 0x10, dst, src); }
+void X86Emitter::movsdRegMem(const int dst, const Reg base, const std::int32_t disp) { sseMem(0xF2, 0x10, dst, base, disp); }
+void X86Emitter::movsdMemReg(const Reg base, const std::int32_t disp, const int src) { sseMem(0xF2, 0x11, src, base, disp); }
+void X86Emitter::addsd(const int dst, const int src) { sse(0xF2, 0x58, dst, src); }
+void X86Emitter::mulsd(const int dst, const int src) { sse(0xF2, 0x59, dst, src); }
+void X86Emitter::subsd(const int dst, const int src) { sse(0xF2, 0x5C, dst, src); }
+void X86Emitter::divsd(const int dst, const int src) { sse(0xF2, 0x5E, dst, src); }
+void X86Emitter::ucomisd(const int left, const int right) { sse(0x66, 0x2E, left, right); }
+void X86Emitter::xorpd(const int dst, const int src) { sse(0x66, 0x57, dst, src); }
+void X86Emitter::cvtsi2sd(const int dst, const Reg src) { sse(0xF2, 0x2A, dst, src); }
+
+void X86Emitter::movqXmmReg(const int dst, const Reg src) {
+    emit(0x66);
+    rex(true, dst, src);
+    emit(0x0F);
+    emit(0x6E);
+    modRegReg(dst, src);
+}
+
+void X86Emitter::movqRegXmm(const Reg dst, const int src) {
+    emit(0x66);
+    rex(true, src, dst);
+    emit(0x0F);
+    emit(0x7E);
+    modRegReg(src, dst);
+}
+
+X86Emitter::Label X86Emitter::newLabel() {
+    labels.push_back(-1);
+    return static_cast<Label>(labels.size() - 1);
+}
+
+void X86Emitter::bind(const Label label) {
+    labels[label] = static_cast<std::int64_t>(bytes.size());
+}
+
+void X86Emitter::jmp(const Label label) {
+    emit(0xE9);
+    fixups.emplace_back(bytes.size(), label);
+    emit32(0);
+}
+
+void X86Emitter::jcc(const Condition condition, const Label label) {
+    emit(0x0F);
+    emit(static_cast<std::uint8_t>(0x80 + condition));
+    fixups.emplace_back(bytes.size(), label);
+    emit32(0);
+}
+
+/**
+ * Записывает смещения rel32 во все переходы. Смещение отсчитывается от конца инструкции,
+ * то есть от позиции сразу после поля rel32.
+ *
+ * @throws std::logic_error Если на метку ссылается переход, но сама метка не привязана.
+ */
+void X86Emitter::finalize() {
+    for (const auto &[position, label] : fixups) {
+        if (labels[label] < 0) throw std::logic_error("JIT: unbound label");
+        const auto rel = static_cast<std::int32_t>(labels[label] - static_cast<std::int64_t>(position + 4));
+        for (int i = 0; i < 4; ++i) bytes[position + i] = static_cast<std::uint8_t>(static_cast<std::uint32_t>(rel) >> (8 * i));
+    }
+    fixups.clear();
+}